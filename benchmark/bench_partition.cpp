@@ -0,0 +1,125 @@
+#include "micro_benchmark.hpp"
+
+#include <graph_canon/detail/partition.hpp>
+#include <graph_canon/sorting_utils.hpp>
+
+#include <boost/graph/iteration_macros.hpp>
+
+// Benchmarks of the ordered partition and the sorting primitives used during refinement.
+// The inputs are derived from the synthetic graphs by giving each vertex a value less than the degree,
+// so the degree is the number of cells, and the number of buckets used by partition_range.
+
+namespace gcb = graph_canon_benchmark;
+using SizeType = unsigned int;
+using Partition = graph_canon::detail::partition<SizeType>;
+
+// The partition with a cell per value of the vertices,
+// i.e., the vertices are sorted by their values and the cell boundaries are between different values.
+
+Partition make_partition(const std::vector<SizeType> &values) {
+	const SizeType n = values.size();
+	std::vector<SizeType> order(n);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](SizeType a, SizeType b) {
+		return values[a] < values[b];
+	});
+	Partition pi(n);
+	for(SizeType i = 0; i < n; ++i)
+		pi.put_element_on_index(order[i], i);
+	if(n == 0) return pi;
+	{
+		auto raii_splitter = pi.split_cell(0);
+		for(SizeType i = 1; i < n; ++i)
+			if(values[order[i - 1]] != values[order[i]])
+				raii_splitter.add_split(i);
+	}
+	for(SizeType cell = 0; cell != n; cell = pi.get_cell_end(cell))
+		pi.set_cell_from_v_idx(cell);
+	return pi;
+}
+
+template<SizeType Max>
+void bench_counting_sorter(const gcb::options &opts, std::size_t n, std::size_t degree, std::mt19937 &gen) {
+	std::vector<SizeType> input(n);
+	for(auto &v : input) v = gen() % Max;
+	std::vector<SizeType> values;
+	graph_canon::counting_sorter<SizeType, Max> sorter;
+	gcb::run(opts, "counting_sorter<" + std::to_string(Max) + ">", n, degree, [&](gcb::state &s) {
+		while(s.keep_running()) {
+			s.pause();
+			values = input;
+			s.resume();
+			sorter(values.begin(), values.end(), [](SizeType v) {
+				return v;
+			}, [](const auto &ends) {
+				gcb::do_not_optimize(ends[0]);
+			}, [](auto iter, SizeType v) {
+				*iter = v;
+			});
+			gcb::do_not_optimize(values.front());
+		}
+	});
+}
+
+int main(int argc, char **argv) {
+	gcb::options opts;
+	if(!gcb::parse_options(argc, argv, opts, "Micro-benchmarks of partition, counting_sorter, and partition_range."))
+		return 0;
+	for(const std::size_t n : opts.sizes) {
+		for(const std::size_t degree : opts.degrees) {
+			std::mt19937 gen(opts.seed);
+			const gcb::Graph g = gcb::make_random_regular_graph(n, degree, gen);
+			// cells of vertices with equal sums of neighbour indices modulo the degree
+			std::vector<SizeType> values(n);
+			BGL_FORALL_VERTICES(v, g, gcb::Graph) {
+				BGL_FORALL_ADJ(v, u, g, gcb::Graph) {
+					values[v] += u;
+				}
+				values[v] %= std::max<std::size_t>(degree, 1);
+			}
+			const Partition pi = make_partition(values);
+
+			gcb::run(opts, "partition/copy", n, degree, [&](gcb::state &s) {
+				while(s.keep_running()) {
+					Partition copy(pi);
+					gcb::do_not_optimize(copy.get(0));
+				}
+			});
+			// split each cell of the partition into singletons, as when a refiner makes it discrete
+			std::vector<SizeType> storage(Partition::get_storage_size(n));
+			gcb::run(opts, "partition/split_cell", n, degree, [&](gcb::state &s) {
+				while(s.keep_running()) {
+					s.pause();
+					Partition work(pi, storage.data());
+					s.resume();
+					for(SizeType cell = work.get_first_non_singleton(), next; cell != n; cell = next) {
+						next = work.get_next_non_singleton(cell);
+						const SizeType cell_end = work.get_cell_end(cell);
+						auto raii_splitter = work.split_cell(cell);
+						for(SizeType i = cell + 1; i < cell_end; ++i)
+							raii_splitter.add_split(i);
+					}
+					gcb::do_not_optimize(work.get_num_cells());
+				}
+			});
+
+			bench_counting_sorter<4>(opts, n, degree, gen);
+			bench_counting_sorter<256>(opts, n, degree, gen);
+
+			std::vector<SizeType> elements;
+			gcb::run(opts, "partition_range", n, degree, [&](gcb::state &s) {
+				while(s.keep_running()) {
+					s.pause();
+					elements = values;
+					s.resume();
+					const auto mid = graph_canon::partition_range(elements.begin(), elements.end(), [degree](SizeType v) {
+						return v < degree / 2;
+					}, [](auto a, auto b) {
+						std::iter_swap(a, b);
+					});
+					gcb::do_not_optimize(mid - elements.begin());
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#include "micro_benchmark.hpp"
+
+#include <graph_canon/aut/pruner_basic.hpp>
+#include <graph_canon/canonicalization.hpp>
+#include <graph_canon/detail/permuted_graph_view.hpp>
+#include <graph_canon/refine/WL_1.hpp>
+#include <graph_canon/target_cell/flm.hpp>
+#include <graph_canon/tree_traversal/dfs.hpp>
+
+#include <memory>
+
+// Benchmarks of the kernels that need a canon_state.
+// A canonicalization of the synthetic graph is run with a visitor that benchmarks the kernels
+// when the search reaches suitable tree nodes, so their inputs are the real ones of the search:
+//
+// - refine_WL_1::refine, on the unrefined partition of the root and of its first child,
+//   also for a circulant graph, where the first child hits the large cell of the root sparsely,
+//   and the search is stopped after that child,
+// - target_cell_flm::select_target_cell (i.e., find_cell) on the equitable partition of the same nodes,
+// - permuted_graph_view, built for the first leaf and compared with a copy of itself (the slowest case).
+//
+// Each repetition of refine is given a fresh copy of the unrefined partition,
+// and the node gets its own partition back before the search continues.
+// The automorphism pruning only makes sense as part of a search,
+// so aut_pruner_base::tree_before_descend is timed for each call during canonicalizations of circulant graphs.
+
+namespace gcb = graph_canon_benchmark;
+using SizeType = unsigned int;
+
+template<typename State>
+struct state_config;
+
+template<typename Config, typename Vis>
+struct state_config<graph_canon::canon_state<Config, Vis> > {
+	using type = Config;
+};
+
+struct kernel_visitor : graph_canon::null_visitor {
+	using Partition = graph_canon::detail::partition<SizeType>;
+
+	struct context {
+
+		context(const gcb::options &opts, std::size_t degree, const std::string &graph = "")
+		: opts(opts), degree(degree), graph(graph) { }
+	public:
+		const gcb::options &opts;
+		std::size_t degree;
+		std::string graph; // prefix of the node in the names
+		std::unique_ptr<Partition> unrefined; // of the node being benchmarked
+		std::vector<SizeType> storage; // for the copies given to refine
+		bool has_leaf = false;
+	};
+public:
+
+	kernel_visitor(context &c) : c(&c) { }
+
+	template<typename State, typename TreeNode>
+	bool tree_create_node_begin(State &state, TreeNode &t) {
+		if(is_benchmarked(t)) c->unrefined = std::make_unique<Partition>(t.pi);
+		return true;
+	}
+
+	template<typename State, typename TreeNode>
+	bool tree_create_node_end(State &state, TreeNode &t) {
+		if(!is_benchmarked(t) || t.get_is_pruned()) return true;
+		const std::string node = c->graph + (t.get_parent() ? "child" : "root");
+		c->storage.resize(Partition::get_storage_size(state.n));
+		gcb::run(c->opts, "refine_WL_1::refine/" + node, state.n, c->degree, [&](gcb::state &s) {
+			while(s.keep_running()) {
+				s.pause();
+				Partition work(*c->unrefined, c->storage.data());
+				std::swap(work, t.pi);
+				s.resume();
+				graph_canon::refine_WL_1 refiner;
+				while(refiner.refine(state, t) == graph_canon::RefinementResult::Again);
+				s.pause();
+				std::swap(work, t.pi);
+			}
+		});
+		if(t.pi.get_num_cells() != state.n) {
+			gcb::run(c->opts, "target_cell_flm::select_target_cell/" + node, state.n, c->degree, [&](gcb::state &s) {
+				while(s.keep_running()) {
+					graph_canon::target_cell_flm selector;
+					gcb::do_not_optimize(selector.select_target_cell(state, t));
+				}
+			});
+		}
+		return true;
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_leaf(State &state, TreeNode &t) {
+		if(c->has_leaf) return;
+		c->has_leaf = true;
+		using View = graph_canon::detail::permuted_graph_view<typename state_config<State>::type, TreeNode>;
+		const typename TreeNode::OwnerPtr leaf(&t);
+		gcb::run(c->opts, "permuted_graph_view/build", state.n, c->degree, [&](gcb::state &s) {
+			while(s.keep_running()) {
+				View view(state, leaf);
+				gcb::do_not_optimize(view.get_targets_begin(0));
+			}
+		});
+		View view(state, leaf);
+		gcb::run(c->opts, "permuted_graph_view/repermute", state.n, c->degree, [&](gcb::state &s) {
+			while(s.keep_running()) {
+				view.repermute(state, leaf);
+				gcb::do_not_optimize(view.get_targets_begin(0));
+			}
+		});
+		const View other(state, leaf);
+		gcb::run(c->opts, "permuted_graph_view/compare", state.n, c->degree, [&](gcb::state &s) {
+			while(s.keep_running())
+				gcb::do_not_optimize(View::compare(state, view, other));
+		});
+	}
+private:
+
+	// the root and its first child
+
+	template<typename TreeNode>
+	static bool is_benchmarked(const TreeNode &t) {
+		return !t.get_parent() || (!t.get_parent()->get_parent() && t.get_child_offset() == 0);
+	}
+private:
+	context *c;
+};
+
+// aut_pruner_basic with each call of tree_before_descend timed
+
+struct timed_aut_pruner_basic : graph_canon::aut_pruner_basic {
+
+	timed_aut_pruner_basic(gcb::state &s, std::size_t &calls) : s(&s), calls(&calls) { }
+
+	template<typename State, typename TreeNode>
+	void tree_before_descend(State &state, TreeNode &t) {
+		++*calls;
+		s->resume();
+		graph_canon::aut_pruner_basic::tree_before_descend(state, t);
+		s->pause();
+	}
+private:
+	gcb::state *s;
+	std::size_t *calls;
+};
+
+int main(int argc, char **argv) {
+	gcb::options opts;
+	if(!gcb::parse_options(argc, argv, opts, "Micro-benchmarks of refine_WL_1, target_cell_flm, permuted_graph_view, and aut_pruner_base."))
+		return 0;
+	for(const std::size_t n : opts.sizes) {
+		for(const std::size_t degree : opts.degrees) {
+			std::mt19937 gen(opts.seed);
+			const gcb::Graph g = gcb::make_random_regular_graph(n, degree, gen);
+			kernel_visitor::context c(opts, degree);
+			graph_canon::canonicalize<SizeType, false, false>(g, get(boost::vertex_index_t(), g),
+					graph_canon::always_false(), graph_canon::edge_handler_all_equal(),
+					graph_canon::make_visitor(graph_canon::refine_WL_1(), graph_canon::target_cell_flm(),
+					graph_canon::traversal_dfs(), kernel_visitor(c)));
+			{
+				const gcb::Graph circulant = gcb::make_circulant_graph(n, degree);
+				kernel_visitor::context c(opts, degree, "circulant/");
+				graph_canon::resource_limits limits;
+				limits.max_tree_nodes = 2;
+				graph_canon::canonicalize<SizeType, false, false>(circulant, get(boost::vertex_index_t(), circulant),
+						graph_canon::always_false(), graph_canon::edge_handler_all_equal(),
+						graph_canon::make_visitor(graph_canon::refine_WL_1(), graph_canon::target_cell_flm(),
+						graph_canon::traversal_dfs(), kernel_visitor(c)), limits);
+			}
+
+			const std::string name = "aut_pruner_base::tree_before_descend";
+			if(name.find(opts.filter) == std::string::npos) continue;
+			const gcb::Graph circulant = gcb::make_circulant_graph(n, degree);
+			const graph_canon::edge_handler_all_equal edgeHandler;
+			graph_canon::canonicalizer<SizeType, graph_canon::edge_handler_all_equal, false, false> canonicalizer(edgeHandler);
+			gcb::state s(0);
+			std::size_t calls = 0;
+			while(s.get_seconds() < opts.min_time) {
+				const std::size_t before = calls;
+				canonicalizer(circulant, get(boost::vertex_index_t(), circulant), graph_canon::always_false(),
+						graph_canon::make_visitor(graph_canon::refine_WL_1(), graph_canon::target_cell_flm(),
+						graph_canon::traversal_dfs(), timed_aut_pruner_basic(s, calls)));
+				if(calls == before) break; // e.g., the graph is too small to have a search tree
+			}
+			gcb::report(name, n, degree, calls, s);
+		}
+	}
+}
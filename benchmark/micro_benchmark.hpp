@@ -0,0 +1,252 @@
+#ifndef GRAPH_CANON_BENCHMARK_MICRO_BENCHMARK_HPP
+#define GRAPH_CANON_BENCHMARK_MICRO_BENCHMARK_HPP
+
+// A minimal harness for timing single kernels.
+// Each benchmark program must include this header in exactly one translation unit,
+// as it replaces the global allocation functions to count the bytes allocated by the kernels.
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graph_canon_benchmark {
+namespace detail {
+
+inline std::atomic<std::size_t> &allocated_bytes() {
+	static std::atomic<std::size_t> bytes(0);
+	return bytes;
+}
+
+inline std::atomic<std::size_t> &allocation_count() {
+	static std::atomic<std::size_t> count(0);
+	return count;
+}
+
+} // namespace detail
+} // namespace graph_canon_benchmark
+
+void *operator new(std::size_t size) {
+	graph_canon_benchmark::detail::allocated_bytes().fetch_add(size, std::memory_order_relaxed);
+	graph_canon_benchmark::detail::allocation_count().fetch_add(1, std::memory_order_relaxed);
+	if(void *p = std::malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	graph_canon_benchmark::detail::allocated_bytes().fetch_add(size, std::memory_order_relaxed);
+	graph_canon_benchmark::detail::allocation_count().fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept {
+	std::free(p);
+}
+
+namespace graph_canon_benchmark {
+namespace po = boost::program_options;
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+
+// Make sure the compiler can not discard the computation of a value.
+
+template<typename T>
+inline void do_not_optimize(const T &value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct options {
+	std::vector<std::size_t> sizes = {100, 1000, 10000};
+	std::vector<std::size_t> degrees = {4, 16};
+	double min_time = 0.2; // seconds per benchmark
+	std::size_t seed = 0;
+	std::string filter;
+};
+
+// Parse the common options, returns false if the program should exit.
+
+inline bool parse_options(int argc, char **argv, options &opts, const std::string &desc) {
+	po::options_description optionsDesc(desc + "\nOptions");
+	optionsDesc.add_options()
+			("help,h", "Print help message.")
+			("n", po::value<std::vector<std::size_t> >()->multitoken(), "The number of vertices of the synthetic graphs (default: 100 1000 10000).")
+			("degree", po::value<std::vector<std::size_t> >()->multitoken(), "The degree of the synthetic graphs (default: 4 16).")
+			("min-time", po::value<double>(&opts.min_time)->default_value(opts.min_time), "The minimum number of seconds spent on each benchmark.")
+			("seed", po::value<std::size_t>(&opts.seed)->default_value(opts.seed), "The seed for generating the synthetic graphs.")
+			("filter", po::value<std::string>(&opts.filter), "Only run benchmarks with a name containing this string.");
+	po::variables_map vm;
+	try {
+		po::store(po::command_line_parser(argc, argv).options(optionsDesc).run(), vm);
+		po::notify(vm);
+	} catch(const po::error &e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << optionsDesc << std::endl;
+		std::exit(1);
+	}
+	if(vm.count("help")) {
+		std::cout << optionsDesc << std::endl;
+		return false;
+	}
+	if(vm.count("n")) opts.sizes = vm["n"].as<std::vector<std::size_t> >();
+	if(vm.count("degree")) opts.degrees = vm["degree"].as<std::vector<std::size_t> >();
+	std::cout << "benchmark\tn\tdegree\titerations\tns/op\tbytes/op\tallocs/op" << std::endl;
+	return true;
+}
+
+// The state given to each benchmark function, which must run the kernel once per iteration:
+//
+//   while(s.keep_running()) { ... }
+//
+// Setup code inside the loop can be excluded from the measurements with pause() and resume().
+
+class state {
+	using Clock = std::chrono::steady_clock;
+public:
+
+	explicit state(std::size_t iterations) : remaining(iterations) { }
+
+	bool keep_running() {
+		if(remaining == 0) {
+			if(running) pause();
+			return false;
+		}
+		if(!running) resume();
+		--remaining;
+		return true;
+	}
+
+	void pause() {
+		elapsed += Clock::now() - start;
+		bytes += detail::allocated_bytes().load(std::memory_order_relaxed) - start_bytes;
+		allocations += detail::allocation_count().load(std::memory_order_relaxed) - start_allocations;
+		running = false;
+	}
+
+	void resume() {
+		running = true;
+		start_bytes = detail::allocated_bytes().load(std::memory_order_relaxed);
+		start_allocations = detail::allocation_count().load(std::memory_order_relaxed);
+		start = Clock::now();
+	}
+
+	double get_seconds() const {
+		return std::chrono::duration<double>(elapsed).count();
+	}
+
+	std::size_t get_bytes() const {
+		return bytes;
+	}
+
+	std::size_t get_allocations() const {
+		return allocations;
+	}
+private:
+	std::size_t remaining;
+	bool running = false;
+	Clock::time_point start;
+	Clock::duration elapsed = Clock::duration::zero();
+	std::size_t start_bytes = 0, bytes = 0;
+	std::size_t start_allocations = 0, allocations = 0;
+};
+
+// Print a line with the time and the allocations per iteration of a finished benchmark.
+
+inline void report(const std::string &name, std::size_t n, std::size_t degree, std::size_t iterations, const state &s) {
+	const double perIteration = 1.0 / std::max<std::size_t>(iterations, 1);
+	std::cout << name << "\t" << n << "\t" << degree << "\t" << iterations
+			<< "\t" << s.get_seconds() * 1e9 * perIteration
+			<< "\t" << s.get_bytes() * perIteration
+			<< "\t" << s.get_allocations() * perIteration << std::endl;
+}
+
+// Run the benchmark with an increasing number of iterations until it takes at least opts.min_time.
+
+template<typename F>
+void run(const options &opts, const std::string &name, std::size_t n, std::size_t degree, F f) {
+	if(name.find(opts.filter) == std::string::npos) return;
+	std::size_t iterations = 1;
+	while(true) {
+		state s(iterations);
+		f(s);
+		const double seconds = s.get_seconds();
+		if(seconds >= opts.min_time || iterations >= (std::size_t(1) << 40)) {
+			report(name, n, degree, iterations, s);
+			return;
+		}
+		// aim for the minimum time, but grow by at most a factor 10 at a time
+		const double factor = seconds <= 0 ? 10 : std::min(10.0, 1.4 * opts.min_time / seconds);
+		iterations = std::max(iterations + 1, std::size_t(iterations * factor));
+	}
+}
+
+// Synthetic graphs
+// -----------------------------------------------------------------------------
+
+// A random graph on n vertices which is the union of degree / 2 random Hamiltonian cycles.
+// Edges of a new cycle that are already in the graph are removed by swapping vertices of the cycle,
+// so for n much larger than the degree the graph is regular, and thus has an equitable unit partition.
+
+template<typename Gen>
+Graph make_random_regular_graph(std::size_t n, std::size_t degree, Gen &gen) {
+	Graph g(n);
+	if(n < 3) return g;
+	std::set<std::pair<std::size_t, std::size_t> > edges;
+	const auto make_edge = [](std::size_t u, std::size_t v) {
+		return std::make_pair(std::min(u, v), std::max(u, v));
+	};
+	std::vector<std::size_t> cycle(n);
+	std::iota(cycle.begin(), cycle.end(), 0);
+	for(std::size_t c = 0; c < degree / 2; ++c) {
+		std::shuffle(cycle.begin(), cycle.end(), gen);
+		for(int pass = 0; pass < 100; ++pass) {
+			bool clean = true;
+			for(std::size_t i = 0; i < n; ++i) {
+				if(edges.find(make_edge(cycle[i], cycle[(i + 1) % n])) == edges.end()) continue;
+				std::swap(cycle[(i + 1) % n], cycle[gen() % n]);
+				clean = false;
+			}
+			if(clean) break;
+		}
+		for(std::size_t i = 0; i < n; ++i)
+			edges.insert(make_edge(cycle[i], cycle[(i + 1) % n]));
+	}
+	for(const auto &e : edges) add_edge(e.first, e.second, g);
+	return g;
+}
+
+// The circulant graph where each vertex i is adjacent to i +- 1, ..., i +- degree / 2 (mod n),
+// which has the dihedral group as automorphisms, and thus a search tree with many automorphic leaves.
+
+inline Graph make_circulant_graph(std::size_t n, std::size_t degree) {
+	Graph g(n);
+	if(n < 3) return g;
+	const std::size_t k = std::min(degree / 2, (n - 1) / 2);
+	for(std::size_t i = 0; i < n; ++i)
+		for(std::size_t d = 1; d <= k; ++d)
+			add_edge(i, (i + d) % n, g);
+	return g;
+}
+
+} // namespace graph_canon_benchmark
+
+#endif // GRAPH_CANON_BENCHMARK_MICRO_BENCHMARK_HPP
@@ -1,6 +1,7 @@
 #include "util.hpp"
 
 #include <graph_canon/dimacs_graph_io.hpp>
+#include <graph_canon/mapped_csr_graph.hpp>
 #include <graph_canon/util.hpp>
 
 #include <boost/graph/adjacency_list.hpp>
@@ -15,6 +16,7 @@ namespace po = boost::program_options;
 
 struct Options {
 	std::string file;
+	std::string csrFile;
 	std::mt19937 gen;
 	std::size_t seed;
 	bool permute = false;
@@ -29,7 +31,8 @@ struct Options {
 // rst:
 // rst: A program for checking the syntax of a graph in DIMACS format
 // rst: (see :cpp:func:`read_dimacs_graph`),
-// rst: and optionally print a permuted version of it.
+// rst: and optionally print a permuted version of it,
+// rst: or convert it to the binary CSR format (see :cpp:class:`mapped_csr_file`).
 // rst:
 
 int main(int argc, char **argv) {
@@ -53,6 +56,11 @@ int main(int argc, char **argv) {
 			// rst:
 			// rst:		Make a random permutation of the graph and print it to stdout.
 			("permute", "Make a random permutation of the graph and print it to stdout.")
+			// rst: .. option:: --csr <file>
+			// rst:
+			// rst:		Write the graph with its vertex labels in the binary CSR format to the given file,
+			// rst:		with 32-bit vertex indices.
+			("csr", po::value<std::string>(&options.csrFile), "Write the graph in the binary CSR format to the given file.")
 			;
 
 	po::variables_map rawOptions;
@@ -89,14 +97,14 @@ int main(int argc, char **argv) {
 	Graph g;
 	bool res;
 	if(options.file == "-") {
-		res = graph_canon::read_dimacs_graph(std::cin, g, std::cerr, parHandler, loopHandler);
+		res = graph_canon::read_dimacs_graph_fast(std::cin, g, std::cerr, parHandler, loopHandler);
 	} else {
 		std::ifstream ifs(options.file);
 		if(!ifs) {
 			std::cerr << "Could not open file '" << options.file << "'.\n";
 			std::exit(1);
 		}
-		res = graph_canon::read_dimacs_graph(ifs, g, std::cerr, parHandler, loopHandler);
+		res = graph_canon::read_dimacs_graph_fast(ifs, g, std::cerr, parHandler, loopHandler);
 	}
 	if(!res) {
 		std::cerr << "Could not parse input.\n";
@@ -110,5 +118,21 @@ int main(int argc, char **argv) {
 		graph_canon::permute_graph(g, g_permuted, permutation);
 		graph_canon::write_dimacs_graph(std::cout, g_permuted);
 	}
+	if(!options.csrFile.empty()) {
+		BGL_FORALL_EDGES(e, g, Graph) {
+			if(source(e, g) != target(e, g)) continue;
+			std::cerr << "Loops can not be stored in the binary CSR format.\n";
+			std::exit(1);
+		}
+		std::ofstream ofs(options.csrFile, std::ios::binary);
+		if(!ofs) {
+			std::cerr << "Could not open file '" << options.csrFile << "'.\n";
+			std::exit(1);
+		}
+		if(!graph_canon::write_csr_graph<std::uint32_t>(ofs, g, get(boost::vertex_index_t(), g), get(boost::vertex_name_t(), g))) {
+			std::cerr << "Could not write file '" << options.csrFile << "'.\n";
+			std::exit(1);
+		}
+	}
 	return 0;
 }
\ No newline at end of file
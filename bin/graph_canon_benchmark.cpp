@@ -1,12 +1,16 @@
 #include "graph_canon_util.hpp"
 #include "graph_canon/visitor/stats.hpp"
+#include "graph_canon/visitor/profile.hpp"
 
 #include <boost/type_traits/is_same.hpp>
 
+#include <sys/resource.h>
+
 struct BenchmarkOptions : Options {
 
 	void from(const po::variables_map &vm) {
 		Options::from(vm);
+		counters = vm.count("perf-counters") > 0;
 	}
 
 	std::ostream &printHeader(std::ostream &s) const {
@@ -22,9 +26,30 @@ public:
 
 struct ModeBenchmark {
 
-	template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-	auto canonicalize(const Options &options, std::size_t round, const Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
-		return canonicalize_switch_alg(options, g, vLess, edgeHandler, visitor);
+	static void printCountersHeader(std::ostream &s) {
+		for(const char *phase : {"root", "search", "leaf"})
+			for(const char *counter : {"cycles", "instructions", "cache-misses", "branch-misses", "ipc"})
+				s << "\t" << phase << "-" << counter;
+	}
+
+	// the columns are kept when the counters are unavailable, so rows of different runs still line up
+
+	static void printCounters(std::ostream &s, const graph_canon::profile_data &profile) {
+		for(const auto phase : {graph_canon::profile_phase::root_refinement, graph_canon::profile_phase::tree_search,
+				graph_canon::profile_phase::leaf_comparison}) {
+			const auto &c = profile.get(phase);
+			if(profile.has_counters) {
+				s << "\t" << c.cycles << "\t" << c.instructions << "\t" << c.cache_misses << "\t" << c.branch_misses
+						<< "\t" << std::fixed << std::setprecision(3) << c.get_ipc() << std::defaultfloat;
+			} else {
+				s << "\t-\t-\t-\t-\t-";
+			}
+		}
+	}
+
+	template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+	auto canonicalize(const Options &options, std::size_t round, const Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
+		return canonicalize_switch_alg(options, g, vLess, edgeHandler, visitor, handler);
 	}
 
 	template<typename Graph>
@@ -32,7 +57,13 @@ struct ModeBenchmark {
 		Options::Clock::duration time(0);
 		std::vector<std::size_t> id_permutation(num_vertices(g));
 		for(std::size_t i = 0; i < num_vertices(g); i++) id_permutation[i] = i;
-		options.printHeader(std::cout) << "	max-nodes	nodes	n	m	round	time (ms)" << std::endl;
+		if(!options.headerPrinted) {
+			options.printHeader(std::cout) << "	max-nodes	nodes	n	m	round	time (ms)"
+				<< "	aut-explicit	aut-implicit	time (us)	peak-rss (kB)	peak-memory (B)";
+			if(options.counters) printCountersHeader(std::cout);
+			std::cout << std::endl;
+		}
+		options.headerPrinted = true;
 		std::stringstream sPrefix;
 		options.printValues(sPrefix);
 		std::string prefix = sPrefix.str();
@@ -51,16 +82,33 @@ struct ModeBenchmark {
 #else
 					graph_canon::edge_handler_all_equal(),
 #endif
-					graph_canon::stats_visitor()
-					);
-			const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+					graph_canon::stats_visitor(),
+					[](auto &&res) {
+						return std::make_pair(std::move(get(graph_canon::stats_visitor::result_t(), res.second)),
+								std::move(get(graph_canon::profile_result_t(), res.second)));
+					});
 			Options::Clock::duration dur = Options::Clock::now() - start;
+			const auto &stats = res.first;
+			const auto &profile = res.second;
+			if(options.counters && !profile.has_counters && !counterWarningPrinted) {
+				std::cerr << "Warning: hardware counters unavailable, " << profile.counter_error << std::endl;
+				counterWarningPrinted = true;
+			}
+			struct rusage usage;
+			getrusage(RUSAGE_SELF, &usage);
 			std::cout << prefix << "\t" << stats.max_num_tree_nodes << "\t" << stats.num_tree_nodes
 				<< "\t" << num_vertices(g) << "\t" << num_edges(g) << "\t" << i
-				<< "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(dur).count() << std::endl;
+				<< "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(dur).count()
+				<< "\t" << stats.num_explicit_automorphisms << "\t" << stats.num_implicit_automorphisms
+				<< "\t" << std::chrono::duration_cast<std::chrono::microseconds>(dur).count()
+				<< "\t" << usage.ru_maxrss << "\t" << stats.memory_peak;
+			if(options.counters) printCounters(std::cout, profile);
+			std::cout << std::endl;
 			time += dur;
 		}
 	}
+private:
+	bool counterWarningPrinted = false;
 };
 
 int main(int argc, char **argv) {
@@ -70,6 +118,13 @@ int main(int argc, char **argv) {
 	// rst:
 	// rst: The program perform several rounds of canonicalization,
 	// rst: all on randomly permuted versions of the input graph.
+	// rst: After each round a line is printed with the maximum number of tree nodes alive at the same time,
+	// rst: the total number of tree nodes, the number of vertices and edges, the round number,
+	// rst: the time in milliseconds, the number of automorphisms found explicitly from leaves
+	// rst: and implicitly by other visitors, the time in microseconds,
+	// rst: and the peak resident set size of the process so far, in kilobytes.
+	// rst: With :option:`--perf-counters` the line ends with further columns of hardware counters.
+	// rst: See :ref:`graph_canon_bench` for running such benchmarks over collections of graphs.
 	// rst:
 	std::string modeDesc =
 			"Benchmark mode: perform at least <permutations> canonicalizations, "
@@ -81,6 +136,17 @@ int main(int argc, char **argv) {
 			// rst:
 			// rst:		Time limit (in seconds). This is only checked after each round finishes.
 			("time,t", po::value<std::size_t>(&options.time)->default_value(60), "Time limit (in seconds). This is only checked after each round finishes.")
+			// rst: .. option:: --perf-counters
+			// rst:
+			// rst:		Collect hardware performance counters of each round with :class:`perf_counters`,
+			// rst:		for each of the phases root refinement, tree search, and leaf comparison (see :class:`profile_phase`).
+			// rst:		For each phase, in that order, the columns ``<phase>-cycles``, ``<phase>-instructions``, ``<phase>-cache-misses``,
+			// rst:		``<phase>-branch-misses``, and ``<phase>-ipc`` are added, with ``root``, ``search``, and ``leaf`` as phase names.
+			// rst:		The search includes the leaf comparisons.
+			// rst:		Only the main thread is counted, so with :option:`--ftree-traversal` ``parallel`` the other threads are missing.
+			// rst:		If the kernel does not allow the counters, e.g., due to ``/proc/sys/kernel/perf_event_paranoid``
+			// rst:		or a missing PMU in a virtual machine, a warning is printed and the columns are ``-``.
+			("perf-counters", "Add columns with hardware performance counters per phase of each round.")
 			;
 	return common_main<ModeBenchmark>(argc, argv, options, optionsDesc, modeDesc);
 }
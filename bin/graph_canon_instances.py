@@ -0,0 +1,35 @@
+# The graph database shared by graph-canon-run and graph-canon-bench,
+# see the documentation of graph-canon-run for its structure.
+
+import inspect
+import os
+
+graphsDir = os.environ.get("GRAPH_CANON_DATA_DIR")
+if not graphsDir:
+	dataDir = os.path.dirname(inspect.stack()[0][1])
+	graphsDir = os.path.join(dataDir, "graphs")
+
+
+class Instance(object):
+	def __init__(self, package, collection, instance):
+		self.package = package
+		self.collection = collection
+		self.instance = instance
+		self.fullname = "%s/%s/%s" % (package, collection, instance)
+
+	def __hash__(self):
+		return hash(self.fullname)
+
+	def __eq__(self, other):
+		return self.fullname == other.fullname
+
+def loadInstances():
+	instances = []
+	for p in os.listdir(graphsDir):
+		if not os.path.isdir(os.path.join(graphsDir, p)): continue
+		for c in os.listdir(os.path.join(graphsDir, p)):
+			if not os.path.isdir(os.path.join(graphsDir, p, c)): continue
+			for i in os.listdir(os.path.join(graphsDir, p, c)):
+				instances.append(Instance(p, c, i))
+	instances = sorted(instances, key=lambda i: (i.package, i.collection, i.instance))
+	return instances
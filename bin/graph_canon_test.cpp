@@ -1,6 +1,9 @@
 #include "graph_canon_util.hpp"
 
+#include <graph_canon/certificate_io.hpp>
+#include <graph_canon/graph6_io.hpp>
 #include <graph_canon/visitor/debug.hpp>
+#include <graph_canon/visitor/profile.hpp>
 #include <graph_canon/visitor/stats.hpp>
 
 struct TestOptions : Options {
@@ -15,6 +18,7 @@ struct TestOptions : Options {
 		debugRefine = allDebug || vm.count("grefine") > 0;
 		debugCompressed = vm.count("gcompressed") > 0;
 		stats = vm.count("stats") > 0;
+		profile = stats;
 	}
 
 	std::ostream &printHeader(std::ostream &s) const {
@@ -24,11 +28,35 @@ struct TestOptions : Options {
 	std::ostream &printValues(std::ostream &s) const {
 		return Options::printValues(s);
 	}
+
+	// the writer is kept open, such that a batch run writes the certificates of all graphs to the same file
+	graph_canon::canonical_certificate_writer &getCertificateWriter() {
+		if(!certificateWriter) {
+			certificateFile.reset(new std::ofstream(certificate, std::ios::binary));
+			if(!*certificateFile)
+				throw std::runtime_error("Could not open certificate file '" + certificate + "'.");
+			certificateWriter.reset(new graph_canon::canonical_certificate_writer(*certificateFile));
+		}
+		return *certificateWriter;
+	}
+
+	std::ostream &getCanonGraph6File() {
+		if(!canonGraph6File) {
+			canonGraph6File.reset(new std::ofstream(canonGraph6, std::ios::binary));
+			if(!*canonGraph6File)
+				throw std::runtime_error("Could not open graph6 file '" + canonGraph6 + "'.");
+		}
+		return *canonGraph6File;
+	}
 public:
 	bool last;
 	bool debugTree, debugCanon, debugAut, debugRefine, debugCompressed;
-	std::string graphDot, treeDot, logJson;
+	std::string graphDot, treeDot, logJson, certificate, canonGraph6;
 	bool stats;
+private:
+	std::unique_ptr<std::ofstream> certificateFile;
+	std::unique_ptr<graph_canon::canonical_certificate_writer> certificateWriter;
+	std::unique_ptr<std::ofstream> canonGraph6File;
 };
 
 struct ModeTest {
@@ -77,8 +105,8 @@ struct ModeTest {
 		return PrintVisitor<Graph, Idx>(g1, g2, idx1, idx2);
 	}
 
-	template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-	auto canonicalize_switch_debug(bool printStuff, const TestOptions &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+	template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+	auto canonicalize_switch_debug(bool printStuff, const TestOptions &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 		//		if(options.debugCanon || options.debugRefine || options.debugTree) {
 		std::unique_ptr<std::ofstream> logJson;
 		if(printStuff && !options.logJson.empty()) {
@@ -89,7 +117,7 @@ struct ModeTest {
 		auto debugVisitor = graph_canon::debug_visitor(options.debugTree && printStuff, options.debugCanon && printStuff, options.debugAut && printStuff,
 				options.debugRefine && printStuff, options.debugCompressed && printStuff, logJson.get());
 		auto newVisitor = graph_canon::make_visitor(visitor, debugVisitor);
-		auto res = canonicalize_switch_alg(options, g, vLess, edgeHandler, newVisitor);
+		auto res = canonicalize_switch_alg(options, g, vLess, edgeHandler, newVisitor, handler);
 		if(logJson) {
 			*logJson << "\n]\n";
 		}
@@ -118,11 +146,17 @@ struct ModeTest {
 			if(!*treeDot)
 				throw std::runtime_error("Could not open treeDot file '" + options.treeDot + "'.");
 		}
+		// the permutation is of the size type selected for the graph, so convert it to a common type
 		auto res = canonicalize_switch_debug(withStuff, options, g, vLess, edgeHandler,
-				graph_canon::stats_visitor(treeDot.get()));
-		auto permutation = std::move(res.first);
-		const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
-		if(withStuff && options.stats) std::cout << "Stats:\n" << stats;
+				graph_canon::stats_visitor(treeDot.get()),
+				[](auto &&result) {
+					return std::make_tuple(std::vector<std::size_t>(result.first.begin(), result.first.end()),
+							std::move(get(graph_canon::stats_visitor::result_t(), result.second)),
+							std::move(get(graph_canon::profile_result_t(), result.second)));
+				});
+		auto permutation = std::move(std::get<0>(res));
+		const auto &stats = std::get<1>(res);
+		if(withStuff && options.stats) std::cout << "Stats:\n" << stats << "Profile:\n" << std::get<2>(res);
 		if(withStuff && graphDot) {
 			std::ostream &s = *graphDot;
 			bool isUndirected = boost::is_undirected_graph<Graph>::value;
@@ -151,7 +185,9 @@ struct ModeTest {
 	void execute(TestOptions &options, const Graph &g) {
 		Options::Clock::duration time(0);
 		Options::Clock::time_point start = Options::Clock::now();
-		options.printHeader(std::cout) << "	max-nodes	nodes	n	m	round	time (ms)" << std::endl;
+		if(!options.headerPrinted)
+			options.printHeader(std::cout) << "	max-nodes	nodes	n	m	round	time (ms)" << std::endl;
+		options.headerPrinted = true;
 		auto canon_res = canonicalize(options, 0, g,
 				graph_canon::make_property_less(get(boost::vertex_name_t(), g)),
 #ifdef GRAPH_CANON_EDGE_LABELS
@@ -166,6 +202,15 @@ struct ModeTest {
 		const auto numTreeNodes = std::get<2>(canon_res);
 		options.printValues(std::cout) << "\t" << maxTreeNodes << "\t" << numTreeNodes << "\t" << num_vertices(g) << "\t" << num_edges(g) << "\t"
 				<< 0 << "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(time).count() << std::endl;
+		if(!options.certificate.empty()) {
+			graph_canon::canonical_certificate_writer &writer = options.getCertificateWriter();
+			if(options.vLabelMode == LabelMode::None)
+				writer.write(g, get(boost::vertex_index_t(), g), idx, true);
+			else
+				writer.write_labelled(g, get(boost::vertex_index_t(), g), idx, get(boost::vertex_name_t(), g), true);
+		}
+		if(!options.canonGraph6.empty())
+			graph_canon::write_graph6(options.getCanonGraph6File(), g, get(boost::vertex_index_t(), g), idx);
 		auto idxMap = boost::make_iterator_property_map(idx.cbegin(), get(boost::vertex_index_t(), g));
 		graph_canon::ordered_graph<Graph, decltype(idxMap) > orderedInputCanon(g, idxMap,
 				graph_canon::make_property_less(get(boost::edge_name_t(), g)));
@@ -259,6 +304,7 @@ struct ModeTest {
 			bool less = graph_canon::ordered_graph_less(orderedInputCanon, orderedPermutedCanon, vLess, eLess, vEqual, eEqual);
 			(void) less;
 		}
+		if(options.batch) return;
 		std::size_t totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
 		std::cout << "Time: " << totalTime << " ms (" << (static_cast<double> (totalTime) / (options.rounds + 1))
 				<< " ms, " << (options.rounds + 1) << " rounds)" << std::endl;
@@ -298,6 +344,19 @@ int main(int argc, char **argv) {
 			// rst:		Print log data as JSON to a file, suitable for the GraphCanon Visualizer.
 			// rst:		The output is not affected by the ``--g*`` options.
 			("json", po::value<std::string>(&options.logJson), "Print log data as JSON to a file, suitable for the GraphCanon Visualizer.")
+			// rst: .. option:: --certificate <filename>
+			// rst:
+			// rst:		Write the canonical form of the input graph, with its canonical labelling, to this file
+			// rst:		in the binary certificate format (see :cpp:class:`canonical_certificate_writer`).
+			// rst:		With :option:`--batch` the certificates of all graphs are written to the file, in the order of the input.
+			("certificate", po::value<std::string>(&options.certificate), "Write the canonical form of the input graph to this file in the binary certificate format.")
+			// rst: .. option:: --canon-graph6 <filename>
+			// rst:
+			// rst:		Write the canonical form of the input graph to this file in graph6 format (see :cpp:func:`write_graph6`),
+			// rst:		i.e., in the same form as the output of ``labelg`` from nauty.
+			// rst:		With :option:`--batch` a line is written for each graph, in the order of the input.
+			// rst:		Vertex labels, loops, and parallel edges are not represented.
+			("canon-graph6", po::value<std::string>(&options.canonGraph6), "Write the canonical form of the input graph to this file in graph6 format.")
 			// rst: .. option:: -g, --gall
 			// rst:
 			// rst:		Print all debug information.
@@ -324,8 +383,10 @@ int main(int argc, char **argv) {
 			("gcompressed", "Print debug information in a shorter format.")
 			// rst: .. option:: --stats
 			// rst:
-			// rst:		Print statistics from one canonicalization run.
-			("stats", "Print statistics from one canonicalization run.")
+			// rst:		Print statistics from one canonicalization run,
+			// rst:		and a breakdown of its time by visitor event (see :class:`profile_visitor`).
+			// rst:		As all runs are then profiled, the reported times include the overhead of the profiling.
+			("stats", "Print statistics and a time profile from one canonicalization run.")
 			;
 	return common_main<ModeTest>(argc, argv, options, optionsDesc, modeDesc);
 }
\ No newline at end of file
@@ -42,18 +42,29 @@
 #include <graph_canon/target_cell/flm.hpp>
 #include <graph_canon/tree_traversal/bfs-exp.hpp>
 #include <graph_canon/tree_traversal/bfs-exp-m.hpp>
+#include <graph_canon/tree_traversal/dfs-trail.hpp>
+#include <graph_canon/tree_traversal/parallel.hpp>
 #include <graph_canon/dimacs_graph_io.hpp>
+#include <graph_canon/graph6_io.hpp>
+#include <graph_canon/mapped_csr_graph.hpp>
 #include <graph_canon/util.hpp>
+#include <graph_canon/visitor/profile.hpp>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_utility.hpp> // for boost::print_graph
 #include <boost/program_options.hpp>
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <random>
+#include <type_traits>
+#include <typeindex>
 
 namespace po = boost::program_options;
 
@@ -118,15 +129,17 @@ std::ostream &operator<<(std::ostream &s, TargetCellSelector selector) {
 //------------------------------------------------------------------------------
 
 enum class TreeTraversal {
-	DFS, BFSExp, BFSExpM
+	DFS, DFSTrail, BFSExp, BFSExpM, Parallel
 };
 
 std::istream &operator>>(std::istream &s, TreeTraversal &tree) {
 	std::string token;
 	s >> token;
 	if(token == "dfs") tree = TreeTraversal::DFS;
+	else if(token == "dfs-trail") tree = TreeTraversal::DFSTrail;
 	else if(token == "bfs-exp") tree = TreeTraversal::BFSExp;
 	else if(token == "bfs-exp-m") tree = TreeTraversal::BFSExpM;
+	else if(token == "parallel") tree = TreeTraversal::Parallel;
 	else throw po::invalid_option_value("invalid tree traversal algorithm '" + token + "'");
 	return s;
 }
@@ -134,8 +147,10 @@ std::istream &operator>>(std::istream &s, TreeTraversal &tree) {
 std::ostream &operator<<(std::ostream &s, TreeTraversal tree) {
 	switch(tree) {
 	case TreeTraversal::DFS: return s << "dfs";
+	case TreeTraversal::DFSTrail: return s << "dfs-trail";
 	case TreeTraversal::BFSExp: return s << "bfs-exp";
 	case TreeTraversal::BFSExpM: return s << "bfs-exp-m";
+	case TreeTraversal::Parallel: return s << "parallel";
 	}
 	return s;
 }
@@ -156,6 +171,7 @@ struct Options {
 		directed = vm.count("directed") > 0;
 		parallelEdges = vm.count("parallel-edges") > 0;
 		loops = vm.count("loops") > 0;
+		batch = vm.count("batch") > 0;
 	}
 
 	std::ostream &printHeader(std::ostream &s) const {
@@ -163,13 +179,25 @@ struct Options {
 	}
 
 	std::ostream &printValues(std::ostream &s) const {
-		return s << id
+		return s << id << idSuffix
 				<< "\t" << std::setw(11) << std::left << targetCellSelector
 				<< "\t" << std::setw(14) << std::left << treeTraversal
 				<< postId;
 	}
+
+	// The canonicalizer of the given type, kept between calls such that its workspace is reused.
+	// Only edge handler creators without state are shared, as others may refer to a specific graph.
+
+	template<typename Canonicalizer, typename EdgeHandler>
+	Canonicalizer &getCanonicalizer(EdgeHandler edgeHandler) const {
+		static_assert(std::is_empty<EdgeHandler>::value, "Only stateless edge handler creators can be shared.");
+		auto &c = canonicalizers[std::type_index(typeid(Canonicalizer))];
+		if(!c) c = std::make_shared<Canonicalizer>(edgeHandler);
+		return *static_cast<Canonicalizer*> (c.get());
+	}
 public:
 	std::string id, postId, postHeader;
+	std::string idSuffix; // the index of the graph in batch mode
 	std::mt19937 gen;
 	std::string dimacs;
 	LabelMode vLabelMode, eLabelMode;
@@ -180,6 +208,16 @@ public:
 	TargetCellSelector targetCellSelector;
 	TreeTraversal treeTraversal;
 	std::size_t max_mem;
+	std::size_t num_threads;
+	// batch mode
+	bool batch;
+	bool headerPrinted = false;
+	// time the visitor events, see graph_canon::profile_visitor
+	bool profile = false;
+	// sample the hardware counters per phase, see graph_canon::perf_counters
+	bool counters = false;
+private:
+	mutable std::map<std::type_index, std::shared_ptr<void> > canonicalizers;
 };
 
 struct dynamic_target_cell_selector : graph_canon::null_visitor {
@@ -225,6 +263,21 @@ public:
 		}
 		__builtin_unreachable();
 	}
+
+	template<typename State>
+	std::size_t memory_instance(const State &s) {
+		switch(tcs) {
+		case TargetCellSelector::F:
+			return graph_canon::target_cell_f().memory_instance(s);
+		case TargetCellSelector::FL:
+			return graph_canon::target_cell_fl().memory_instance(s);
+		case TargetCellSelector::FLM:
+			return graph_canon::target_cell_flm().memory_instance(s);
+		case TargetCellSelector::FLMCR:
+			return graph_canon::target_cell_flmcr().memory_instance(s);
+		}
+		__builtin_unreachable();
+	}
 private:
 	TargetCellSelector tcs;
 };
@@ -235,31 +288,40 @@ struct dynamic_tree_traversal : graph_canon::null_visitor {
 	template<typename Config, typename TreeNode>
 	struct InstanceData {
 		using DFS = typename graph_canon::traversal_dfs::InstanceData<Config, TreeNode>::type;
+		using DFSTrail = typename graph_canon::traversal_dfs_trail::InstanceData<Config, TreeNode>::type;
 		using BFSExp = typename graph_canon::traversal_bfs_exp::InstanceData<Config, TreeNode>::type;
 		using BFSExpM = typename graph_canon::traversal_bfs_exp_m::InstanceData<Config, TreeNode>::type;
-		using type = typename graph_canon::tagged_list_concat<DFS, BFSExp, BFSExpM>::type;
+		using Parallel = typename graph_canon::traversal_parallel::InstanceData<Config, TreeNode>::type;
+		using type = typename graph_canon::tagged_list_concat<DFS, DFSTrail, BFSExp, BFSExpM, Parallel>::type;
 	};
 
 	template<typename Config, typename TreeNode>
 	struct TreeNodeData {
 		using DFS = typename graph_canon::traversal_dfs::TreeNodeData<Config, TreeNode>::type;
+		using DFSTrail = typename graph_canon::traversal_dfs_trail::TreeNodeData<Config, TreeNode>::type;
 		using BFSExp = typename graph_canon::traversal_bfs_exp::TreeNodeData<Config, TreeNode>::type;
 		using BFSExpM = typename graph_canon::traversal_bfs_exp_m::TreeNodeData<Config, TreeNode>::type;
-		using type = typename graph_canon::tagged_list_concat<DFS, BFSExp, BFSExpM>::type;
+		using Parallel = typename graph_canon::traversal_parallel::TreeNodeData<Config, TreeNode>::type;
+		using type = typename graph_canon::tagged_list_concat<DFS, DFSTrail, BFSExp, BFSExpM, Parallel>::type;
 	};
 public:
 
-	dynamic_tree_traversal(TreeTraversal tt, std::size_t max_mem) : tt(tt), max_mem(max_mem) { }
+	dynamic_tree_traversal(TreeTraversal tt, std::size_t max_mem, std::size_t num_threads)
+	: tt(tt), max_mem(max_mem), num_threads(num_threads) { }
 
 	template<typename State>
 	void initialize(State &state) {
 		switch(tt) {
 		case TreeTraversal::DFS:
 			return graph_canon::traversal_dfs().initialize(state);
+		case TreeTraversal::DFSTrail:
+			return graph_canon::traversal_dfs_trail().initialize(state);
 		case TreeTraversal::BFSExp:
 			return graph_canon::traversal_bfs_exp().initialize(state);
 		case TreeTraversal::BFSExpM:
 			return graph_canon::traversal_bfs_exp_m(max_mem).initialize(state);
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).initialize(state);
 		}
 	}
 
@@ -268,10 +330,14 @@ public:
 		switch(tt) {
 		case TreeTraversal::DFS:
 			return graph_canon::traversal_dfs().tree_create_node_begin(state, t);
+		case TreeTraversal::DFSTrail:
+			return graph_canon::traversal_dfs_trail().tree_create_node_begin(state, t);
 		case TreeTraversal::BFSExp:
 			return graph_canon::traversal_bfs_exp().tree_create_node_begin(state, t);
 		case TreeTraversal::BFSExpM:
 			return graph_canon::traversal_bfs_exp_m(max_mem).tree_create_node_begin(state, t);
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).tree_create_node_begin(state, t);
 		}
 		__builtin_unreachable();
 	}
@@ -281,10 +347,14 @@ public:
 		switch(tt) {
 		case TreeTraversal::DFS:
 			return graph_canon::traversal_dfs().tree_destroy_node(state, t);
+		case TreeTraversal::DFSTrail:
+			return graph_canon::traversal_dfs_trail().tree_destroy_node(state, t);
 		case TreeTraversal::BFSExp:
 			return graph_canon::traversal_bfs_exp().tree_destroy_node(state, t);
 		case TreeTraversal::BFSExpM:
 			return graph_canon::traversal_bfs_exp_m(max_mem).tree_destroy_node(state, t);
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).tree_destroy_node(state, t);
 		}
 	}
 
@@ -293,10 +363,14 @@ public:
 		switch(tt) {
 		case TreeTraversal::DFS:
 			return graph_canon::traversal_dfs().tree_prune_node(state, t);
+		case TreeTraversal::DFSTrail:
+			return graph_canon::traversal_dfs_trail().tree_prune_node(state, t);
 		case TreeTraversal::BFSExp:
 			return graph_canon::traversal_bfs_exp().tree_prune_node(state, t);
 		case TreeTraversal::BFSExpM:
 			return graph_canon::traversal_bfs_exp_m(max_mem).tree_prune_node(state, t);
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).tree_prune_node(state, t);
 		}
 	}
 
@@ -305,19 +379,68 @@ public:
 		switch(tt) {
 		case TreeTraversal::DFS:
 			return graph_canon::traversal_dfs().explore_tree(state);
+		case TreeTraversal::DFSTrail:
+			return graph_canon::traversal_dfs_trail().explore_tree(state);
 		case TreeTraversal::BFSExp:
 			return graph_canon::traversal_bfs_exp().explore_tree(state);
 		case TreeTraversal::BFSExpM:
 			return graph_canon::traversal_bfs_exp_m(max_mem).explore_tree(state);
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).explore_tree(state);
+		}
+	}
+
+	template<typename State, typename TreeNode>
+	void canon_new_best(State &state, TreeNode *previous) {
+		switch(tt) {
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).canon_new_best(state, previous);
+		default:
+			return;
+		}
+	}
+
+	template<typename State, typename TreeNode, typename Perm>
+	void automorphism_leaf(State &state, TreeNode &t, const Perm &aut) {
+		switch(tt) {
+		case TreeTraversal::Parallel:
+			return graph_canon::traversal_parallel(num_threads).automorphism_leaf(state, t, aut);
+		default:
+			return;
+		}
+	}
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		switch(tt) {
+		case TreeTraversal::BFSExpM:
+			return graph_canon::traversal_bfs_exp_m(max_mem).memory_instance(state);
+		default:
+			return 0;
 		}
 	}
 private:
 	TreeTraversal tt;
 	std::size_t max_mem;
+	std::size_t num_threads;
 };
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_call_alg(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Canonicalizer, typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto call_canonicalizer(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler,
+		std::true_type /*shared*/) {
+	Canonicalizer &canonicalizer = options.getCanonicalizer<Canonicalizer>(edgeHandler);
+	return handler(canonicalizer(g, get(boost::vertex_index_t(), g), vLess, graph_canon::profile_visitor<Visitor>(visitor, options.profile, options.counters)));
+}
+
+template<typename Canonicalizer, typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto call_canonicalizer(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler,
+		std::false_type /*shared*/) {
+	Canonicalizer canonicalizer(edgeHandler);
+	return handler(canonicalizer(g, get(boost::vertex_index_t(), g), vLess, graph_canon::profile_visitor<Visitor>(visitor, options.profile, options.counters)));
+}
+
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_call_alg(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 	if(options.parallelEdges) {
 		std::cerr << "Parallel edges are currently disabled." << std::endl;
 		std::exit(1);
@@ -335,93 +458,97 @@ auto canonicalize_call_alg(const Options &options, Graph &g, VertexLess vLess, E
 			//			graph_canon::canonicalizer<std::size_t, false, true> canonicalizer;
 			//			return canonicalizer(g, get(boost::vertex_index_t(), g), vLess, edgeHandler, visitor, treeTraversal);
 		} else {
-			graph_canon::canonicalizer<int, EdgeHandler, false, false> canonicalizer(edgeHandler);
-			return canonicalizer(g, get(boost::vertex_index_t(), g), vLess, visitor);
+			// the result type depends on the size type, so it is given to the handler instead of being returned
+			return graph_canon::dispatch_size_type(num_vertices(g), num_edges(g), [&](auto sizeTypeTag) {
+				using SizeType = typename decltype(sizeTypeTag)::type;
+				using Canonicalizer = graph_canon::canonicalizer<SizeType, EdgeHandler, false, false>;
+				return call_canonicalizer<Canonicalizer>(options, g, vLess, edgeHandler, visitor, handler, std::is_empty<EdgeHandler>());
+			});
 		}
 	}
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_refine(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_refine(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 	return canonicalize_call_alg(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(graph_canon::GRAPH_CANON_CAT(refine_, GRAPH_CANON_REFINE)(), visitor));
+			graph_canon::make_visitor(graph_canon::GRAPH_CANON_CAT(refine_, GRAPH_CANON_REFINE)(), visitor), handler);
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_tree_traversal(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
-	auto tt = dynamic_tree_traversal(options.treeTraversal, options.max_mem);
-	return canonicalize_refine(options, g, vLess, edgeHandler, graph_canon::make_visitor(tt, visitor));
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_tree_traversal(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
+	auto tt = dynamic_tree_traversal(options.treeTraversal, options.max_mem, options.num_threads);
+	return canonicalize_refine(options, g, vLess, edgeHandler, graph_canon::make_visitor(tt, visitor), handler);
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_target_cell_selector(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_target_cell_selector(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 	auto tc = dynamic_target_cell_selector(options.targetCellSelector);
-	return canonicalize_switch_tree_traversal(options, g, vLess, edgeHandler, graph_canon::make_visitor(tc, visitor));
+	return canonicalize_switch_tree_traversal(options, g, vLess, edgeHandler, graph_canon::make_visitor(tc, visitor), handler);
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_degree_1(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_degree_1(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_DEGREE_1
 	return canonicalize_switch_target_cell_selector(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(graph_canon::refine_degree_1(), visitor));
+			graph_canon::make_visitor(graph_canon::refine_degree_1(), visitor), handler);
 #else
-	return canonicalize_switch_target_cell_selector(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_target_cell_selector(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_aut_implicit(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_aut_implicit(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_AUT_IMPLICIT
 	return canonicalize_switch_degree_1(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(graph_canon::aut_implicit_size_2(), visitor));
+			graph_canon::make_visitor(graph_canon::aut_implicit_size_2(), visitor), handler);
 #else
-	return canonicalize_switch_degree_1(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_degree_1(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_aut_pruner(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_aut_pruner(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_AUT_PRUNER
 	return canonicalize_switch_aut_implicit(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(graph_canon::GRAPH_CANON_CAT(aut_pruner_, GRAPH_CANON_AUT_PRUNER)(), visitor));
+			graph_canon::make_visitor(graph_canon::GRAPH_CANON_CAT(aut_pruner_, GRAPH_CANON_AUT_PRUNER)(), visitor), handler);
 #else
-	return canonicalize_switch_aut_implicit(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_aut_implicit(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_quotient(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_quotient(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_QUOTIENT
 	return canonicalize_switch_aut_pruner(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(visitor, graph_canon::invariant_quotient()));
+			graph_canon::make_visitor(visitor, graph_canon::invariant_quotient()), handler);
 #else
-	return canonicalize_switch_aut_pruner(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_aut_pruner(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_trace(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_trace(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_TRACE
 	return canonicalize_switch_quotient(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(visitor, graph_canon::invariant_cell_split()));
+			graph_canon::make_visitor(visitor, graph_canon::invariant_cell_split()), handler);
 #else
-	return canonicalize_switch_quotient(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_quotient(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_partial_leaf(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_partial_leaf(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
 #ifdef GRAPH_CANON_PARTIAL_LEAF
 	return canonicalize_switch_trace(options, g, vLess, edgeHandler,
-			graph_canon::make_visitor(visitor, graph_canon::invariant_partial_leaf()));
+			graph_canon::make_visitor(visitor, graph_canon::invariant_partial_leaf()), handler);
 #else
-	return canonicalize_switch_trace(options, g, vLess, edgeHandler, visitor);
+	return canonicalize_switch_trace(options, g, vLess, edgeHandler, visitor, handler);
 #endif
 }
 
-template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor>
-auto canonicalize_switch_alg(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor) {
-	return canonicalize_switch_partial_leaf(options, g, vLess, edgeHandler, visitor);
+template<typename Graph, typename VertexLess, typename EdgeHandler, typename Visitor, typename ResultHandler>
+auto canonicalize_switch_alg(const Options &options, Graph &g, VertexLess vLess, EdgeHandler edgeHandler, Visitor visitor, ResultHandler handler) {
+	return canonicalize_switch_partial_leaf(options, g, vLess, edgeHandler, visitor, handler);
 }
 
 std::string getDefaultGraph() {
@@ -450,33 +577,20 @@ std::string getDefaultGraph() {
 	"e 8 10\n";
 }
 
-template<typename Graph>
-void loadGraph(Options &options, Graph &g) {
-	const auto parHandler = [&options](unsigned int src, unsigned int tar) {
+auto makeParallelEdgeHandler(const Options &options) {
+	return [&options](unsigned int src, unsigned int tar) {
 		if(options.parallelEdges) return true;
 		std::cerr << "Ignoring parallel edge (" << src << ", " << tar << "). Use --parallel-edges to recognise it." << std::endl;
 		return false;
 	};
-	const auto loopHandler = [&options](unsigned int v) {
+}
+
+auto makeLoopHandler(const Options &options) {
+	return [&options](unsigned int v) {
 		if(options.loops) return true;
 		std::cerr << "Ignoring loop on vertex " << v << ". Use --loops to recognise it." << std::endl;
 		return false;
 	};
-	bool res;
-	if(options.dimacs.empty()) {
-		options.setSource("default");
-		std::istringstream ss(getDefaultGraph());
-		res = graph_canon::read_dimacs_graph(ss, g, std::cerr, parHandler, loopHandler);
-	} else if(options.dimacs == "-") {
-		options.setSource("stdin");
-		res = graph_canon::read_dimacs_graph(std::cin, g, std::cerr, parHandler, loopHandler);
-	} else {
-		options.setSource(options.dimacs);
-		std::ifstream ifs(options.dimacs);
-		if(!ifs) throw std::runtime_error("Could not open file '" + options.dimacs + "'.");
-		res = graph_canon::read_dimacs_graph(ifs, g, std::cerr, parHandler, loopHandler);
-	}
-	if(!res) throw std::runtime_error("Could not parse input.");
 }
 
 template<typename Graph>
@@ -534,6 +648,173 @@ void assignLabels(Options &options, Graph &g) {
 	}
 }
 
+// Copy a graph in the binary CSR format into g,
+// with parallel edges handled as when reading a DIMACS graph.
+
+template<typename SizeType, typename Graph>
+void copyCSRGraph(const Options &options, const graph_canon::csr_graph_view<SizeType> &view, Graph &g) {
+	using View = graph_canon::csr_graph_view<SizeType>;
+	const auto parHandler = makeParallelEdgeHandler(options);
+	const auto vertexLabel = get(boost::vertex_name_t(), view);
+	for(std::size_t i = 0; i < num_vertices(view); i++) {
+		const auto v = add_vertex(g);
+		put(boost::vertex_name_t(), g, v, get(vertexLabel, i));
+	}
+	std::vector<SizeType> targets;
+	BGL_FORALL_VERTICES_T(v, view, View) {
+		targets.clear();
+		BGL_FORALL_ADJ_T(v, u, view, View) {
+			if(v < u) targets.push_back(u);
+		}
+		std::sort(targets.begin(), targets.end());
+		for(std::size_t i = 0; i < targets.size(); i++) {
+			if(i > 0 && targets[i] == targets[i - 1] && !parHandler(v + 1, targets[i] + 1)) continue;
+			add_edge(vertex(v, g), vertex(targets[i], g), g);
+		}
+	}
+}
+
+// InputFormat
+//------------------------------------------------------------------------------
+
+enum class InputFormat {
+	DIMACS, Graph6, CSR
+};
+
+// The format given by the extension of the filename, or else by the first two characters of the input:
+// graph6 lines start with a header, ':' (sparse6), '&' (digraph6), or a character from '?' to '~',
+// while DIMACS files start with a comment or problem line, i.e., 'c' or 'p' followed by whitespace.
+// Binary CSR records start with "GC", which could also be a graph6 line for 8 vertices, so use an extension for those.
+
+InputFormat detectInputFormat(const std::string &filename, std::istream &s) {
+	const auto hasExtension = [&filename](const std::string &ext) {
+		return filename.size() > ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+	};
+	for(const char *ext :{".g6", ".s6", ".d6", ".graph6", ".sparse6", ".digraph6"})
+		if(hasExtension(ext)) return InputFormat::Graph6;
+	if(hasExtension(".csr")) return InputFormat::CSR;
+	if(hasExtension(".dimacs") || hasExtension(".col")) return InputFormat::DIMACS;
+	const int first = s.get();
+	if(first == std::char_traits<char>::eof()) {
+		s.clear();
+		return InputFormat::DIMACS;
+	}
+	const int second = s.peek();
+	s.clear();
+	s.putback(static_cast<char> (first));
+	if(first == '>' || first == ':' || first == '&') return InputFormat::Graph6;
+	if(first == 'G' && second == 'C') return InputFormat::CSR;
+	if(first == 'c' || first == 'p') {
+		if(second == std::char_traits<char>::eof() || std::isspace(second)) return InputFormat::DIMACS;
+	}
+	if(first >= 63 && first <= 126) return InputFormat::Graph6;
+	return InputFormat::DIMACS;
+}
+
+// Read the graphs of an input one after another, each into an empty graph.
+// A DIMACS input may contain several graphs, each starting with its problem line,
+// and a binary CSR input may contain several concatenated records.
+
+struct GraphReader {
+	GraphReader(const Options &options, std::istream &s, InputFormat format) : options(options), format(format) {
+		switch(format) {
+		case InputFormat::DIMACS: dimacs.reset(new graph_canon::dimacs_graph_stream(s));
+			break;
+		case InputFormat::Graph6: graph6.reset(new graph_canon::graph6_stream(s));
+			break;
+		case InputFormat::CSR: csr.reset(new graph_canon::csr_graph_stream(s));
+			break;
+		}
+	}
+
+	template<typename Graph>
+	bool read(Graph &g) {
+		const auto parHandler = makeParallelEdgeHandler(options);
+		const auto loopHandler = makeLoopHandler(options);
+		switch(format) {
+		case InputFormat::DIMACS: return dimacs->read(g, std::cerr, parHandler, loopHandler);
+		case InputFormat::Graph6: return graph6->read(g, std::cerr, parHandler, loopHandler);
+		case InputFormat::CSR: break;
+		}
+		if(!csr->read(std::cerr)) return false;
+		if(!csr->validate(std::cerr)) {
+			hasFailed = true;
+			return false;
+		}
+		switch(csr->get_size_type_bytes()) {
+		case 1: copyCSRGraph(options, csr->view<std::uint8_t>(), g);
+			break;
+		case 2: copyCSRGraph(options, csr->view<std::uint16_t>(), g);
+			break;
+		case 4: copyCSRGraph(options, csr->view<std::uint32_t>(), g);
+			break;
+		default: copyCSRGraph(options, csr->view<std::uint64_t>(), g);
+		}
+		return true;
+	}
+
+	bool failed() const {
+		return hasFailed || (dimacs && dimacs->failed()) || (graph6 && graph6->failed()) || (csr && csr->failed());
+	}
+private:
+	const Options &options;
+	const InputFormat format;
+	std::unique_ptr<graph_canon::dimacs_graph_stream> dimacs;
+	std::unique_ptr<graph_canon::graph6_stream> graph6;
+	std::unique_ptr<graph_canon::csr_graph_stream> csr;
+	bool hasFailed = false;
+};
+
+// The input stream given by options.dimacs, using ss or ifs for the storage.
+
+std::istream &openInput(Options &options, std::istringstream &ss, std::ifstream &ifs) {
+	if(options.dimacs.empty()) {
+		options.setSource("default");
+		ss.str(getDefaultGraph());
+		return ss;
+	} else if(options.dimacs == "-") {
+		options.setSource("stdin");
+		return std::cin;
+	} else {
+		options.setSource(options.dimacs);
+		ifs.open(options.dimacs, std::ios::binary);
+		if(!ifs) throw std::runtime_error("Could not open file '" + options.dimacs + "'.");
+		return ifs;
+	}
+}
+
+template<typename Graph>
+void loadGraph(Options &options, Graph &g) {
+	std::istringstream ss;
+	std::ifstream ifs;
+	std::istream &s = openInput(options, ss, ifs);
+	const InputFormat format = detectInputFormat(options.dimacs, s);
+	bool res;
+	if(format == InputFormat::DIMACS) {
+		res = graph_canon::read_dimacs_graph_fast(s, g, std::cerr, makeParallelEdgeHandler(options), makeLoopHandler(options));
+	} else {
+		GraphReader reader(options, s, format);
+		res = reader.read(g);
+	}
+	if(!res) throw std::runtime_error("Could not parse input.");
+}
+
+template<typename Graph, typename Options, typename Executor>
+void loadAndExecuteBatch(Options &options, Executor &executor) {
+	std::istringstream ss;
+	std::ifstream ifs;
+	std::istream &s = openInput(options, ss, ifs);
+	GraphReader reader(options, s, detectInputFormat(options.dimacs, s));
+	for(std::size_t i = 0;; i++) {
+		Graph g;
+		if(!reader.read(g)) break;
+		options.idSuffix = "#" + std::to_string(i);
+		assignLabels(options, g);
+		executor.execute(options, g);
+	}
+	if(reader.failed()) throw std::runtime_error("Could not parse input.");
+}
+
 template<typename Options, typename Executor>
 void loadAndExecute(Options &options, Executor executor) {
 	if(options.directed) {
@@ -547,10 +828,15 @@ void loadAndExecute(Options &options, Executor executor) {
 		//		assignLabels(options, g);
 		//		executor.execute(options, graph);
 	} else { // undirected
-		boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
 				boost::property<boost::vertex_name_t, std::size_t>,
 				boost::property<boost::edge_name_t, std::size_t>
-				> g;
+				>;
+		if(options.batch) {
+			loadAndExecuteBatch<Graph>(options, executor);
+			return;
+		}
+		Graph g;
 		loadGraph(options, g);
 		assignLabels(options, g);
 		executor.execute(options, g);
@@ -622,9 +908,14 @@ int common_main(int argc, char **argv, Options &options, po::options_description
 			// rst:
 			// rst: .. option:: -f <filename>, --dimacs <filname>
 			// rst:
-			// rst:		File with graph in DIMACS format (see :cpp:func:`read_dimacs_graph`). Use '-' to read from stdin.
+			// rst:		File with graph in DIMACS format (see :cpp:func:`read_dimacs_graph`),
+			// rst:		in graph6, sparse6, or digraph6 format (see :cpp:func:`read_graph6`),
+			// rst:		or in the binary CSR format (see :cpp:class:`mapped_csr_file`). Use '-' to read from stdin.
+			// rst:		The format is given by the extension (``.dimacs``, ``.g6``, ``.s6``, ``.d6``, or ``.csr``),
+			// rst:		or else detected from the first characters of the input.
 			// rst:		If not used, a default graph is used.
-			("dimacs,f", po::value<std::string>(&options.dimacs), "File with graph in DIMACS format. Use '-' to read from stdin.")
+			("dimacs,f", po::value<std::string>(&options.dimacs), "File with graph in DIMACS, graph6, sparse6, digraph6, or binary CSR format. "
+			"Use '-' to read from stdin.")
 			// rst: .. option:: --vertex-labels <mode>
 			// rst:
 			// rst:		- ``none`` (default): vertices are unlabelled.
@@ -659,6 +950,16 @@ int common_main(int argc, char **argv, Options &options, po::options_description
 			// rst:
 			// rst:		Allow loop edges, otherwise they are ignored.
 			("loops", "Allow loop edges, otherwise they are ignored.")
+			// rst: .. option:: --batch
+			// rst:
+			// rst:		Read a whole collection of graphs from the input given with :option:`-f`, and process them one after another,
+			// rst:		with the header printed only once and the id of each graph suffixed with ``#`` and its index in the input.
+			// rst:		The input is either concatenated DIMACS graphs, each starting with its problem line (see :cpp:class:`dimacs_graph_stream`),
+			// rst:		one graph per line in graph6, sparse6, or digraph6 format (see :cpp:class:`graph6_stream`),
+			// rst:		or concatenated records in the binary CSR format (see :cpp:class:`csr_graph_stream`).
+			// rst:		The buffers of the canonicalization algorithm are reused between the graphs.
+			// rst:		Use ``-p 0`` in test mode or ``-p 1`` in benchmark mode to get a single result line per graph.
+			("batch", "Read a collection of DIMACS graphs, graph6 lines, or binary CSR records, and process them one after another.")
 			// rst:
 			// rst: Algorithm Configuration Options
 			// rst: ----------------------------------------------------------------------
@@ -684,16 +985,28 @@ int common_main(int argc, char **argv, Options &options, po::options_description
 			"The algorithm for exploring the search tree.\n"
 			// rst:		- ``dfs``: depth-first traversal.
 			" 'dfs': depth-first traversal.\n"
+			// rst:		- ``dfs-trail``: depth-first traversal, with a single partition shared by the current path and backtracking by undoing changes.
+			" 'dfs-trail': depth-first traversal, with a single partition shared by the current path.\n"
 			// rst:		- ``bfs-exp`` (default): breadth-first traversal with 1 experimental path per tree vertex.
 			" 'bfs-exp': breadth-first traversal with 1 experimental path per tree vertex.\n"
 			// rst:		- ``bfs-exp-m``: breadth-first traversal with 1 experimental path per tree vertex, limited by memory specified by :option:`-m`.
-			" 'bfs-exp-m': breadth-first traversal with 1 experimental path per tree vertex, limited by memory specified by -m.")
+			" 'bfs-exp-m': breadth-first traversal with 1 experimental path per tree vertex, limited by memory specified by -m.\n"
+			// rst:		- ``parallel``: depth-first traversal, with the subtrees of the root divided between the threads specified by :option:`-j`,
+			// rst:		  giving the same permutation as ``dfs``.
+			" 'parallel': depth-first traversal, with the subtrees of the root divided between the threads specified by -j, giving the same permutation as 'dfs'.")
 			// rst: .. option:: -m <MB>, --memory <MB>
 			// rst:
 			// rst:		Memory limit (in MB) before the tree traversal ``bfs-exp-m`` switches to DFS mode.
+			// rst:		The memory is the search tree and the data of the plugins, as counted in the ``memory_peak`` statistic.
 			// rst:		Default is 4 GB.
 			("m,memory", po::value<std::size_t>(&options.max_mem)->default_value(4 * 1024),
-			"Memory limit (MB) before the tree traversal bfs-exp-m switches to DFS mode.");
+			"Memory limit (MB) before the tree traversal bfs-exp-m switches to DFS mode.")
+			// rst: .. option:: -j <n>, --threads <n>
+			// rst:
+			// rst:		The total number of threads used by the tree traversal ``parallel``.
+			// rst:		Default is 1.
+			("j,threads", po::value<std::size_t>(&options.num_threads)->default_value(1),
+			"The total number of threads used by the tree traversal parallel.");
 	optionDesc.add(generalOptionDesc).add(modeOptionsDesc);
 
 	po::positional_options_description positionalDesc; // for disallowing extra arguments
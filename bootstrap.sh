@@ -18,6 +18,10 @@ function gen_file_lists {
 	find test -iname "*.cpp" | grep -v cmake | sed "s/^test\/\(.*\)\.cpp$/\1/" | indent
 	echo ")"
 	echo ""
+	echo "set(graph_canon_BENCHMARK_FILES"
+	find benchmark -iname "*.cpp" | sed "s/^benchmark\/\(.*\)\.cpp$/\1/" | indent
+	echo ")"
+	echo ""
 	echo "set(graph_canon_EXAMPLE_FILES"
 	find examples -iname "*.cpp" | sed "s/^examples\/\(.*\)\.cpp$/\1/" | indent
 	echo ")"
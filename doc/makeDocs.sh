@@ -227,6 +227,8 @@ Executables
 	dimacs
 	graph_canon
 	graph_canon_run
+	graph_canon_bench
+	graph_canon_compare
 	graph_canon_dreadnaut
 	graph_canon_bliss
 	download_graph_collections
@@ -241,6 +243,8 @@ EOF
 	) | outputRST executables/graph_canon
 	cat $topSrcDir/bin/download-graph-collections | filterPy | outputRST executables/download_graph_collections
 	cat $topSrcDir/bin/graph-canon-run | filterPy | outputRST executables/graph_canon_run
+	cat $topSrcDir/bin/graph-canon-bench | filterPy | outputRST executables/graph_canon_bench
+	cat $topSrcDir/bin/graph-canon-compare | filterPy | outputRST executables/graph_canon_compare
 	cat $topSrcDir/bin/graph-canon-dreadnaut | filterPy | outputRST executables/graph_canon_dreadnaut
 	cat $topSrcDir/bin/graph-canon-bliss | filterPy | outputRST executables/graph_canon_bliss
 }
@@ -2,6 +2,7 @@
 #define GRAPH_CANON_AUT_IMPLICIT_SIZE_2_HPP
 
 #include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 #include <perm_group/permutation/interface.hpp>
 
@@ -69,6 +70,12 @@ struct aut_implicit_size_2 : null_visitor {
 			perm_group::put(instance.aut, i, i);
 	}
 
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.aut);
+	}
+
 	template<typename State, typename TreeNode>
 	bool tree_create_node_begin(State &state, TreeNode &t) {
 		auto &t_data = get(tree_data_t(), t.data);
@@ -78,7 +85,7 @@ struct aut_implicit_size_2 : null_visitor {
 		t_data.fits = t_parent_data.fits;
 		if(!t_data.fits) return true;
 		const std::size_t parentTargetCell = parent->get_child_refiner_cell();
-		assert(parent->pi.get_cell_end(parentTargetCell) == parentTargetCell + 2);
+		assert(parent->children.size() == 2);
 		assert(t.pi.get_cell_end(parentTargetCell) == parentTargetCell + 1);
 		const std::size_t first = t.pi.get(parentTargetCell);
 		const std::size_t second = t.pi.get(parentTargetCell + 1);
@@ -100,7 +107,7 @@ struct aut_implicit_size_2 : null_visitor {
 		assert(new_cell > 0);
 		const std::size_t parentCell = new_cell - 1;
 		(void) parentCell;
-		assert(t.get_parent()->pi.get_cell_end(parentCell) == parentCell + 2);
+		// the cell had size 2 in the parent, but the parent partition may be shared with us (see traversal_dfs_trail)
 		assert(t.pi.get_cell_end(parentCell) == parentCell + 1);
 		assert(t.pi.get_cell_end(new_cell) == new_cell + 1);
 		const std::size_t first = t.pi.get(new_cell - 1);
@@ -150,10 +157,8 @@ struct aut_implicit_size_2 : null_visitor {
 		// we may have gotten it from the parent
 		if(!t_data.fits && t.pi.get_num_cells() < state.n) {
 			t_data.fits = true;
-			std::size_t cell_end = 0; // init for the compiler to shut up
-			for(std::size_t cell = 0; cell < state.n; cell = cell_end) {
-				cell_end = t.pi.get_cell_end(cell);
-				if(cell_end - cell > 2) {
+			for(std::size_t cell = t.pi.get_first_non_singleton(); cell != state.n; cell = t.pi.get_next_non_singleton(cell)) {
+				if(t.pi.get_cell_size(cell) > 2) {
 					t_data.fits = false;
 					break;
 				}
@@ -2,6 +2,7 @@
 #define GRAPH_CANON_AUT_PRUNER_BASE_HPP
 
 #include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 #include <cassert>
 #include <vector>
@@ -82,6 +83,8 @@ struct aut_pruner_base : null_visitor {
 	struct instance_data {
 		// buffers needed for checking
 		std::vector<TreeNode*> t_path, c_path;
+		// maps elements of the target cell of a node to child indices
+		std::vector<typename Config::SizeType> child_idx_from_v_idx;
 	};
 
 	template<typename Config, typename TreeNode>
@@ -122,6 +125,18 @@ public:
 		auto &c_path = i_data.c_path;
 		t_path.reserve(state.n);
 		c_path.reserve(state.n);
+		i_data.child_idx_from_v_idx.resize(state.n);
+	}
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.t_path) + detail::heap_bytes(i_data.c_path) + detail::heap_bytes(i_data.child_idx_from_v_idx);
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &state, const TreeNode &t) {
+		return detail::heap_bytes(get(tree_data_t(), t.data).parent);
 	}
 
 	template<typename State, typename TreeNode>
@@ -250,7 +265,11 @@ public:
 				for(int i = 0; i < parent.size(); ++i)
 					parent[i] = i;
 				t_data.num_roots = parent.size() - 1;
+				// the stabilizer and the disjoint set have grown
+				state.update_memory(*a_t);
 			} else {
+				// the stabilizer may have grown
+				state.update_memory(*a_t);
 				if(t_data.num_roots == 0)
 					continue;
 			}
@@ -264,11 +283,9 @@ public:
 				} else {
 					// Still have to be careful about pruning.
 					assert(c_path.size() > 1); // we can not be a leaf
-					const auto canon_child_v_idx = c_path[c_path.size() - 2]->pi.get(c_path.back()->get_child_individualized_position());
-					const auto canon_child_idx = c_path.back()->pi.get_inverse(canon_child_v_idx);
-					const auto canon_child_local_idx = canon_child_idx - c_path.back()->get_child_refiner_cell();
+					const auto canon_child_local_idx = c_path[c_path.size() - 2]->get_child_offset();
 #ifdef GRAPH_CANON_AUT_BASE_DEBUG
-					std::cout << "Aut: canon_child: v=" << canon_child_v_idx << ", idx=" << canon_child_idx << ", local_idx=" << canon_child_local_idx << std::endl;
+					std::cout << "Aut: canon_child: local_idx=" << canon_child_local_idx << std::endl;
 #endif
 					return canon_child_local_idx;
 				}
@@ -284,9 +301,11 @@ public:
 				}
 			};
 
-			const auto cell_begin = a_t->get_child_refiner_cell();
-			const SizeType * const pi_begin = a_t->pi.begin();
-			const SizeType * const pi_inv_begin = a_t->pi.begin_inverse();
+			// Use the child elements instead of the partition of a_t,
+			// as it may be shared with the current node (see traversal_dfs_trail).
+			auto &child_idx_from_v_idx = i_data.child_idx_from_v_idx;
+			for(SizeType idx_local = 0; idx_local != num_children; ++idx_local)
+				child_idx_from_v_idx[a_t->get_child_element(idx_local)] = idx_local;
 			for(auto iter = new_auts.begin(); iter != new_auts.end(); ++iter) {
 				const auto &aut = *iter;
 #ifdef GRAPH_CANON_AUT_BASE_DEBUG
@@ -298,17 +317,16 @@ public:
 					std::cout << " " << idx_local;
 				std::cout << std::endl << "Aut:";
 				for(SizeType idx_local = 0; idx_local < a_t->children.size(); ++idx_local)
-					std::cout << " " << a_t->pi.get(idx_local + a_t->get_child_refiner_cell());
+					std::cout << " " << a_t->get_child_element(idx_local);
 				std::cout << std::endl << "Aut:";
 				for(SizeType idx_local = 0; idx_local < a_t->children.size(); ++idx_local)
 					std::cout << " " << parent[idx_local];
 				std::cout << std::endl;
 #endif
 				const auto per_point = [&](const auto idx_local, const auto v_idx, const auto v_image_idx) {
-					const auto image_idx = pi_inv_begin[v_image_idx];
-					assert(image_idx >= cell_begin);
-					assert(image_idx < a_t->pi.get_cell_end(cell_begin));
-					const auto image_idx_local = image_idx - cell_begin;
+					const auto image_idx_local = child_idx_from_v_idx[v_image_idx];
+					assert(image_idx_local < num_children);
+					assert(a_t->get_child_element(image_idx_local) == v_image_idx);
 					const auto root = find_root(idx_local);
 					const auto root_image = find_root(image_idx_local);
 					if(root == root_image) return;
@@ -352,8 +370,7 @@ public:
 				//					}
 				//				} else {
 				for(SizeType idx_local = 0; idx_local != num_children; ++idx_local) {
-					const auto idx = idx_local + cell_begin;
-					const auto v_idx = pi_begin[idx];
+					const auto v_idx = a_t->get_child_element(idx_local);
 					const auto v_image_idx = perm_group::get(aut, v_idx);
 					if(v_idx == v_image_idx) continue;
 					per_point(idx_local, v_idx, v_image_idx);
@@ -371,7 +388,7 @@ public:
 				std::cout << " " << idx_local;
 			std::cout << std::endl << "Aut:";
 			for(SizeType idx_local = 0; idx_local < a_t->children.size(); ++idx_local)
-				std::cout << " " << a_t->pi.get(idx_local + a_t->get_child_refiner_cell());
+				std::cout << " " << a_t->get_child_element(idx_local);
 			std::cout << std::endl << "Aut:";
 			for(SizeType idx_local = 0; idx_local < a_t->children.size(); ++idx_local)
 				std::cout << " " << parent[idx_local];
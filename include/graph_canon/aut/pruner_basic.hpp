@@ -107,6 +107,24 @@ public:
 		auto &i_data = get(instance_data_t(), s.data);
 		return tagged_element<result_t, Result>{std::move(i_data.g)};
 	}
+
+	// The groups are stored by PermGroup, so estimate them by their generators.
+
+	template<typename State>
+	std::size_t memory_instance(const State &s) {
+		using SizeType = typename State::SizeType;
+		const auto &i_data = get(instance_data_t(), s.data);
+		const std::size_t num_gens = i_data.g ? i_data.g->generators().size() : 0;
+		return Base::memory_instance(s) + detail::perm_bytes<SizeType>(num_gens, s.n);
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &s, const TreeNode &t) {
+		using SizeType = typename State::SizeType;
+		const auto &t_data = get(tree_data_t(), t.data);
+		const std::size_t num_gens = t_data.stab ? t_data.stab->generators().size() : 0;
+		return Base::memory_tree_node(s, t) + detail::perm_bytes<SizeType>(num_gens, s.n);
+	}
 public: // for aut_pruner_base
 
 	template<typename State, typename TreeNode, typename AutPerm>
@@ -136,7 +154,7 @@ public: // for aut_pruner_base
 		auto &t_data = get(tree_data_t(), t.data);
 		if(const auto *t_parent = t.get_parent()) { // not the root
 			if(!t_data.stab) {
-				const auto new_v_idx_to_fix = t.pi.get(t.get_parent()->get_child_individualized_position());
+				const auto new_v_idx_to_fix = t_parent->get_child_element(t.get_child_offset());
 				t_data.stab.reset(new Stab<SizeType>(new_v_idx_to_fix, i_data.g->get_allocator()));
 			}
 			const auto handle_group = [&](const auto &g) {
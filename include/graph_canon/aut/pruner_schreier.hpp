@@ -517,6 +517,24 @@ public:
 		return tagged_element<result_t, Result>{std::move(r)};
 	}
 
+	// Estimated as the generators of the groups, the transversals of the stabilizers are not counted.
+
+	template<typename State>
+	std::size_t memory_instance(const State &s) {
+		using SizeType = typename State::SizeType;
+		const auto &i_data = get(instance_data_t(), s.data);
+		const std::size_t num_gens = i_data.g ? i_data.g->generators().size() : 0;
+		return Base::memory_instance(s) + detail::perm_bytes<SizeType>(num_gens, s.n);
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &s, const TreeNode &t) {
+		using SizeType = typename State::SizeType;
+		const auto &t_data = get(tree_data_t(), t.data);
+		const std::size_t num_gens = t_data.stab ? t_data.stab->generators().size() : 0;
+		return Base::memory_tree_node(s, t) + detail::perm_bytes<SizeType>(num_gens, s.n);
+	}
+
 	template<typename State, typename TreeNode>
 	void canon_new_best(State &state, TreeNode *previous) {
 		Base::canon_new_best(state, previous);
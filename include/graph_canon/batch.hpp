@@ -0,0 +1,121 @@
+#ifndef GRAPH_CANON_BATCH_HPP
+#define GRAPH_CANON_BATCH_HPP
+
+#include <graph_canon/canonicalization.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: .. function:: template<typename SizeType, bool ParallelEdges, bool Loops, typename NodeAllocatorT = node_allocator_new, \
+// rst:               typename Range, typename EdgeHandlerCreatorT, typename Canonicalize, typename Callback> \
+// rst:               void canonicalize_batch(const Range &graphs, EdgeHandlerCreatorT edge_handler_creator, \
+// rst:                                       Canonicalize canon, Callback callback, \
+// rst:                                       std::size_t num_threads = std::thread::hardware_concurrency())
+// rst:
+// rst:		Canonicalize each graph in a random-access range, distributing the graphs dynamically to `num_threads` worker threads.
+// rst:		Each worker owns a single `canonicalizer<SizeType, EdgeHandlerCreatorT, ParallelEdges, Loops, NodeAllocatorT>`,
+// rst:		and thereby a single edge handler, which is reused for all the graphs it canonicalizes.
+// rst:
+// rst:		For each graph `g` with index `i` in the range, a worker computes `r = canon(c, g)`, where `c` is its canonicalizer.
+// rst:		`canon` should call `c(g, idx, vertex_less, visitor)` and extract the needed data from the result,
+// rst:		e.g., the permutation and the certificate from `certificate_visitor`.
+// rst:		The calling thread then calls `callback(i, std::move(r))` in the order of the input,
+// rst:		so `callback` does not need to be thread-safe, while `canon` is called concurrently.
+// rst:		At most a few results per worker are kept waiting for an earlier graph to finish.
+// rst:		With at most 1 thread, all graphs are handled in the calling thread.
+// rst:
+// rst:		If `canon` or `callback` throws an exception, no further graphs are started,
+// rst:		and the first exception is rethrown after all workers have stopped.
+
+template<typename SizeType, bool ParallelEdges, bool Loops, typename NodeAllocatorT = node_allocator_new,
+		typename Range, typename EdgeHandlerCreatorT, typename Canonicalize, typename Callback>
+void canonicalize_batch(const Range &graphs, EdgeHandlerCreatorT edge_handler_creator,
+		Canonicalize canon, Callback callback,
+		std::size_t num_threads = std::thread::hardware_concurrency()) {
+	using Canonicalizer = canonicalizer<SizeType, EdgeHandlerCreatorT, ParallelEdges, Loops, NodeAllocatorT>;
+	using Result = std::decay_t<decltype(canon(std::declval<Canonicalizer&>(), *std::begin(graphs)))>;
+	const std::size_t num_graphs = std::size(graphs);
+	const auto first = std::begin(graphs);
+	if(num_threads <= 1 || num_graphs <= 1) {
+		Canonicalizer c(edge_handler_creator);
+		for(std::size_t i = 0; i != num_graphs; ++i)
+			callback(i, canon(c, first[i]));
+		return;
+	}
+	// result i is stored in slot i % window until it is delivered
+	const std::size_t window = 4 * num_threads;
+	std::vector<std::optional<Result> > slots(window);
+	std::size_t next_claim = 0, next_deliver = 0;
+	bool stop = false;
+	std::exception_ptr error;
+	std::mutex m;
+	std::condition_variable cv_ready, cv_space;
+	const auto fail = [&]() {
+		std::lock_guard<std::mutex> lock(m);
+		if(!error) error = std::current_exception();
+		stop = true;
+		cv_ready.notify_all();
+		cv_space.notify_all();
+	};
+	const auto work = [&]() {
+		try {
+			Canonicalizer c(edge_handler_creator);
+			while(true) {
+				std::size_t i;
+				{
+					std::unique_lock<std::mutex> lock(m);
+					cv_space.wait(lock, [&]() {
+						return stop || next_claim == num_graphs || next_claim < next_deliver + window;
+					});
+					if(stop || next_claim == num_graphs) return;
+					i = next_claim++;
+				}
+				Result r = canon(c, first[i]);
+				std::lock_guard<std::mutex> lock(m);
+				slots[i % window].emplace(std::move(r));
+				cv_ready.notify_all();
+			}
+		} catch(...) {
+			fail();
+		}
+	};
+	std::vector<std::thread> workers;
+	try {
+		for(std::size_t t = 0; t != num_threads; ++t)
+			workers.emplace_back(work);
+		while(true) {
+			std::optional<Result> r;
+			std::size_t i;
+			{
+				std::unique_lock<std::mutex> lock(m);
+				cv_ready.wait(lock, [&]() {
+					return stop || next_deliver == num_graphs || slots[next_deliver % window];
+				});
+				if(stop || next_deliver == num_graphs) break;
+				i = next_deliver++;
+				r = std::move(slots[i % window]);
+				slots[i % window].reset();
+				cv_space.notify_all();
+			}
+			callback(i, std::move(*r));
+		}
+	} catch(...) {
+		fail();
+	}
+	for(auto &w : workers) w.join();
+	if(error) std::rethrow_exception(error);
+}
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_BATCH_HPP */
@@ -0,0 +1,223 @@
+#ifndef GRAPH_CANON_CANONICAL_GRAPH_SET_HPP
+#define GRAPH_CANON_CANONICAL_GRAPH_SET_HPP
+
+#include <graph_canon/detail/canonical_form.hpp>
+#include <graph_canon/detail/permuted_graph_view.hpp> // mix64
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: .. class:: template<typename SizeType> canonical_graph_set
+// rst:
+// rst:		A set of undirected graphs up to isomorphism, e.g., for removing isomorphic duplicates from a collection of graphs.
+// rst:		A graph is given together with its canonical permutation, as returned by a `canonicalizer`,
+// rst:		and its canonical form is stored in a flat array: the number of vertices :math:`n`,
+// rst:		the number of edges :math:`m`, and then for each vertex in canonical order,
+// rst:		the number of neighbours with a canonical index not lower than its own, followed by those indices in ascending order.
+// rst:		Each edge is thus stored once, and a graph takes :math:`2 + n + m` words of `SizeType`
+// rst:		plus a table entry of two 64-bit words.
+// rst:
+// rst:		The canonical forms are keyed by a 64-bit hash of the array,
+// rst:		and two forms are only compared element by element when their hashes are equal.
+// rst:		The table is divided into stripes selected by the hash,
+// rst:		each an open-addressing hash table with linear probing, guarded by its own lock,
+// rst:		so many threads, e.g., the workers of `canonicalize_batch`, can insert graphs concurrently.
+// rst:		A canonical form is computed before the lock of its stripe is taken.
+// rst:
+// rst:		Only the structure is stored, so graphs that differ only in their vertex or edge labels are considered equal.
+// rst:		Use a separate set for each combination of labels, if needed.
+// rst:
+
+template<typename SizeType>
+class canonical_graph_set {
+	struct slot {
+		std::uint64_t hash;
+		std::size_t offset; // into the words of the stripe, or empty_offset
+	};
+
+	static constexpr std::size_t empty_offset = std::numeric_limits<std::size_t>::max();
+	static constexpr std::size_t min_num_slots = 16;
+
+	struct stripe {
+		mutable std::mutex m;
+		std::vector<slot> slots;
+		std::vector<SizeType> words;
+		std::size_t size = 0;
+	};
+public:
+	// rst:		.. function:: explicit canonical_graph_set(std::size_t num_stripes = 64)
+	// rst:
+	// rst:			:param num_stripes: the number of independently locked tables, rounded up to a power of 2.
+
+	explicit canonical_graph_set(std::size_t num_stripes = 64) {
+		stripe_bits = 0;
+		while((std::size_t(1) << stripe_bits) < num_stripes) ++stripe_bits;
+		stripes.reset(new stripe[std::size_t(1) << stripe_bits]);
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename Perm> \
+	// rst:		              bool insert(const Graph &g, IndexMap idx, const Perm &canon_perm)
+	// rst:
+	// rst:			Insert the graph `g`, where `canon_perm[get(idx, v)]` is the canonical index of the vertex `v`.
+	// rst:			This function is thread-safe.
+	// rst:
+	// rst:			:returns: `true` if no isomorphic graph was in the set before.
+
+	template<typename Graph, typename IndexMap, typename Perm>
+	bool insert(const Graph &g, IndexMap idx, const Perm &canon_perm) {
+		std::vector<SizeType> form;
+		encode(g, idx, canon_perm, form);
+		return insert_form(form);
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename Perm> \
+	// rst:		              bool contains(const Graph &g, IndexMap idx, const Perm &canon_perm) const
+	// rst:
+	// rst:			This function is thread-safe.
+	// rst:
+	// rst:			:returns: `true` if a graph isomorphic to `g` is in the set.
+
+	template<typename Graph, typename IndexMap, typename Perm>
+	bool contains(const Graph &g, IndexMap idx, const Perm &canon_perm) const {
+		std::vector<SizeType> form;
+		encode(g, idx, canon_perm, form);
+		return contains_form(form);
+	}
+
+	// rst:		.. function:: bool insert_form(const std::vector<SizeType> &form)
+	// rst:		              bool contains_form(const std::vector<SizeType> &form) const
+	// rst:
+	// rst:			Versions of `insert` and `contains` taking a canonical form computed by `encode`.
+
+	bool insert_form(const std::vector<SizeType> &form) {
+		const auto hash = hash_form(form);
+		stripe &s = get_stripe(hash);
+		std::lock_guard<std::mutex> lock(s.m);
+		if(s.slots.empty()) s.slots.assign(min_num_slots, slot{0, empty_offset});
+		std::size_t i = find(s, hash, form);
+		if(s.slots[i].offset != empty_offset) return false;
+		if(2 * (s.size + 1) > s.slots.size()) {
+			grow(s);
+			i = find(s, hash, form);
+		}
+		s.slots[i] = slot{hash, s.words.size()};
+		s.words.insert(s.words.end(), form.begin(), form.end());
+		++s.size;
+		return true;
+	}
+
+	bool contains_form(const std::vector<SizeType> &form) const {
+		const auto hash = hash_form(form);
+		const stripe &s = get_stripe(hash);
+		std::lock_guard<std::mutex> lock(s.m);
+		if(s.slots.empty()) return false;
+		return s.slots[find(s, hash, form)].offset != empty_offset;
+	}
+
+	// rst:		.. function:: std::size_t size() const
+	// rst:
+	// rst:			:returns: the number of graphs in the set.
+
+	std::size_t size() const {
+		std::size_t res = 0;
+		for(std::size_t i = 0; i != num_stripes(); ++i) {
+			std::lock_guard<std::mutex> lock(stripes[i].m);
+			res += stripes[i].size;
+		}
+		return res;
+	}
+
+	// rst:		.. function:: std::size_t memory_usage() const
+	// rst:
+	// rst:			:returns: the number of bytes allocated for the canonical forms and the tables.
+
+	std::size_t memory_usage() const {
+		std::size_t res = 0;
+		for(std::size_t i = 0; i != num_stripes(); ++i) {
+			std::lock_guard<std::mutex> lock(stripes[i].m);
+			res += stripes[i].words.capacity() * sizeof(SizeType) + stripes[i].slots.capacity() * sizeof(slot);
+		}
+		return res;
+	}
+
+	// rst:		.. function:: void shrink_to_fit()
+	// rst:
+	// rst:			Release the unused capacity of the arrays holding the canonical forms.
+
+	void shrink_to_fit() {
+		for(std::size_t i = 0; i != num_stripes(); ++i) {
+			std::lock_guard<std::mutex> lock(stripes[i].m);
+			stripes[i].words.shrink_to_fit();
+		}
+	}
+public:
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename Perm> \
+	// rst:		              static void encode(const Graph &g, IndexMap idx, const Perm &canon_perm, std::vector<SizeType> &form)
+	// rst:
+	// rst:			Store the canonical form of `g` in `form`, in the format described above.
+	// rst:			Requires `Graph` to be a `VertexListGraph` and an `EdgeListGraph`, and to be undirected.
+
+	template<typename Graph, typename IndexMap, typename Perm>
+	static void encode(const Graph &g, IndexMap idx, const Perm &canon_perm, std::vector<SizeType> &form) {
+		detail::encode_canonical_form(g, idx, canon_perm, form);
+	}
+private:
+
+	static std::uint64_t hash_form(const std::vector<SizeType> &form) {
+		std::uint64_t hash = detail::mix64(form.size());
+		for(const SizeType w : form)
+			hash = detail::mix64(hash + w + 0x9e3779b97f4a7c15ull);
+		return hash;
+	}
+
+	std::size_t num_stripes() const {
+		return std::size_t(1) << stripe_bits;
+	}
+
+	stripe &get_stripe(const std::uint64_t hash) {
+		return stripes[stripe_bits == 0 ? 0 : hash >> (64 - stripe_bits)];
+	}
+
+	const stripe &get_stripe(const std::uint64_t hash) const {
+		return stripes[stripe_bits == 0 ? 0 : hash >> (64 - stripe_bits)];
+	}
+
+	// the slot with the given form, or the empty slot where it should be inserted
+	static std::size_t find(const stripe &s, const std::uint64_t hash, const std::vector<SizeType> &form) {
+		const std::size_t mask = s.slots.size() - 1;
+		for(std::size_t i = hash & mask;; i = (i + 1) & mask) {
+			const slot &e = s.slots[i];
+			if(e.offset == empty_offset) return i;
+			if(e.hash != hash) continue;
+			// equal hashes, so compare the forms, which start with n and m and therefore have equal lengths if equal
+			const SizeType *stored = s.words.data() + e.offset;
+			if(stored[0] != form[0] || stored[1] != form[1]) continue;
+			if(detail::compare_flat(stored, form.data(), form.size()) == 0) return i;
+		}
+	}
+
+	static void grow(stripe &s) {
+		std::vector<slot> old(2 * s.slots.size(), slot{0, empty_offset});
+		old.swap(s.slots);
+		const std::size_t mask = s.slots.size() - 1;
+		for(const slot &e : old) {
+			if(e.offset == empty_offset) continue;
+			std::size_t i = e.hash & mask;
+			while(s.slots[i].offset != empty_offset) i = (i + 1) & mask;
+			s.slots[i] = e;
+		}
+	}
+private:
+	std::size_t stripe_bits;
+	std::unique_ptr<stripe[]> stripes;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_CANONICAL_GRAPH_SET_HPP */
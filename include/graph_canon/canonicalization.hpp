@@ -1,6 +1,8 @@
 #ifndef GRAPH_CANON_CANONICALIZATION_HPP
 #define GRAPH_CANON_CANONICALIZATION_HPP
 
+#include <graph_canon/node_allocator.hpp> // default
+#include <graph_canon/resource_limits.hpp>
 #include <graph_canon/tagged_list.hpp>
 #include <graph_canon/util.hpp>
 #include <graph_canon/edge_handler/all_equal.hpp> // default
@@ -23,7 +25,15 @@
 #include <boost/static_assert.hpp>
 #include <boost/type_traits.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <utility>
 #include <vector>
 
 namespace graph_canon {
@@ -31,7 +41,7 @@ namespace graph_canon {
 // rst: .. class:: template< \
 // rst:            typename SizeTypeT, bool ParallelEdgesV, bool LoopsV, \
 // rst:            typename GraphT, typename IndexMapT, \
-// rst:            typename EdgeHandlerT> \
+// rst:            typename EdgeHandlerT, typename NodeAllocatorT = node_allocator_new> \
 // rst:            config
 // rst:
 // rst:		A helper-class for holding type aliases.
@@ -40,7 +50,7 @@ namespace graph_canon {
 template<
 		typename SizeTypeT, bool ParallelEdgesV, bool LoopsV,
 		typename GraphT, typename IndexMapT,
-		typename EdgeHandlerT
+		typename EdgeHandlerT, typename NodeAllocatorT = node_allocator_new
 >
 struct config {
 	// rst:		.. type:: SizeType = SizeTypeT
@@ -67,6 +77,10 @@ struct config {
 	// rst:
 	// rst:			The type of :concept:`EdgeHandler <graph_canon::EdgeHandler>` used.
 	using EdgeHandler = EdgeHandlerT;
+	// rst:		.. type:: NodeAllocator = NodeAllocatorT
+	// rst:
+	// rst:			The type of :concept:`NodeAllocator <graph_canon::NodeAllocator>` used for the search tree nodes.
+	using NodeAllocator = NodeAllocatorT;
 public:
 	// rst:		.. type:: Partition = detail::partition<SizeType>
 	// rst:
@@ -121,6 +135,68 @@ struct TreeNodeDataGenerator {
 
 } // namespace detail
 
+// rst: .. class:: template<typename NodeAllocatorT> \
+// rst:            canon_workspace
+// rst:
+// rst:		The memory a `canonicalizer` keeps between its runs:
+// rst:		a single `NodeAllocator`, and the instance data of each type of `canon_state` it has created.
+// rst:		A run takes the instance data out of the workspace and gives it back when it completes,
+// rst:		so the buffers of the visitors only grow and are reset logically by `Visitor::initialize`.
+// rst:		The instance data of a run that is aborted by an exception is destroyed instead.
+// rst:		A workspace can only be used by a single run at a time.
+// rst:
+
+template<typename NodeAllocatorT>
+class canon_workspace {
+	canon_workspace(const canon_workspace &) = delete;
+	canon_workspace &operator=(const canon_workspace &) = delete;
+public:
+	canon_workspace() = default;
+	canon_workspace(canon_workspace &&) = default;
+	canon_workspace &operator=(canon_workspace &&) = default;
+
+	// rst:		.. function:: NodeAllocatorT &get_node_allocator()
+
+	NodeAllocatorT &get_node_allocator() {
+		if(!node_allocator) node_allocator = std::make_unique<NodeAllocatorT>();
+		return *node_allocator;
+	}
+
+	// rst:		.. function:: template<typename InstanceData> \
+	// rst:		              std::shared_ptr<InstanceData> take_instance_data()
+	// rst:
+	// rst:			:returns: the instance data given back by a previous run, or a new default constructed object.
+
+	template<typename InstanceData>
+	std::shared_ptr<InstanceData> take_instance_data() {
+		const auto iter = instance_data.find(typeid (InstanceData));
+		if(iter == instance_data.end()) return std::make_shared<InstanceData>();
+		auto data = std::static_pointer_cast<InstanceData>(std::move(iter->second));
+		instance_data.erase(iter);
+		return data;
+	}
+
+	// rst:		.. function:: template<typename InstanceData> \
+	// rst:		              void give_back_instance_data(std::shared_ptr<InstanceData> data)
+
+	template<typename InstanceData>
+	void give_back_instance_data(std::shared_ptr<InstanceData> data) {
+		instance_data[typeid (InstanceData)] = std::move(data);
+	}
+
+	// rst:		.. function:: void clear()
+	// rst:
+	// rst:			Release all memory kept for later runs.
+
+	void clear() {
+		node_allocator = nullptr;
+		instance_data.clear();
+	}
+private:
+	std::unique_ptr<NodeAllocatorT> node_allocator;
+	std::map<std::type_index, std::shared_ptr<void> > instance_data;
+};
+
 // rst: .. class:: template<typename ConfigT, typename VisitorT> \
 // rst:            canon_state
 // rst:
@@ -159,6 +235,10 @@ public:
 	// rst:
 	// rst:			The `EdgeHandler` type used.
 	using EHandler = typename Config::EdgeHandler;
+	// rst:		.. type:: NodeAlloc
+	// rst:
+	// rst:			The `NodeAllocator` type used.
+	using NodeAlloc = typename Config::NodeAllocator;
 	// rst:		.. var:: static constexpr bool ParallelEdges
 	// rst:
 	// rst:			Configuration value for whether the given graph may have parallel edges or not.
@@ -202,9 +282,11 @@ private:
 		const auto less = [this, &vertex_less](const auto u_idx, const auto v_idx) {
 			return vertex_less(vertex(u_idx, g), vertex(v_idx, g));
 		};
-		SizeType refinee_end_idx; // = 0; // init to shut up compiler
-		for(SizeType refinee_begin_idx = 0; refinee_begin_idx < n; refinee_begin_idx = refinee_end_idx) {
-			refinee_end_idx = pi.get_cell_end(refinee_begin_idx);
+		// singletons can not be split, and the next non-singleton cell is not affected by splitting the current one
+		SizeType next_refinee_begin_idx; // = 0; // init to shut up compiler
+		for(SizeType refinee_begin_idx = pi.get_first_non_singleton(); refinee_begin_idx != n; refinee_begin_idx = next_refinee_begin_idx) {
+			next_refinee_begin_idx = pi.get_next_non_singleton(refinee_begin_idx);
+			const SizeType refinee_end_idx = pi.get_cell_end(refinee_begin_idx);
 			std::sort(pi.begin() + refinee_begin_idx, pi.begin() + refinee_end_idx, less);
 			auto raii_splitter = pi.split_cell(refinee_begin_idx);
 			for(SizeType i = refinee_begin_idx + 1; i < refinee_end_idx; ++i)
@@ -225,7 +307,27 @@ public:
 					Vis visitor,
 					VertexLess vertex_less,
 					Partition &&pi)
-			: g(g), n(num_vertices(g)), idx(idx), edge_handler(edge_handler), visitor(std::move(visitor)) {
+			: canon_state(g, idx, edge_handler, std::move(visitor), vertex_less, std::move(pi), nullptr) { }
+
+	// the node allocator and the instance data are taken from the workspace, unless it is nullptr,
+	// and the limits are already in effect for the refinement of the root
+
+	template<typename VertexLess>
+	canon_state(const Graph &g,
+					IndexMap idx,
+					EHandler &edge_handler,
+					Vis visitor,
+					VertexLess vertex_less,
+					Partition &&pi,
+					canon_workspace<NodeAlloc> *workspace,
+					const resource_limits &limits = resource_limits())
+			: g(g), n(num_vertices(g)), idx(idx), workspace(workspace),
+			limits(limits), is_limited(!limits.is_unlimited()),
+			own_node_allocator(workspace ? nullptr : std::make_unique<NodeAlloc>()),
+			data_storage(workspace ? workspace->template take_instance_data<InstanceData>() : std::make_shared<InstanceData>()),
+			node_allocator(workspace ? workspace->get_node_allocator() : *own_node_allocator), data(*data_storage),
+			edge_handler(edge_handler), visitor(std::move(visitor)) {
+		node_allocator.reset(); // all blocks of a previous run have been returned
 		this->edge_handler.initialize(*this);
 		this->visitor.initialize(*this);
 		// first let the user determine the order
@@ -236,7 +338,8 @@ public:
 		};
 		splitByPredicate(vertex_degree_less, pi);
 		root = TreeNode::make(std::move(pi), *this);
-		assert(!root->get_is_pruned());
+		// the refinement of the root may have been stopped
+		assert(!root->get_is_pruned() || is_stopped());
 	}
 
 	~canon_state() {
@@ -247,6 +350,9 @@ public:
 		canon_leaf = nullptr; // may deallocate a path in the tree
 		assert(std::uncaught_exceptions() != 0 || root->get_ref_count() == 1);
 		root = nullptr;
+		// after an exception the instance data may not be in a state that initialize can recover from
+		if(workspace && std::uncaught_exceptions() == 0)
+			workspace->give_back_instance_data(std::move(data_storage));
 	}
 
 	//private:
@@ -279,9 +385,11 @@ public:
 	// rst:			Requires that the ordered partition represented by `node` is discrete,
 	// rst:			and that `report_leaf` has not been called before with this node.
 	// rst:
+	// rst:			If `resource_limits::max_leaves` leaves have already been reported, the run is stopped instead, without calling any visitor method.
+	// rst:
 	// rst:			Several `Visitor` methods may be called from this function:
 	// rst:
-	// rst:			- `Visitor::tree_leaf`, always called.
+	// rst:			- `Visitor::tree_leaf`, always called, unless the run is stopped.
 	// rst:			- `Visitor::canon_new_best`, if this node will be the best candidate leaf afterwards.
 	// rst:			- `Visitor::automorphism_leaf`, if this node represents a canonical representation,
 	// rst:			  equal to the current best candidate.
@@ -290,30 +398,43 @@ public:
 	void report_leaf(OwnerPtr node) {
 		assert(node != canon_leaf);
 		assert(node->pi.get_num_cells() == n);
+		// a leaf beyond the budget stops the run without being reported, so using up the budget exactly is still complete
+		if(num_leaves >= limits.max_leaves) {
+			if(status == canon_status::complete) status = canon_status::leaf_limit;
+			return;
+		}
+		++num_leaves;
 		visitor.tree_leaf(*this, *node);
+		const std::uint64_t certificate = detail::hash_permuted_graph(*this, node->pi);
 		if(!canon_leaf) { // canon_permuted_graph may still be valid if someone pruned our canon_leaf
 			canon_leaf = node;
+			canon_certificate = certificate;
 			visitor.canon_new_best(*this, static_cast<TreeNode *>(nullptr));
+			update_memory(*node);
 			return;
 		}
-		if(!canon_permuted_graph) { // this is our second leaf, so not even the first permuted graph were created
-			assert(!extra_permuted_graph);
-			canon_permuted_graph = new PermutedGraph(*this, canon_leaf);
-			extra_permuted_graph = new PermutedGraph(*this, node);
-		} else if(canon_permuted_graph->get_node() != canon_leaf) {
-			// at least two leaves were discovered, canon_leaf was pruned, at least two leaves were discovered
-			canon_permuted_graph->repermute(*this, canon_leaf);
-		}
-		if(extra_permuted_graph) {
-			extra_permuted_graph->repermute(*this, node);
+		// leaves are ordered first by their certificate, so the permuted graphs are only needed when they are equal
+		long long cmp;
+		if(certificate != canon_certificate) {
+			cmp = certificate < canon_certificate ? -1 : 1;
 		} else {
-			extra_permuted_graph = new PermutedGraph(*this, node);
+			if(!canon_permuted_graph) { // the permuted graphs were not needed before
+				assert(!extra_permuted_graph);
+				canon_permuted_graph = new PermutedGraph(*this, canon_leaf);
+				extra_permuted_graph = new PermutedGraph(*this, node);
+			} else if(canon_permuted_graph->get_node() != canon_leaf) {
+				// canon_leaf was pruned or replaced without comparing the permuted graphs
+				canon_permuted_graph->repermute(*this, canon_leaf);
+			}
+			if(extra_permuted_graph->get_node() != node)
+				extra_permuted_graph->repermute(*this, node);
+			cmp = PermutedGraph::compare(*this, *extra_permuted_graph, *canon_permuted_graph);
+			if(cmp < 0) std::swap(canon_permuted_graph, extra_permuted_graph);
 		}
-		auto cmp = PermutedGraph::compare(*this, *extra_permuted_graph, *canon_permuted_graph);
 		if(cmp < 0) {
-			std::swap(canon_permuted_graph, extra_permuted_graph);
 			OwnerPtr previous = canon_leaf;
 			canon_leaf = node;
+			canon_certificate = certificate;
 			visitor.canon_new_best(*this, previous.get());
 		} else if(cmp == 0) {
 			detail::explicit_automorphism<Self> aut(*this, *node);
@@ -321,6 +442,8 @@ public:
 		} else {
 			visitor.canon_worse(*this, *node);
 		}
+		// the leaf may have got its own partition, and the visitors may have stored the automorphism
+		update_memory(*node);
 	}
 
 	// rst:		.. function:: void prune_canon_leaf()
@@ -342,6 +465,190 @@ public:
 		return canon_leaf.get();
 	}
 
+	// rst:		.. function:: std::uint64_t get_canon_certificate() const
+	// rst:
+	// rst:			:returns: a hash of the graph permuted by the current best candidate.
+	// rst:
+	// rst:			After a complete run this is a hash of the canonical form of the graph,
+	// rst:			so isomorphic graphs have the same certificate, independently of how their vertices were numbered.
+	// rst:			Graphs with different certificates are not isomorphic,
+	// rst:			while equal certificates must be confirmed by comparing the canonical forms.
+	// rst:			Edge labels are not included in the hash.
+	// rst:			Leaves are ordered by their certificates before their permuted graphs are compared.
+
+	std::uint64_t get_canon_certificate() const {
+		return canon_certificate;
+	}
+
+	// rst:		.. function:: std::size_t get_memory_usage() const
+	// rst:
+	// rst:			:returns: the number of bytes currently used by this run.
+	// rst:
+	// rst:			This is the blocks of the living tree nodes with their arrays of children,
+	// rst:			the instance data with the permuted graphs used for comparing leaves,
+	// rst:			and the memory the visitors report through `Visitor::memory_instance` and `Visitor::memory_tree_node`.
+	// rst:			The overhead of the allocators, the input graph, and the returned data are not included.
+	// rst:			The amount is updated by `update_memory`, which is called after each tree node construction and after each leaf,
+	// rst:			so it may lag behind while visitors grow their data in between.
+
+	std::size_t get_memory_usage() const {
+		return nodes_bytes + instance_bytes;
+	}
+
+	// rst:		.. function:: std::size_t get_memory_peak() const
+	// rst:
+	// rst:			:returns: the maximum value of `get_memory_usage` so far.
+
+	std::size_t get_memory_peak() const {
+		return peak_bytes;
+	}
+
+	// rst:		.. function:: std::size_t get_memory_limit() const
+	// rst:
+	// rst:			:returns: the memory budget of the run in bytes, by default the maximum value of `std::size_t`.
+
+	std::size_t get_memory_limit() const {
+		return limit_bytes;
+	}
+
+	// rst:		.. function:: void limit_memory(std::size_t bytes)
+	// rst:
+	// rst:			Lower the memory budget to at most `bytes`.
+	// rst:			The budget is not enforced by the state itself, but consulted by tree traversals through `is_memory_exceeded`,
+	// rst:			e.g., `traversal_bfs_exp_m` falls back to depth-first traversal.
+
+	void limit_memory(std::size_t bytes) {
+		limit_bytes = std::min(limit_bytes, bytes);
+	}
+
+	// rst:		.. function:: bool is_memory_exceeded() const
+	// rst:
+	// rst:			:returns: `get_memory_usage() > get_memory_limit()`
+
+	bool is_memory_exceeded() const {
+		return get_memory_usage() > limit_bytes;
+	}
+
+	// rst:		.. function:: void update_memory(TreeNode &t)
+	// rst:
+	// rst:			Recompute the memory used by `t` and by the instance data.
+	// rst:			Visitors must call it when they grow the data they report through `Visitor::memory_tree_node` for an existing node.
+
+	void update_memory(TreeNode &t) {
+		t.update_memory(*this);
+		update_memory();
+	}
+
+	// rst:		.. function:: void update_memory()
+	// rst:
+	// rst:			Recompute the memory used by the instance data.
+
+	void update_memory() {
+		instance_bytes = sizeof(InstanceData) + visitor.memory_instance(*this);
+		if(canon_permuted_graph) instance_bytes += canon_permuted_graph->get_memory_usage();
+		if(extra_permuted_graph) instance_bytes += extra_permuted_graph->get_memory_usage();
+		peak_bytes = std::max(peak_bytes, get_memory_usage());
+	}
+
+	// for tree_node, to replace the amount accounted for a node
+
+	void replace_memory(std::size_t old_bytes, std::size_t new_bytes) {
+		assert(nodes_bytes >= old_bytes);
+		nodes_bytes = nodes_bytes - old_bytes + new_bytes;
+		peak_bytes = std::max(peak_bytes, get_memory_usage());
+	}
+
+	// rst:		.. function:: const resource_limits &get_limits() const
+	// rst:
+	// rst:			:returns: the limits of the run, see :expr:`canonicalizer::operator()`.
+
+	const resource_limits &get_limits() const {
+		return limits;
+	}
+
+	// rst:		.. function:: bool check_limits()
+	// rst:
+	// rst:			Poll the limits of the run.
+	// rst:			The budgets of tree nodes and leaves are enforced when a child is created and when a leaf is reported,
+	// rst:			so this only polls the cancellation flag and the deadline in addition.
+	// rst:			Tree traversals must call it before processing each tree node, and should stop and release their tree nodes when it returns `true`.
+	// rst:			Refiners may call it as well, and then return `RefinementResult::Abort`,
+	// rst:			so the tree node is pruned (which is also allowed for the root in this case).
+	// rst:			Without limits, this is only a test of a flag.
+	// rst:
+	// rst:			:returns: whether a limit has been reached, now or in a previous call.
+
+	bool check_limits() {
+		if(status != canon_status::complete) return true;
+		if(!is_limited) return false;
+		return poll_limits();
+	}
+
+	// rst:		.. function:: bool is_stopped() const
+	// rst:
+	// rst:			:returns: whether a previous call to `check_limits` has stopped the run.
+
+	bool is_stopped() const {
+		return status != canon_status::complete;
+	}
+
+	// rst:		.. function:: canon_status get_status() const
+	// rst:
+	// rst:			:returns: `canon_status::complete` until a limit has been reached, and then the limit.
+
+	canon_status get_status() const {
+		return status;
+	}
+
+	// rst:		.. function:: void stop(canon_status s)
+	// rst:
+	// rst:			Stop the run with status `s`, unless it has been stopped already,
+	// rst:			e.g., for a tree traversal that explores the tree in other states, which reached a limit.
+	// rst:
+	// rst:			:requires: `s != canon_status::complete`
+
+	void stop(canon_status s) {
+		assert(s != canon_status::complete);
+		if(status == canon_status::complete) status = s;
+	}
+
+	// rst:		.. function:: std::size_t get_num_tree_nodes() const
+	// rst:		              std::size_t get_num_leaves() const
+	// rst:
+	// rst:			:returns: the number of tree nodes created and leaves reported so far, as counted for the limits.
+
+	std::size_t get_num_tree_nodes() const {
+		return num_tree_nodes;
+	}
+
+	std::size_t get_num_leaves() const {
+		return num_leaves;
+	}
+
+	// for tree_node, before creating a child, returns false and stops the run when the budget is used up
+
+	bool reserve_tree_node() {
+		if(num_tree_nodes < limits.max_tree_nodes) return true;
+		if(status == canon_status::complete) status = canon_status::tree_node_limit;
+		return false;
+	}
+
+	// for tree_node, at the beginning of each construction
+
+	void count_tree_node() {
+		++num_tree_nodes;
+	}
+private:
+
+	bool poll_limits() {
+		if(limits.cancel && limits.cancel->load(std::memory_order_relaxed)) status = canon_status::cancelled;
+		else if(limits.deadline != resource_limits::clock::time_point::max() && --deadline_countdown == 0) {
+			deadline_countdown = resource_limits::deadline_poll_interval;
+			if(resource_limits::clock::now() >= limits.deadline) status = canon_status::deadline;
+		}
+		return status != canon_status::complete;
+	}
+
 public:
 	// rst:		.. var:: const Graph &g
 	// rst:
@@ -353,11 +660,32 @@ public:
 	// rst:
 	// rst:			The given `ReadablePropertyMap` that maps vertices to indices.
 	const IndexMap idx;
-	// rst:		.. var:: InstanceData data
+private:
+	canon_workspace<NodeAlloc> *workspace;
+	// the memory accounting, before anything that may keep tree nodes alive
+	std::size_t nodes_bytes = 0, instance_bytes = 0, peak_bytes = 0;
+	std::size_t limit_bytes = std::numeric_limits<std::size_t>::max();
+	// the resource limits, the clock is read at the first poll and then at every interval
+	const resource_limits limits;
+	const bool is_limited;
+	canon_status status = canon_status::complete;
+	std::size_t num_tree_nodes = 0, num_leaves = 0;
+	unsigned int deadline_countdown = 1;
+	// must be declared before anything that may keep tree nodes alive
+	std::unique_ptr<NodeAlloc> own_node_allocator;
+	std::shared_ptr<InstanceData> data_storage;
+public:
+	// rst:		.. var:: NodeAlloc &node_allocator
+	// rst:
+	// rst:			The allocator providing the storage for all tree nodes of this run,
+	// rst:			either owned by this state or by the workspace of the `canonicalizer`.
+	NodeAlloc &node_allocator;
+	// rst:		.. var:: InstanceData &data
 	// rst:
 	// rst:			The aggregated data structure holding all instance data.
 	// rst:			Use `get(my_tag(), data)` to access your data, tagged with some tag `my_tag`.
-	InstanceData data; // should be the last calculated data to be deleted
+	// rst:			It may have been used by a previous run of the same `canonicalizer`, see `canon_workspace`.
+	InstanceData &data; // should be the last calculated data to be deleted
 	// rst:		.. var:: EHandler &edge_handler
 	// rst:
 	// rst:			A reference to the `EdgeHandler` used for this run.
@@ -375,18 +703,53 @@ public:
 	OwnerPtr root = nullptr;
 private:
 	OwnerPtr canon_leaf = nullptr; // best graph of all the best_by_invariant
+	std::uint64_t canon_certificate = 0; // of canon_leaf
 	PermutedGraph *canon_permuted_graph = nullptr, *extra_permuted_graph = nullptr; // has owner pointers to their leaves
 };
 
-// rst: .. class:: template<typename SizeType, typename EdgeHandlerCreatorT, bool ParallelEdges, bool Loops> \
+// rst: .. class:: template<typename Perm, typename Data> \
+// rst:            canon_result : std::pair<Perm, Data>
+// rst:
+// rst:		The result of a canonicalization run with `resource_limits`,
+// rst:		i.e., the permutation and the visitor data as returned without limits, and the status of the run.
+// rst:
+
+template<typename Perm, typename Data>
+struct canon_result : std::pair<Perm, Data> {
+	// rst:		.. type:: pair_type = std::pair<Perm, Data>
+	using pair_type = std::pair<Perm, Data>;
+public:
+
+	canon_result(canon_status status, Perm &&perm, Data &&data)
+	: pair_type(std::move(perm), std::move(data)), status(status) { }
+
+	// rst:		.. function:: bool is_complete() const
+	// rst:
+	// rst:			:returns: `status == canon_status::complete`
+
+	bool is_complete() const {
+		return status == canon_status::complete;
+	}
+public:
+	// rst:		.. var:: canon_status status
+	canon_status status;
+};
+
+// rst: .. class:: template<typename SizeType, typename EdgeHandlerCreatorT, bool ParallelEdges, bool Loops, \
+// rst:                     typename NodeAllocatorT = node_allocator_new> \
 // rst:            canonicalizer
 // rst:
 // rst:		A reusable function object for canonicalizing graphs.
+// rst:		The node allocator and the instance data of the visitors are kept in a `canon_workspace` between calls,
+// rst:		so canonicalizing many graphs with the same object mostly avoids reallocating buffers.
 // rst:
-// rst:		Requires `SizeType` to be an integer type and `EdgeHandlerCreatorT` to be an `EdgeHandlerCreator`.
+// rst:		Requires `SizeType` to be an integer type, `EdgeHandlerCreatorT` to be an `EdgeHandlerCreator`,
+// rst:		and `NodeAllocatorT` to be a `NodeAllocator`.
+// rst:		Use `node_allocator_pool` for searches creating many tree nodes, e.g., with `traversal_bfs_exp`.
 // rst:
 
-template<typename SizeType, typename EdgeHandlerCreatorT, bool ParallelEdges, bool Loops>
+template<typename SizeType, typename EdgeHandlerCreatorT, bool ParallelEdges, bool Loops,
+		typename NodeAllocatorT = node_allocator_new>
 struct canonicalizer {
 	BOOST_STATIC_ASSERT_MSG(boost::is_integral<SizeType>::value, "SizeType must be integral.");
 	// rst:		.. type:: EdgeHandler = typename EdgeHandlerCreatorT::template type<SizeType>
@@ -423,6 +786,25 @@ public:
 
 	template<typename Graph, typename IndexMap, typename VertexLess, typename Vis>
 	auto operator()(const Graph &g, IndexMap idx, VertexLess vertex_less, Vis visitor) {
+		auto res = (*this)(g, idx, vertex_less, visitor, resource_limits());
+		assert(res.is_complete());
+		return typename decltype(res)::pair_type(std::move(res));
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename VertexLess, typename Vis> \
+	// rst:		              auto operator()(const Graph &g, IndexMap idx, VertexLess vertex_less, Vis visitor, const resource_limits &limits)
+	// rst:
+	// rst:			As the other overload, but the run is stopped when one of the `limits` is reached,
+	// rst:			e.g., to bound the time spent on a pathological graph.
+	// rst:			The limits are in effect from the refinement of the root.
+	// rst:
+	// rst:			:returns: A `canon_result` with the `canon_status` of the run.
+	// rst:				If the run was stopped, the permutation is that of the best leaf found so far,
+	// rst:				which is not canonical, or empty if no leaf was found.
+	// rst:				The visitor data is extracted as usual, so it contains, e.g., the automorphisms found so far.
+
+	template<typename Graph, typename IndexMap, typename VertexLess, typename Vis>
+	auto operator()(const Graph &g, IndexMap idx, VertexLess vertex_less, Vis visitor, const resource_limits &limits) {
 		// static checks
 		BOOST_CONCEPT_ASSERT((boost::VertexAndEdgeListGraphConcept<Graph>));
 		BOOST_CONCEPT_ASSERT((boost::BidirectionalGraphConcept<Graph>));
@@ -452,7 +834,7 @@ public:
 		BOOST_ASSERT_MSG(num_edges(g) <= std::numeric_limits<SizeType>::max(), "SizeType is too narrow for this graph.");
 
 
-		using Config = config<SizeType, ParallelEdges, Loops, Graph, IndexMap, EdgeHandler>;
+		using Config = config<SizeType, ParallelEdges, Loops, Graph, IndexMap, EdgeHandler, NodeAllocatorT>;
 		using Partition = typename Config::Partition;
 
 		// Create initial partition
@@ -465,14 +847,37 @@ public:
 		}
 
 		// Create and explore tree
-		canon_state<Config, VisitorWithInv>
-				state(g, idx, edge_handler, visitor_with_inv, vertex_less, std::move(pi));
+		using State = canon_state<Config, VisitorWithInv>;
+		State state(g, idx, edge_handler, visitor_with_inv, vertex_less, std::move(pi), &workspace, limits);
+		state.limit_memory(memory_limit);
 		visitor_with_inv.explore_tree(state);
-		return std::make_pair(state.get_canonical_permutation(), visitor_with_inv.extract_result(state));
+		// a stopped run may not have found a leaf
+		typename State::Perm perm;
+		if(state.get_canon_leaf()) perm = state.get_canonical_permutation();
+		auto data = visitor_with_inv.extract_result(state);
+		return canon_result<typename State::Perm, decltype(data)>(state.get_status(), std::move(perm), std::move(data));
+	}
+
+	// rst:		.. function:: void clear_workspace()
+	// rst:
+	// rst:			Release the memory kept from previous calls.
+
+	void clear_workspace() {
+		workspace.clear();
 	}
 
+	// rst:		.. function:: void set_memory_limit(std::size_t bytes)
+	// rst:
+	// rst:			Set the memory budget in bytes of the following calls, see :expr:`canon_state::limit_memory`.
+	// rst:			By default the budget is unlimited.
+
+	void set_memory_limit(std::size_t bytes) {
+		memory_limit = bytes;
+	}
 private:
 	EdgeHandler edge_handler;
+	canon_workspace<NodeAllocatorT> workspace;
+	std::size_t memory_limit = std::numeric_limits<std::size_t>::max();
 };
 
 // rst: .. function:: template<typename SizeType, bool ParallelEdges, bool Loops, typename Graph, typename IndexMap, \
@@ -499,6 +904,65 @@ auto canonicalize(const Graph &graph,
 			graph, idx, vertex_less, visitor);
 }
 
+// rst: .. function:: template<typename SizeType, bool ParallelEdges, bool Loops, typename Graph, typename IndexMap, \
+// rst:               typename VertexLess, typename EdgeHandlerCreatorT, typename Visitor> \
+// rst:               auto canonicalize(const Graph &graph, IndexMap idx, VertexLess vertex_less, EdgeHandlerCreatorT edge_handler_creator, Visitor visitor, \
+// rst:               const resource_limits &limits)
+// rst:
+// rst:		As above, but with `resource_limits`.
+
+template<
+		typename SizeType, bool ParallelEdges, bool Loops,
+		typename Graph, typename IndexMap,
+		typename VertexLess, typename EdgeHandlerCreatorT,
+		typename Visitor
+>
+auto canonicalize(const Graph &graph,
+						IndexMap idx,
+						VertexLess vertex_less,
+						EdgeHandlerCreatorT edge_handler_creator,
+						Visitor visitor,
+						const resource_limits &limits) {
+	return canonicalizer<SizeType, EdgeHandlerCreatorT, ParallelEdges, Loops>(edge_handler_creator)(
+			graph, idx, vertex_less, visitor, limits);
+}
+
+// rst: .. class:: template<typename SizeType> size_type_tag
+// rst:
+// rst:		An empty class for passing a `SizeType` to a generic function, see :expr:`dispatch_size_type`.
+// rst:
+
+template<typename SizeTypeT>
+struct size_type_tag {
+	// rst:		.. type:: type = SizeTypeT
+	using type = SizeTypeT;
+};
+
+// rst: .. function:: template<typename F> \
+// rst:               auto dispatch_size_type(std::size_t num_vertices, std::size_t num_edges, F f)
+// rst:
+// rst:		Select the narrowest of `std::uint16_t`, `std::uint32_t`, and `std::uint64_t` that can be used as `SizeType`
+// rst:		for canonicalizing a graph with `num_vertices` vertices and `num_edges` edges, and call `f(size_type_tag<SizeType>())`.
+// rst:		A narrower `SizeType` reduces the memory used by partitions, refinement counters, and permutations,
+// rst:		so the selection is useful when the graph size is only known at runtime.
+// rst:		All instantiations of `f` must have the same return type.
+// rst:		As a `canonicalizer` returns a permutation of `SizeType`, the result is typically handled inside `f`.
+// rst:
+// rst:		:returns: the return value of `f`.
+
+template<typename F>
+auto dispatch_size_type(std::size_t num_vertices, std::size_t num_edges, F f) {
+	// keep the maximum value free, so n + 1 never overflows
+	const auto fits = [&](const std::size_t max) {
+		return num_vertices < max && num_edges < max;
+	};
+	if(fits(std::numeric_limits<std::uint16_t>::max()))
+		return f(size_type_tag<std::uint16_t>());
+	if(fits(std::numeric_limits<std::uint32_t>::max()))
+		return f(size_type_tag<std::uint32_t>());
+	return f(size_type_tag<std::uint64_t>());
+}
+
 } // namespace graph_canon
 
 #endif // GRAPH_CANON_CANONICALIZATION_HPP
@@ -0,0 +1,351 @@
+#ifndef GRAPH_CANON_CERTIFICATE_IO_HPP
+#define GRAPH_CANON_CERTIFICATE_IO_HPP
+
+#include <graph_canon/detail/canonical_form.hpp>
+
+#include <boost/property_map/property_map.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: Binary Canonical Certificates
+// rst: ========================================================================
+// rst:
+// rst: A compact binary format for storing canonical forms of undirected graphs, e.g., in a database of graphs up to isomorphism.
+// rst: A file starts with the 4 bytes ``GCCF`` followed by the format version, currently 1.
+// rst: It is followed by any number of certificates, each on the form
+// rst:
+// rst: - :math:`n`, :math:`m`, and a flags word, where bit 0 indicates vertex labels and bit 1 indicates a permutation.
+// rst: - For each vertex in canonical order, the number of neighbours with a canonical index not lower than its own.
+// rst:   Each edge is thus counted once, at its canonically lower end.
+// rst: - For each vertex :math:`v` in canonical order, those neighbours in ascending order, delta encoded:
+// rst:   the first as the difference to :math:`v`, and each subsequent as the difference to the previous neighbour.
+// rst: - If bit 0 of the flags is set, the label of each vertex in canonical order.
+// rst: - If bit 1 of the flags is set, the canonical labelling, i.e., the canonical index of each vertex in input order.
+// rst:
+// rst: All numbers, including the version, are unsigned LEB128 varints, i.e., 7 bits per byte with the high bit set on all but the last byte.
+// rst: Edge labels are not stored.
+// rst: The canonical form of a certificate is the same as the arrays stored by `canonical_graph_set`,
+// rst: so certificates read from a file can be inserted with `canonical_graph_set::insert_form`.
+// rst:
+
+// rst: .. class:: template<typename SizeType> canonical_certificate
+// rst:
+// rst:		A decoded certificate.
+// rst:
+
+template<typename SizeType>
+struct canonical_certificate {
+	// rst:		.. var:: std::vector<SizeType> form
+	// rst:
+	// rst:			The canonical form in the layout of `canonical_graph_set`: :math:`n`, :math:`m`,
+	// rst:			and for each vertex in canonical order its number of higher neighbours followed by those neighbours.
+	std::vector<SizeType> form;
+	// rst:		.. var:: std::vector<std::size_t> vertex_labels
+	// rst:
+	// rst:			The vertex labels in canonical order, or empty if the graph is not labelled.
+	std::vector<std::size_t> vertex_labels;
+	// rst:		.. var:: std::vector<SizeType> permutation
+	// rst:
+	// rst:			The canonical index of each vertex in input order, or empty if it was not stored.
+	std::vector<SizeType> permutation;
+public:
+	// rst:		.. function:: std::size_t num_vertices() const
+	// rst:		              std::size_t num_edges() const
+
+	std::size_t num_vertices() const {
+		return form.empty() ? 0 : form[0];
+	}
+
+	std::size_t num_edges() const {
+		return form.empty() ? 0 : form[1];
+	}
+
+	// rst:		.. function:: friend bool operator==(const canonical_certificate &a, const canonical_certificate &b)
+	// rst:		              friend bool operator!=(const canonical_certificate &a, const canonical_certificate &b)
+	// rst:
+	// rst:			Compare the canonical forms and the vertex labels, but not the permutations.
+	// rst:			Equal certificates thus represent isomorphic graphs.
+
+	friend bool operator==(const canonical_certificate &a, const canonical_certificate &b) {
+		return a.form == b.form && a.vertex_labels == b.vertex_labels;
+	}
+
+	friend bool operator!=(const canonical_certificate &a, const canonical_certificate &b) {
+		return !(a == b);
+	}
+};
+
+namespace detail {
+
+constexpr char certificate_magic[4] = {'G', 'C', 'C', 'F'};
+constexpr std::size_t certificate_version = 1;
+constexpr std::size_t certificate_flag_vertex_labels = 1;
+constexpr std::size_t certificate_flag_permutation = 2;
+
+inline void append_varint(std::string &buf, std::uint64_t value) {
+	while(value >= 0x80) {
+		buf.push_back(static_cast<char> (value | 0x80));
+		value >>= 7;
+	}
+	buf.push_back(static_cast<char> (value));
+}
+
+} // namespace detail
+
+// rst: .. class:: canonical_certificate_writer
+// rst:
+// rst:		Writes a stream of binary certificates, see the format description above.
+// rst:		Each certificate is encoded in a buffer that is reused,
+// rst:		and then written with a single unformatted write.
+// rst:
+
+class canonical_certificate_writer {
+public:
+	// rst:		.. function:: explicit canonical_certificate_writer(std::ostream &s)
+	// rst:
+	// rst:			Write the file header to `s`, which should be opened in binary mode.
+
+	explicit canonical_certificate_writer(std::ostream &s) : s(s) {
+		s.write(detail::certificate_magic, sizeof(detail::certificate_magic));
+		buf.clear();
+		detail::append_varint(buf, detail::certificate_version);
+		flush();
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename Perm> \
+	// rst:		              void write(const Graph &g, IndexMap idx, const Perm &canon_perm, bool with_permutation = false)
+	// rst:
+	// rst:			Write the certificate of the unlabelled graph `g`, where `canon_perm[get(idx, v)]` is the canonical index of `v`,
+	// rst:			e.g., the permutation returned by a `canonicalizer`.
+	// rst:			Requires `Graph` to be a `VertexListGraph` and an `EdgeListGraph`, and to be undirected.
+	// rst:
+	// rst:			:param with_permutation: also store `canon_perm`.
+
+	template<typename Graph, typename IndexMap, typename Perm>
+	void write(const Graph &g, IndexMap idx, const Perm &canon_perm, bool with_permutation = false) {
+		write_impl(g, idx, canon_perm, with_permutation, [](const auto &v) {
+			return std::size_t(0);
+		}, false);
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename Perm, typename VertexLabelMap> \
+	// rst:		              void write_labelled(const Graph &g, IndexMap idx, const Perm &canon_perm, VertexLabelMap vertex_label, \
+	// rst:		                                  bool with_permutation = false)
+	// rst:
+	// rst:			Like `write`, but also store the labels given by the `ReadablePropertyMap` `vertex_label`,
+	// rst:			with non-negative integer values.
+
+	template<typename Graph, typename IndexMap, typename Perm, typename VertexLabelMap>
+	void write_labelled(const Graph &g, IndexMap idx, const Perm &canon_perm, VertexLabelMap vertex_label,
+			bool with_permutation = false) {
+		write_impl(g, idx, canon_perm, with_permutation, [&vertex_label](const auto &v) {
+			return static_cast<std::size_t> (get(vertex_label, v));
+		}, true);
+	}
+
+	// rst:		.. function:: template<typename SizeType> \
+	// rst:		              void write(const canonical_certificate<SizeType> &c)
+	// rst:
+	// rst:			Write a certificate, e.g., one read by a `canonical_certificate_reader`.
+
+	template<typename SizeType>
+	void write(const canonical_certificate<SizeType> &c) {
+		buf.clear();
+		append_form(c.form, !c.vertex_labels.empty(), !c.permutation.empty());
+		for(const auto l : c.vertex_labels) detail::append_varint(buf, l);
+		for(const auto p : c.permutation) detail::append_varint(buf, p);
+		flush();
+	}
+private:
+
+	template<typename Graph, typename IndexMap, typename Perm, typename GetLabel>
+	void write_impl(const Graph &g, IndexMap idx, const Perm &canon_perm, bool with_permutation,
+			GetLabel get_label, bool with_labels) {
+		using SizeType = std::decay_t<decltype(canon_perm[0])>;
+		static_assert(sizeof(SizeType) <= sizeof(std::size_t), "The canonical indices must fit in std::size_t.");
+		detail::encode_canonical_form(g, idx, canon_perm, form);
+		buf.clear();
+		append_form(form, with_labels, with_permutation);
+		if(with_labels) {
+			labels.assign(form[0], 0);
+			const auto vs = vertices(g);
+			for(auto v_iter = vs.first; v_iter != vs.second; ++v_iter)
+				labels[canon_perm[get(idx, *v_iter)]] = get_label(*v_iter);
+			for(const auto l : labels) detail::append_varint(buf, l);
+		}
+		if(with_permutation) {
+			for(std::size_t i = 0; i != form[0]; ++i)
+				detail::append_varint(buf, canon_perm[i]);
+		}
+		flush();
+	}
+
+	template<typename SizeType>
+	void append_form(const std::vector<SizeType> &form, bool with_labels, bool with_permutation) {
+		const std::size_t n = form[0];
+		detail::append_varint(buf, n);
+		detail::append_varint(buf, form[1]);
+		detail::append_varint(buf, (with_labels ? detail::certificate_flag_vertex_labels : 0)
+				| (with_permutation ? detail::certificate_flag_permutation : 0));
+		// first the degrees, then the neighbours
+		std::size_t pos = 2;
+		for(std::size_t v = 0; v != n; ++v) {
+			detail::append_varint(buf, form[pos]);
+			pos += 1 + form[pos];
+		}
+		pos = 2;
+		for(std::size_t v = 0; v != n; ++v) {
+			const std::size_t d = form[pos++];
+			std::size_t prev = v;
+			for(std::size_t i = 0; i != d; ++i, ++pos) {
+				detail::append_varint(buf, form[pos] - prev);
+				prev = form[pos];
+			}
+		}
+	}
+
+	void flush() {
+		s.write(buf.data(), buf.size());
+	}
+private:
+	std::ostream &s;
+	std::string buf;
+	std::vector<std::size_t> form;
+	std::vector<std::size_t> labels;
+};
+
+// rst: .. class:: canonical_certificate_reader
+// rst:
+// rst:		Reads a stream of binary certificates, see the format description above.
+// rst:		Errors are reported in the same way as by `read_dimacs_graph`, by writing a message to an error stream.
+// rst:
+
+class canonical_certificate_reader {
+public:
+	// rst:		.. function:: canonical_certificate_reader(std::istream &s, std::ostream &err)
+	// rst:
+	// rst:			Read the file header from `s`, which should be opened in binary mode.
+	// rst:			Reading errors are written to `err`.
+
+	canonical_certificate_reader(std::istream &s, std::ostream &err) : s(s), err(err) {
+		char magic[sizeof(detail::certificate_magic)];
+		if(!s.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), detail::certificate_magic)) {
+			fail("Not a binary certificate file.");
+			return;
+		}
+		std::uint64_t version;
+		if(!read_varint(version)) return;
+		if(version != detail::certificate_version) {
+			fail("Unsupported certificate format version " + std::to_string(version) + ".");
+			return;
+		}
+	}
+
+	// rst:		.. function:: template<typename SizeType> \
+	// rst:		              bool read(canonical_certificate<SizeType> &c)
+	// rst:
+	// rst:			Read the next certificate into `c`, reusing its storage.
+	// rst:
+	// rst:			:returns: `false` at the end of the stream or if an error occurred, see `failed`.
+
+	template<typename SizeType>
+	bool read(canonical_certificate<SizeType> &c) {
+		if(has_failed) return false;
+		if(s.rdbuf()->sgetc() == std::char_traits<char>::eof()) return false;
+		std::uint64_t n, m, flags;
+		if(!read_varint(n) || !read_varint(m) || !read_varint(flags)) return false;
+		if(n >= std::numeric_limits<SizeType>::max() || m >= std::numeric_limits<SizeType>::max())
+			return fail("The graph is too large for the SizeType.");
+		if(flags > (detail::certificate_flag_vertex_labels | detail::certificate_flag_permutation))
+			return fail("Unknown flags " + std::to_string(flags) + ".");
+		// n and m are not trusted, so the storage only grows with the data actually read
+		c.form.clear();
+		c.form.push_back(n);
+		c.form.push_back(m);
+		degrees.clear();
+		std::uint64_t sum = 0;
+		for(std::size_t v = 0; v != n; ++v) {
+			std::uint64_t d;
+			if(!read_varint(d)) return false;
+			if(d > m - sum) return fail("The degrees sum to more than m.");
+			degrees.push_back(d);
+			sum += d;
+		}
+		if(sum != m) return fail("The degrees do not sum to m.");
+		for(std::size_t v = 0; v != n; ++v) {
+			const std::size_t d = degrees[v];
+			c.form.push_back(d);
+			std::uint64_t prev = v;
+			for(std::size_t i = 0; i != d; ++i) {
+				std::uint64_t delta;
+				if(!read_varint(delta)) return false;
+				if(delta >= n - prev) return fail("Neighbour index out of range.");
+				prev += delta;
+				c.form.push_back(prev);
+			}
+		}
+		c.vertex_labels.clear();
+		if(flags & detail::certificate_flag_vertex_labels) {
+			for(std::size_t v = 0; v != n; ++v) {
+				std::uint64_t value;
+				if(!read_varint(value)) return false;
+				c.vertex_labels.push_back(value);
+			}
+		}
+		c.permutation.clear();
+		if(flags & detail::certificate_flag_permutation) {
+			for(std::size_t v = 0; v != n; ++v) {
+				std::uint64_t value;
+				if(!read_varint(value)) return false;
+				if(value >= n) return fail("Permutation entry out of range.");
+				c.permutation.push_back(value);
+			}
+		}
+		return true;
+	}
+
+	// rst:		.. function:: bool failed() const
+	// rst:
+	// rst:			:returns: `true` if an error has occurred.
+
+	bool failed() const {
+		return has_failed;
+	}
+private:
+
+	bool read_varint(std::uint64_t &value) {
+		value = 0;
+		for(unsigned int shift = 0; shift < 64; shift += 7) {
+			const auto c = s.rdbuf()->sbumpc();
+			if(c == std::char_traits<char>::eof()) return fail("Unexpected end of stream.");
+			value |= static_cast<std::uint64_t> (c & 0x7f) << shift;
+			if(!(c & 0x80)) return true;
+		}
+		return fail("Varint too long.");
+	}
+
+	bool fail(const std::string &msg) {
+		err << msg << '\n';
+		has_failed = true;
+		return false;
+	}
+private:
+	std::istream &s;
+	std::ostream &err;
+	bool has_failed = false;
+	std::vector<std::uint64_t> degrees; // of the certificate being read
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_CERTIFICATE_IO_HPP */
@@ -0,0 +1,496 @@
+#ifndef GRAPH_CANON_CSR_GRAPH_HPP
+#define GRAPH_CANON_CSR_GRAPH_HPP
+
+#include <graph_canon/detail/for_each_neighbour.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/iteration_macros.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph_canon {
+
+namespace detail {
+
+struct csr_graph_tag {
+};
+
+// The Boost.Graph interface shared by all graphs in compressed sparse row format.
+// Derived must provide get_num_vertices(), get_num_half_edges(), get_targets(), get_out_begin(v), get_out_end(v),
+// get_vertex_label(v), and get_edge_label(e).
+
+template<typename Derived, typename SizeTypeT, typename VertexLabelT, typename EdgeLabelT>
+struct csr_graph_base : csr_graph_tag {
+	BOOST_STATIC_ASSERT_MSG(std::is_integral<SizeTypeT>::value, "SizeType must be integral.");
+	using SizeType = SizeTypeT;
+	using VertexLabel = VertexLabelT;
+	using EdgeLabel = EdgeLabelT;
+public: // Graph
+	using vertex_descriptor = SizeType;
+
+	struct edge_descriptor {
+		SizeType source, target;
+		std::size_t pos; // index of the half-edge in the target array
+
+		friend bool operator==(const edge_descriptor &a, const edge_descriptor &b) {
+			return a.pos == b.pos && a.source == b.source;
+		}
+
+		friend bool operator!=(const edge_descriptor &a, const edge_descriptor &b) {
+			return !(a == b);
+		}
+	};
+
+	using directed_category = boost::undirected_tag;
+	using edge_parallel_category = boost::allow_parallel_edge_tag;
+
+	struct traversal_category :
+			virtual boost::vertex_list_graph_tag,
+			virtual boost::edge_list_graph_tag,
+			virtual boost::incidence_graph_tag,
+			virtual boost::adjacency_graph_tag,
+			virtual boost::bidirectional_graph_tag {
+	};
+
+	static vertex_descriptor null_vertex() {
+		return std::numeric_limits<SizeType>::max();
+	}
+public: // VertexListGraph
+	using vertex_iterator = boost::counting_iterator<SizeType>;
+	using vertices_size_type = SizeType;
+public: // IncidenceGraph, BidirectionalGraph
+
+	template<bool Reversed>
+	struct half_edge_iterator
+			: boost::iterator_facade<half_edge_iterator<Reversed>, edge_descriptor,
+					std::random_access_iterator_tag, edge_descriptor> {
+		using base_type = boost::iterator_facade<half_edge_iterator<Reversed>, edge_descriptor,
+				std::random_access_iterator_tag, edge_descriptor>;
+
+		half_edge_iterator() = default;
+
+		half_edge_iterator(SizeType v, const SizeType *targets, std::size_t pos) : v(v), targets(targets), pos(pos) {}
+
+	private:
+		friend class boost::iterator_core_access;
+
+		edge_descriptor dereference() const {
+			if(Reversed) return edge_descriptor{targets[pos], v, pos};
+			else return edge_descriptor{v, targets[pos], pos};
+		}
+
+		void increment() {
+			++pos;
+		}
+
+		void decrement() {
+			--pos;
+		}
+
+		bool equal(const half_edge_iterator &other) const {
+			return pos == other.pos;
+		}
+
+		void advance(typename base_type::difference_type n) {
+			pos += n;
+		}
+
+		typename base_type::difference_type distance_to(const half_edge_iterator &other) const {
+			return static_cast<typename base_type::difference_type> (other.pos)
+					- static_cast<typename base_type::difference_type> (pos);
+		}
+
+	private:
+		SizeType v;
+		const SizeType *targets;
+		std::size_t pos;
+	};
+
+	using out_edge_iterator = half_edge_iterator<false>;
+	using in_edge_iterator = half_edge_iterator<true>;
+	using degree_size_type = SizeType;
+public: // AdjacencyGraph
+	using adjacency_iterator = const SizeType*;
+public: // EdgeListGraph
+
+	// each edge is represented by the half-edge stored at its end-point with the smallest index
+
+	struct edge_iterator
+			: boost::iterator_facade<edge_iterator, edge_descriptor,
+					std::forward_iterator_tag, edge_descriptor> {
+		edge_iterator() = default;
+
+		edge_iterator(const Derived *g, SizeType v, std::size_t pos) : g(g), v(v), pos(pos) {
+			skip();
+		}
+
+	private:
+		friend class boost::iterator_core_access;
+
+		edge_descriptor dereference() const {
+			return edge_descriptor{v, g->get_targets()[pos], pos};
+		}
+
+		void increment() {
+			++pos;
+			skip();
+		}
+
+		bool equal(const edge_iterator &other) const {
+			return pos == other.pos;
+		}
+
+		void skip() {
+			const std::size_t num_half_edges = g->get_num_half_edges();
+			const SizeType *targets = g->get_targets();
+			for(; pos != num_half_edges; ++pos) {
+				while(pos == g->get_out_end(v)) ++v;
+				if(v < targets[pos]) break;
+			}
+		}
+
+	private:
+		const Derived *g;
+		SizeType v;
+		std::size_t pos;
+	};
+
+	using edges_size_type = std::size_t;
+public: // Boost.Graph interface
+
+	friend std::pair<vertex_iterator, vertex_iterator> vertices(const Derived &g) {
+		return std::make_pair(vertex_iterator(0), vertex_iterator(num_vertices(g)));
+	}
+
+	friend vertices_size_type num_vertices(const Derived &g) {
+		return g.get_num_vertices();
+	}
+
+	friend vertex_descriptor vertex(vertices_size_type i, const Derived &g) {
+		return i;
+	}
+
+	friend std::pair<edge_iterator, edge_iterator> edges(const Derived &g) {
+		return std::make_pair(edge_iterator(&g, 0, 0), edge_iterator(&g, 0, g.get_num_half_edges()));
+	}
+
+	friend edges_size_type num_edges(const Derived &g) {
+		return g.get_num_half_edges() / 2;
+	}
+
+	friend vertex_descriptor source(const edge_descriptor &e, const Derived &g) {
+		return e.source;
+	}
+
+	friend vertex_descriptor target(const edge_descriptor &e, const Derived &g) {
+		return e.target;
+	}
+
+	friend std::pair<out_edge_iterator, out_edge_iterator> out_edges(vertex_descriptor v, const Derived &g) {
+		return std::make_pair(out_edge_iterator(v, g.get_targets(), g.get_out_begin(v)),
+				out_edge_iterator(v, g.get_targets(), g.get_out_end(v)));
+	}
+
+	friend degree_size_type out_degree(vertex_descriptor v, const Derived &g) {
+		return g.get_out_end(v) - g.get_out_begin(v);
+	}
+
+	friend std::pair<in_edge_iterator, in_edge_iterator> in_edges(vertex_descriptor v, const Derived &g) {
+		return std::make_pair(in_edge_iterator(v, g.get_targets(), g.get_out_begin(v)),
+				in_edge_iterator(v, g.get_targets(), g.get_out_end(v)));
+	}
+
+	friend degree_size_type in_degree(vertex_descriptor v, const Derived &g) {
+		return out_degree(v, g);
+	}
+
+	friend degree_size_type degree(vertex_descriptor v, const Derived &g) {
+		return out_degree(v, g);
+	}
+
+	friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices(vertex_descriptor v, const Derived &g) {
+		return std::make_pair(g.get_targets() + g.get_out_begin(v), g.get_targets() + g.get_out_end(v));
+	}
+public: // property maps
+
+	struct vertex_label_map {
+		using key_type = vertex_descriptor;
+		using value_type = VertexLabel;
+		using reference = const VertexLabel&;
+		using category = boost::readable_property_map_tag;
+
+		friend reference get(const vertex_label_map &m, key_type v) {
+			return m.g->get_vertex_label(v);
+		}
+	public:
+		const Derived *g;
+	};
+
+	struct edge_label_map {
+		using key_type = edge_descriptor;
+		using value_type = EdgeLabel;
+		using reference = const EdgeLabel&;
+		using category = boost::readable_property_map_tag;
+
+		friend reference get(const edge_label_map &m, const key_type &e) {
+			return m.g->get_edge_label(e);
+		}
+	public:
+		const Derived *g;
+	};
+
+	friend boost::typed_identity_property_map<SizeType> get(boost::vertex_index_t, const Derived &g) {
+		return {};
+	}
+
+	friend vertex_label_map get(boost::vertex_name_t, const Derived &g) {
+		return vertex_label_map{&g};
+	}
+
+	friend edge_label_map get(boost::edge_name_t, const Derived &g) {
+		return edge_label_map{&g};
+	}
+};
+
+} // namespace detail
+
+// rst: .. class:: template<typename SizeTypeT, typename VertexLabelT = std::size_t, typename EdgeLabelT = std::size_t> \
+// rst:            csr_graph
+// rst:
+// rst:		An immutable undirected graph in compressed sparse row format,
+// rst:		with vertex labels of type `VertexLabelT` and edge labels of type `EdgeLabelT`.
+// rst:		The vertices are the integers :math:`0` to :math:`n - 1` of type `SizeTypeT`,
+// rst:		and each edge is stored as two half-edges, one in the out-edge list of each end-point.
+// rst:		All out-edge lists are stored contiguously in a single array of target vertices.
+// rst:		Parallel edges are allowed, but loops are not.
+// rst:
+// rst:		The graph models a `VertexListGraph`, an `EdgeListGraph`, an `IncidenceGraph`, an `AdjacencyGraph`,
+// rst:		and a `BidirectionalGraph`, and the expression `vertex(i, g)` is valid.
+// rst:		The property maps for `boost::vertex_index_t`, `boost::vertex_name_t` (the vertex labels),
+// rst:		and `boost::edge_name_t` (the edge labels) can be retrieved with `get(tag, g)`.
+// rst:
+// rst:		When a `csr_graph` is canonicalized with its own vertex index map,
+// rst:		the refinement functions iterate directly through the target array,
+// rst:		instead of going through edge descriptors and the index map for each neighbour.
+// rst:
+
+template<typename SizeTypeT, typename VertexLabelT = std::size_t, typename EdgeLabelT = std::size_t>
+struct csr_graph
+: detail::csr_graph_base<csr_graph<SizeTypeT, VertexLabelT, EdgeLabelT>, SizeTypeT, VertexLabelT, EdgeLabelT> {
+	using base_type = detail::csr_graph_base<csr_graph<SizeTypeT, VertexLabelT, EdgeLabelT>, SizeTypeT, VertexLabelT, EdgeLabelT>;
+	// rst:		.. type:: SizeType = SizeTypeT
+	using SizeType = SizeTypeT;
+	// rst:		.. type:: VertexLabel = VertexLabelT
+	using VertexLabel = VertexLabelT;
+	// rst:		.. type:: EdgeLabel = EdgeLabelT
+	using EdgeLabel = EdgeLabelT;
+	using typename base_type::edge_descriptor;
+public:
+
+	// rst:		.. function:: csr_graph()
+	// rst:
+	// rst:			Construct an empty graph.
+
+	csr_graph() : offsets(1, 0) { }
+
+	// rst:		.. function:: template<typename EdgeIter> \
+	// rst:		              csr_graph(SizeType num_vertices, EdgeIter first, EdgeIter last)
+	// rst:
+	// rst:			Construct a graph with `num_vertices` vertices and an edge for each pair of vertex indices in the range
+	// rst:			from `first` to `last`. All labels are value-initialized.
+
+	template<typename EdgeIter>
+	csr_graph(SizeType num_vertices, EdgeIter first, EdgeIter last)
+	: offsets(std::size_t(num_vertices) + 1, 0), vertex_labels(num_vertices) {
+		BOOST_ASSERT_MSG(num_vertices < std::numeric_limits<SizeType>::max(), "SizeType is too narrow for this graph.");
+		for(auto iter = first; iter != last; ++iter) {
+			BOOST_ASSERT_MSG(iter->first != iter->second, "Loops are not supported.");
+			++offsets[iter->first + 1];
+			++offsets[iter->second + 1];
+		}
+		for(std::size_t i = 0; i < num_vertices; ++i)
+			offsets[i + 1] += offsets[i];
+		targets.resize(offsets[num_vertices]);
+		edge_labels.resize(offsets[num_vertices]);
+		std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+		for(auto iter = first; iter != last; ++iter) {
+			const SizeType u = iter->first, v = iter->second;
+			targets[next[u]++] = v;
+			targets[next[v]++] = u;
+		}
+	}
+
+	// rst:		.. function:: template<typename EdgeIter> \
+	// rst:		              csr_graph(SizeType num_vertices, EdgeIter first, EdgeIter last, std::vector<VertexLabel> vertex_labels)
+	// rst:
+	// rst:			As above, but with the given label for each vertex.
+
+	template<typename EdgeIter>
+	csr_graph(SizeType num_vertices, EdgeIter first, EdgeIter last, std::vector<VertexLabel> vertex_labels)
+	: csr_graph(num_vertices, first, last) {
+		BOOST_ASSERT(vertex_labels.size() == num_vertices);
+		this->vertex_labels = std::move(vertex_labels);
+	}
+
+	// rst:		.. function:: template<typename Graph, typename IndexMap, typename VertexLabelMap, typename EdgeLabelMap> \
+	// rst:		              csr_graph(const Graph &g, IndexMap idx, VertexLabelMap vertex_label, EdgeLabelMap edge_label)
+	// rst:
+	// rst:			Construct a copy of the undirected graph `g`, where each vertex `v` gets index `get(idx, v)`
+	// rst:			and label `get(vertex_label, v)`, and each edge `e` gets label `get(edge_label, e)`.
+	// rst:			The out-edges of each vertex are stored in the order given by `g`.
+	// rst:
+	// rst:			Requires `Graph` to model a `VertexListGraph`, an `EdgeListGraph`, and an `IncidenceGraph`,
+	// rst:			`IndexMap` to map the vertices of `g` into contiguous indices starting from 0,
+	// rst:			and `VertexLabelMap` and `EdgeLabelMap` to be `ReadablePropertyMap` with values convertible
+	// rst:			to `VertexLabel` and `EdgeLabel` respectively.
+
+	template<typename Graph, typename IndexMap, typename VertexLabelMap, typename EdgeLabelMap>
+	csr_graph(const Graph &g, IndexMap idx, VertexLabelMap vertex_label, EdgeLabelMap edge_label) {
+		BOOST_STATIC_ASSERT((std::is_convertible<typename boost::graph_traits<Graph>::directed_category, boost::undirected_tag>::value));
+		const std::size_t n = num_vertices(g);
+		BOOST_ASSERT_MSG(n < std::numeric_limits<SizeType>::max(), "SizeType is too narrow for this graph.");
+		offsets.assign(n + 1, 0);
+		vertex_labels.resize(n);
+		BGL_FORALL_VERTICES_T(v, g, Graph) {
+			const std::size_t v_idx = get(idx, v);
+			offsets[v_idx + 1] = out_degree(v, g);
+			vertex_labels[v_idx] = get(vertex_label, v);
+		}
+		for(std::size_t i = 0; i < n; ++i)
+			offsets[i + 1] += offsets[i];
+		targets.resize(offsets[n]);
+		edge_labels.resize(offsets[n]);
+		BGL_FORALL_VERTICES_T(v, g, Graph) {
+			const std::size_t v_idx = get(idx, v);
+			std::size_t pos = offsets[v_idx];
+			BGL_FORALL_OUTEDGES_T(v, e, g, Graph) {
+				targets[pos] = get(idx, target(e, g));
+				BOOST_ASSERT_MSG(targets[pos] != v_idx, "Loops are not supported.");
+				edge_labels[pos] = get(edge_label, e);
+				++pos;
+			}
+		}
+	}
+public: // raw access
+
+	// rst:		.. function:: const SizeType *get_targets() const
+	// rst:
+	// rst:			:returns: a pointer to the array of targets of all half-edges.
+	// rst:				The targets of the out-edges of vertex `v` are at the positions from `get_out_begin(v)` to `get_out_end(v)`.
+
+	const SizeType *get_targets() const {
+		return targets.data();
+	}
+
+	// rst:		.. function:: SizeType get_num_vertices() const
+	// rst:		              std::size_t get_num_half_edges() const
+
+	SizeType get_num_vertices() const {
+		return offsets.size() - 1;
+	}
+
+	std::size_t get_num_half_edges() const {
+		return targets.size();
+	}
+
+	// rst:		.. function:: std::size_t get_out_begin(SizeType v) const
+	// rst:		              std::size_t get_out_end(SizeType v) const
+
+	std::size_t get_out_begin(SizeType v) const {
+		return offsets[v];
+	}
+
+	std::size_t get_out_end(SizeType v) const {
+		return offsets[v + 1];
+	}
+
+	// rst:		.. function:: const VertexLabel &get_vertex_label(SizeType v) const
+
+	const VertexLabel &get_vertex_label(SizeType v) const {
+		return vertex_labels[v];
+	}
+
+	// rst:		.. function:: const EdgeLabel &get_edge_label(const edge_descriptor &e) const
+
+	const EdgeLabel &get_edge_label(const edge_descriptor &e) const {
+		return edge_labels[e.pos];
+	}
+private:
+	std::vector<std::size_t> offsets; // n + 1 entries, the out-edges of v are at [offsets[v], offsets[v + 1])
+	std::vector<SizeType> targets;
+	std::vector<VertexLabel> vertex_labels;
+	std::vector<EdgeLabel> edge_labels; // one for each half-edge
+};
+
+namespace detail {
+
+// true if neighbours can be found directly in the target array of a graph in compressed sparse row format,
+// i.e., when the index map used is the one of the graph
+
+template<typename Graph, typename IndexMap, bool = std::is_base_of<csr_graph_tag, Graph>::value>
+struct is_csr_graph_with_own_index : std::false_type {
+};
+
+template<typename Graph, typename IndexMap>
+struct is_csr_graph_with_own_index<Graph, IndexMap, true>
+: std::is_same<IndexMap, boost::typed_identity_property_map<typename Graph::SizeType> > {
+};
+
+// the vertex indices are directly in the target array
+
+template<typename Graph, typename IndexMap>
+struct neighbour_iteration<Graph, IndexMap, std::enable_if_t<is_csr_graph_with_own_index<Graph, IndexMap>::value> > {
+
+	template<typename State, typename TreeNode, typename Vertex, typename Callback>
+	static void for_each(const State &state, const TreeNode &node, const Vertex v, const Callback callback) {
+		using Edge = typename State::Edge;
+		const auto &pi = node.pi;
+		const auto *begin_cell_from_v_idx = pi.begin_cell_from_v_idx();
+		const auto *begin_cell_end = pi.begin_cell_end();
+		const auto *targets = state.g.get_targets();
+		const auto last = state.g.get_out_end(v);
+		for(auto pos = state.g.get_out_begin(v); pos != last; ++pos) {
+			const auto v_idx = targets[pos];
+			const auto target_element_cell = begin_cell_from_v_idx[v_idx];
+			const auto target_element_cell_end = begin_cell_end[target_element_cell];
+			const bool is_singleton = target_element_cell + 1 == target_element_cell_end;
+			if(is_singleton) continue;
+			callback(Edge{v, v_idx, pos}, v_idx, target_element_cell, target_element_cell_end);
+		}
+	}
+};
+
+} // namespace detail
+} // namespace graph_canon
+namespace boost {
+
+template<typename SizeType, typename VertexLabel, typename EdgeLabel>
+struct property_map<graph_canon::csr_graph<SizeType, VertexLabel, EdgeLabel>, vertex_index_t> {
+	using type = typed_identity_property_map<SizeType>;
+	using const_type = type;
+};
+
+template<typename SizeType, typename VertexLabel, typename EdgeLabel>
+struct property_map<graph_canon::csr_graph<SizeType, VertexLabel, EdgeLabel>, vertex_name_t> {
+	using type = typename graph_canon::csr_graph<SizeType, VertexLabel, EdgeLabel>::vertex_label_map;
+	using const_type = type;
+};
+
+template<typename SizeType, typename VertexLabel, typename EdgeLabel>
+struct property_map<graph_canon::csr_graph<SizeType, VertexLabel, EdgeLabel>, edge_name_t> {
+	using type = typename graph_canon::csr_graph<SizeType, VertexLabel, EdgeLabel>::edge_label_map;
+	using const_type = type;
+};
+
+} // namespace boost
+
+#endif /* GRAPH_CANON_CSR_GRAPH_HPP */
@@ -0,0 +1,60 @@
+#ifndef GRAPH_CANON_DETAIL_CANONICAL_FORM_HPP
+#define GRAPH_CANON_DETAIL_CANONICAL_FORM_HPP
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace graph_canon {
+namespace detail {
+
+// Store the canonical form of g in form: n, m, and then for each vertex in canonical order,
+// the number of neighbours with a canonical index not lower than its own, followed by those indices in ascending order.
+// canon_perm[get(idx, v)] must be the canonical index of the vertex v.
+// An edge is stored with its endpoints ordered, so the graph must be undirected.
+
+template<typename SizeType, typename Graph, typename IndexMap, typename Perm>
+void encode_canonical_form(const Graph &g, IndexMap idx, const Perm &canon_perm, std::vector<SizeType> &form) {
+	static_assert(boost::is_undirected_graph<Graph>::value, "Canonical forms are only encoded for undirected graphs.");
+	const std::size_t n = num_vertices(g);
+	const std::size_t m = num_edges(g);
+	const auto es = edges(g);
+	form.assign(2 + n + m, 0);
+	form[0] = n;
+	form[1] = m;
+	// count the neighbours of each vertex, turn the counts into the end of the block of each vertex,
+	// and fill the blocks backwards
+	const auto endpoints = [&](const auto &e) {
+		const SizeType u = canon_perm[get(idx, source(e, g))];
+		const SizeType v = canon_perm[get(idx, target(e, g))];
+		return std::make_pair(std::min(u, v), std::max(u, v));
+	};
+	std::vector<std::size_t> block_end(n);
+	for(auto e_iter = es.first; e_iter != es.second; ++e_iter)
+		++block_end[endpoints(*e_iter).first];
+	std::size_t pos = 2;
+	for(std::size_t v = 0; v != n; ++v) {
+		pos += 1 + block_end[v];
+		block_end[v] = pos;
+	}
+	for(auto e_iter = es.first; e_iter != es.second; ++e_iter) {
+		const auto p = endpoints(*e_iter);
+		form[--block_end[p.first]] = p.second;
+	}
+	// now block_end[v] is the beginning of the neighbours of v
+	for(std::size_t v = 0; v != n; ++v) {
+		const std::size_t first = block_end[v];
+		const std::size_t last = v + 1 == n ? form.size() : block_end[v + 1] - 1;
+		form[first - 1] = last - first;
+		std::sort(form.begin() + first, form.begin() + last);
+	}
+}
+
+} // namespace detail
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_DETAIL_CANONICAL_FORM_HPP */
@@ -0,0 +1,170 @@
+#ifndef GRAPH_CANON_DETAIL_CONCURRENT_SEARCH_HPP
+#define GRAPH_CANON_DETAIL_CONCURRENT_SEARCH_HPP
+
+#include <graph_canon/resource_limits.hpp>
+#include <graph_canon/util.hpp>
+
+#include <perm_group/permutation/permutation.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace graph_canon {
+namespace detail {
+
+// Automorphisms found by searches of the same graph running in different threads.
+
+template<typename SizeType>
+struct shared_automorphisms {
+	struct entry {
+		std::size_t owner;
+		std::vector<SizeType> aut;
+	};
+public:
+
+	template<typename Perm>
+	void publish(std::size_t owner, SizeType n, const Perm &aut) {
+		std::vector<SizeType> p(n);
+		for(SizeType i = 0; i < n; ++i)
+			p[i] = perm_group::get(aut, i);
+		std::lock_guard<std::mutex> lock(m);
+		auts.push_back(entry{owner, std::move(p)});
+		num_auts.store(auts.size(), std::memory_order_release);
+	}
+
+	// append all entries from index first to buffer, and return the new number of entries
+
+	std::size_t fetch(const std::size_t first, std::vector<entry> &buffer) const {
+		if(num_auts.load(std::memory_order_acquire) == first) return first;
+		std::lock_guard<std::mutex> lock(m);
+		buffer.insert(buffer.end(), auts.begin() + first, auts.end());
+		return auts.size();
+	}
+public:
+	std::atomic<bool> done{false}; // all helper searches should stop
+private:
+	mutable std::mutex m;
+	std::vector<entry> auts;
+	std::atomic<std::size_t> num_auts{0};
+};
+
+// The view of a single search on the shared automorphisms, meant as instance data of a tree traversal.
+
+template<typename SizeType>
+struct concurrent_search_data {
+
+	// start following the given automorphisms, forgetting any from a previous search
+
+	void attach(shared_automorphisms<SizeType> *shared, const std::size_t id) {
+		this->shared = shared;
+		this->id = id;
+		num_fetched = 0;
+		fetched.clear();
+	}
+
+	template<typename State, typename Perm>
+	void publish(const State &state, const Perm &aut) {
+		if(shared) shared->publish(id, state.n, aut);
+	}
+
+	// report the automorphisms published by the other searches since the last call
+
+	template<typename State, typename TreeNode>
+	void report_new(State &state, TreeNode &t, const std::size_t tag) {
+		if(!shared) return;
+		num_fetched = shared->fetch(num_fetched, fetched);
+		for(const auto &e : fetched) {
+			if(e.owner == id) continue;
+			state.visitor.automorphism_implicit(state, t, e.aut, tag);
+		}
+		fetched.clear();
+	}
+public:
+	shared_automorphisms<SizeType> *shared = nullptr;
+	std::size_t id = 0; // 0 is the calling thread
+private:
+	std::size_t num_fetched = 0;
+	std::vector<typename shared_automorphisms<SizeType>::entry> fetched;
+};
+
+// Threads searching the same graph as a given state, each with its own canon_state.
+// The edge handler, the visitor, and the refined root partition are copied from the given state,
+// so no vertex predicate is needed for the helper states.
+// The helper states have the limits of the given state, so the node and leaf budgets apply to each state separately,
+// but they are cancelled by the done flag instead of the flag of the given state,
+// so a helper in the middle of a refinement stops shortly after any search sets it.
+
+template<typename State>
+struct helper_searches {
+	using SizeType = typename State::SizeType;
+	using Partition = typename State::Partition;
+	helper_searches(const helper_searches &) = delete;
+	helper_searches &operator=(const helper_searches &) = delete;
+public:
+
+	// f(helper_state, id) is called in each thread, with id from 1 to num_helpers
+
+	template<typename F>
+	helper_searches(State &state, const std::size_t num_helpers, shared_automorphisms<SizeType> &shared, F f)
+	: shared(shared), limits(state.get_limits()), errors(num_helpers) {
+		limits.cancel = &shared.done;
+		try {
+			for(std::size_t i = 0; i != num_helpers; ++i) {
+				threads.emplace_back([this, f, i, limits = this->limits, &g = state.g, idx = state.idx,
+						edge_handler = state.edge_handler, visitor = state.visitor, pi = Partition(state.root->pi)]() mutable {
+					try {
+						State h_state(g, idx, edge_handler, std::move(visitor), always_false(), std::move(pi), nullptr, limits);
+						f(h_state, i + 1);
+					} catch(...) {
+						errors[i] = std::current_exception();
+						this->shared.done = true;
+					}
+				});
+			}
+		} catch(...) {
+			stop();
+			throw;
+		}
+	}
+
+	~helper_searches() {
+		stop();
+	}
+
+	// the limits of the helper states, e.g., for a search in the calling thread
+
+	const resource_limits &get_limits() const {
+		return limits;
+	}
+
+	// wait for all helpers to finish, and rethrow the first exception thrown in a helper
+
+	void wait() {
+		for(auto &t : threads)
+			if(t.joinable()) t.join();
+		for(const auto &e : errors)
+			if(e) std::rethrow_exception(e);
+	}
+private:
+
+	void stop() {
+		shared.done = true;
+		for(auto &t : threads)
+			if(t.joinable()) t.join();
+	}
+private:
+	shared_automorphisms<SizeType> &shared;
+	resource_limits limits;
+	std::vector<std::exception_ptr> errors;
+	std::vector<std::thread> threads;
+};
+
+} // namespace detail
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_DETAIL_CONCURRENT_SEARCH_HPP */
@@ -1,6 +1,7 @@
 #ifndef GRAPH_CANON_DETAIL_FIXED_VECTOR_HPP
 #define GRAPH_CANON_DETAIL_FIXED_VECTOR_HPP
 
+#include <cstddef>
 #include <memory>
 
 namespace graph_canon {
@@ -14,8 +15,12 @@ struct fixed_vector {
 	fixed_vector(fixed_vector&&) = delete;
 	fixed_vector &operator=(fixed_vector&&) = delete;
 
+	// make room for n elements and clear, the storage is only reallocated when it must grow
 	void reset(std::size_t n) {
-		data.reset(new T[n]);
+		if(n > capacity || !data) {
+			data.reset(new T[n]);
+			capacity = n;
+		}
 		last = data.get();
 	}
 
@@ -31,6 +36,10 @@ struct fixed_vector {
 		return last;
 	}
 
+	std::size_t get_capacity() const {
+		return capacity;
+	}
+
 	template<typename ...Args>
 	void emplace_back(Args&&... args) {
 		*last = T(std::forward<Args>(args)...);
@@ -39,6 +48,7 @@ struct fixed_vector {
 private:
 	std::unique_ptr<T[] > data;
 	T *last = nullptr;
+	std::size_t capacity = 0;
 };
 
 } // namespace detail
@@ -0,0 +1,43 @@
+#ifndef GRAPH_CANON_DETAIL_FOR_EACH_NEIGHBOUR_HPP
+#define GRAPH_CANON_DETAIL_FOR_EACH_NEIGHBOUR_HPP
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/property_map/property_map.hpp>
+
+namespace graph_canon {
+namespace detail {
+
+// Iterates over the out-edges of a vertex whose target is not in a singleton cell.
+// Graph types with a faster way to find the neighbours specialise this, see csr_graph.hpp.
+
+template<typename Graph, typename IndexMap, typename Enable = void>
+struct neighbour_iteration {
+
+	template<typename State, typename TreeNode, typename Vertex, typename Callback>
+	static void for_each(const State &state, const TreeNode &node, const Vertex v, const Callback callback) {
+		const auto &pi = node.pi;
+		const auto *begin_cell_from_v_idx = pi.begin_cell_from_v_idx();
+		const auto *begin_cell_end = pi.begin_cell_end();
+		const auto oes = out_edges(v, state.g);
+		for(auto e_iter = oes.first; e_iter != oes.second; ++e_iter) {
+			const auto e_out = *e_iter;
+			const auto v_target = target(e_out, state.g);
+			const auto v_idx = get(state.idx, v_target);
+			const auto target_element_cell = begin_cell_from_v_idx[v_idx];
+			const auto target_element_cell_end = begin_cell_end[target_element_cell];
+			const bool is_singleton = target_element_cell + 1 == target_element_cell_end;
+			if(is_singleton) continue;
+			callback(e_out, v_idx, target_element_cell, target_element_cell_end);
+		}
+	}
+};
+
+template<typename State, typename TreeNode, typename Vertex, typename Callback>
+inline void for_each_neighbour(const State &state, const TreeNode &node, const Vertex v, const Callback callback) {
+	neighbour_iteration<typename State::Graph, typename State::IndexMap>::for_each(state, node, v, callback);
+}
+
+} // namespace detail
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_DETAIL_FOR_EACH_NEIGHBOUR_HPP */
@@ -42,16 +42,11 @@ template<typename Config, typename TreeNode>
 std::ostream &print(std::ostream &s,
 		const permuted_graph_view<Config, TreeNode> &pg,
 		const typename Config::Graph &g, typename Config::IndexMap idx) {
-	typedef typename boost::graph_traits<typename Config::Graph>::vertex_descriptor Vertex;
-	typedef typename boost::graph_traits<typename Config::Graph>::edge_descriptor Edge;
-
-	for(std::size_t v_idx = 0; v_idx < pg.n; v_idx++) {
-		s << v_idx << "(" << idx[pg.repr[v_idx].first] << "):";
-		const std::vector<Edge> &edges = pg.repr[v_idx].second;
-		for(std::size_t i_edge = 0; i_edge < edges.size(); i_edge++) {
-			Vertex v_tar = target(edges[i_edge], g);
-			s << " " << pg.pi->get_inverse(idx[v_tar]) << "(" << idx[v_tar] << ")";
-		}
+	const auto &pi = pg.get_node()->pi;
+	for(std::size_t v_idx = 0; v_idx < pi.get_num_cells(); v_idx++) {
+		s << v_idx << "(" << pi.get(v_idx) << "):";
+		for(auto iter = pg.get_targets_begin(v_idx); iter != pg.get_targets_end(v_idx); ++iter)
+			s << " " << *iter << "(" << pi.get(*iter) << ")";
 		s << '\n';
 	}
 	return s;
@@ -78,7 +73,7 @@ std::ostream &printTreeNodeName(std::ostream &s, const TreeNode &node) {
 			if(i >= parent->children.size()) {
 				s << "x"; // if the parent has not had its children initialised yet
 			} else {
-				s << parent->pi.get(i + parent->get_child_refiner_cell());
+				s << parent->get_child_element(i);
 			}
 			parent = n;
 		}
@@ -0,0 +1,49 @@
+#ifndef GRAPH_CANON_DETAIL_MEMORY_HPP
+#define GRAPH_CANON_DETAIL_MEMORY_HPP
+
+#include <graph_canon/detail/fixed_vector.hpp>
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+namespace graph_canon {
+namespace detail {
+
+// The number of bytes a container has allocated, not counting the container object itself,
+// which is accounted for wherever the container is stored.
+
+template<typename T, typename Alloc>
+std::size_t heap_bytes(const std::vector<T, Alloc> &v) {
+	return v.capacity() * sizeof(T);
+}
+
+template<typename Alloc>
+std::size_t heap_bytes(const std::vector<bool, Alloc> &v) {
+	return (v.capacity() + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+template<typename T, typename AllocInner, typename Alloc>
+std::size_t heap_bytes(const std::vector<std::vector<T, AllocInner>, Alloc> &v) {
+	std::size_t res = v.capacity() * sizeof(std::vector<T, AllocInner>);
+	for(const auto &inner : v) res += heap_bytes(inner);
+	return res;
+}
+
+template<typename T>
+std::size_t heap_bytes(const fixed_vector<T> &v) {
+	return v.get_capacity() * sizeof(T);
+}
+
+// An estimate of the bytes used by num_perms permutations of degree n stored as arrays,
+// for groups where the representation is not available.
+
+template<typename SizeType>
+std::size_t perm_bytes(std::size_t num_perms, std::size_t n) {
+	return num_perms * n * sizeof(SizeType);
+}
+
+} // namespace detail
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_DETAIL_MEMORY_HPP */
@@ -7,51 +7,154 @@
 // A[0] is the index of the first vertex of the second cell, A[A[0]], the index the first vertex of the third cell, and so on.
 // All A[i] = 0 for i not being the index of the first vertex of any cell.
 // A[i] = num_vertices for i being the index of the first vertex in the last cell.
+// The non-singleton cells are additionally kept in a doubly-linked list, in the order they appear in the partition,
+// so they can be enumerated without visiting the (eventually many) singleton cells.
+// The list is indexed by the first index of each cell, with index num_vertices being the list head.
 
 #include <graph_canon/config.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <vector>
 
 namespace graph_canon {
 namespace detail {
 
+template<typename SizeType>
+struct partition;
+
+template<typename SizeType>
+struct partition_trail;
+
 template<typename SizeType>
 struct partition {
+	friend struct partition_trail<SizeType>;
 
 	partition(SizeType n) // create unit partition
-	: n(n), elements(new SizeType[n]), inverse(new SizeType[n]),
-	next_cell_begin(new SizeType[n]), cell_from_v_idx(new SizeType[n]), num_cells(1) {
+	: partition(n, new SizeType[get_storage_size(n)], true) { }
+
+	partition(SizeType n, SizeType *storage) // create unit partition in storage owned by someone else
+	: partition(n, storage, false) { }
+
+	partition(partition &&other)
+	: n(other.n), elements(other.elements), inverse(other.inverse),
+	next_cell_begin(other.next_cell_begin), cell_from_v_idx(other.cell_from_v_idx),
+	next_non_singleton(other.next_non_singleton), prev_non_singleton(other.prev_non_singleton),
+	num_cells(other.num_cells), owns_storage(other.owns_storage), trail(other.trail) {
+		other.elements = nullptr;
+		other.owns_storage = false;
+	}
+
+	partition &operator=(partition &&other) {
+		if(this == &other) return *this;
+		release_storage();
+		n = other.n;
+		elements = other.elements;
+		inverse = other.inverse;
+		next_cell_begin = other.next_cell_begin;
+		cell_from_v_idx = other.cell_from_v_idx;
+		next_non_singleton = other.next_non_singleton;
+		prev_non_singleton = other.prev_non_singleton;
+		num_cells = other.num_cells;
+		owns_storage = other.owns_storage;
+		trail = other.trail;
+		other.elements = nullptr;
+		other.owns_storage = false;
+		return *this;
+	}
+
+	partition(const partition &other)
+	: partition(other, new SizeType[get_storage_size(other.n)], true) { }
+
+	partition(const partition &other, SizeType *storage) // copy into storage owned by someone else
+	: partition(other, storage, false) { }
+
+	~partition() {
+		release_storage();
+	}
+
+	// Create a partition equal to other, using the storage shared through the trail,
+	// with all writes recorded in the trail.
+	// The shared storage must currently represent the same partition as other.
+
+	static partition share(const partition &other, partition_trail<SizeType> &trail) {
+		partition pi(other.n, trail.pi.elements, other.num_cells, trail);
+		return pi;
+	}
+
+	partition_trail<SizeType> *get_trail() const {
+		return trail;
+	}
+
+	// the number of SizeType elements needed as storage for a partition of n elements
+
+	static std::size_t get_storage_size(SizeType n) {
+		return 6 * std::size_t(n) + 2;
+	}
+
+	// the number of bytes allocated by the partition itself, i.e., not given to it as storage
+
+	std::size_t get_owned_bytes() const {
+		return owns_storage ? get_storage_size(n) * sizeof(SizeType) : 0;
+	}
+private:
+
+	partition(SizeType n, SizeType *storage, bool owns_storage)
+	: n(n), elements(storage), inverse(storage + n),
+	next_cell_begin(storage + 2 * std::size_t(n)), cell_from_v_idx(storage + 3 * std::size_t(n)),
+	next_non_singleton(storage + 4 * std::size_t(n)), prev_non_singleton(storage + 5 * std::size_t(n) + 1),
+	num_cells(1), owns_storage(owns_storage) {
 		for(SizeType i = 0; i < n; i++)
 			put_element_on_index(i, i);
-		std::fill(next_cell_begin.get(), next_cell_begin.get() + n, 0);
-		std::fill(cell_from_v_idx.get(), cell_from_v_idx.get() + n, 0);
+		std::fill(next_cell_begin, next_cell_begin + n, 0);
+		std::fill(cell_from_v_idx, cell_from_v_idx + n, 0);
 		if(n != 0) {
 			next_cell_begin[0] = n;
 		} else {
 			num_cells = 0;
 		}
+		if(n > 1) {
+			next_non_singleton[n] = prev_non_singleton[n] = 0;
+			next_non_singleton[0] = prev_non_singleton[0] = n;
+		} else {
+			next_non_singleton[n] = prev_non_singleton[n] = n;
+		}
 	}
 
-	partition(partition&&) = default;
-	partition &operator=(partition&&) = default;
+	partition(SizeType n, SizeType *storage, SizeType num_cells, partition_trail<SizeType> &trail)
+	: n(n), elements(storage), inverse(storage + n),
+	next_cell_begin(storage + 2 * std::size_t(n)), cell_from_v_idx(storage + 3 * std::size_t(n)),
+	next_non_singleton(storage + 4 * std::size_t(n)), prev_non_singleton(storage + 5 * std::size_t(n) + 1),
+	num_cells(num_cells), owns_storage(false), trail(&trail) { }
+
+	partition(const partition &other, SizeType *storage, bool owns_storage)
+	: n(other.n), elements(storage), inverse(storage + n),
+	next_cell_begin(storage + 2 * std::size_t(n)), cell_from_v_idx(storage + 3 * std::size_t(n)),
+	next_non_singleton(storage + 4 * std::size_t(n)), prev_non_singleton(storage + 5 * std::size_t(n) + 1),
+	num_cells(other.num_cells), owns_storage(owns_storage) {
+		// all arrays are contiguous in both partitions
+		std::copy(other.elements, other.elements + get_storage_size(n), elements);
+	}
 
-	partition(const partition &other)
-	: n(other.n), elements(new SizeType[n]), inverse(new SizeType[n]),
-	next_cell_begin(new SizeType[n]), cell_from_v_idx(new SizeType[n]), num_cells(other.num_cells) {
-		std::copy(other.elements.get(), other.elements.get() + n, elements.get());
-		std::copy(other.inverse.get(), other.inverse.get() + n, inverse.get());
-		std::copy(other.next_cell_begin.get(), other.next_cell_begin.get() + n, next_cell_begin.get());
-		std::copy(other.cell_from_v_idx.get(), other.cell_from_v_idx.get() + n, cell_from_v_idx.get());
+	void write(SizeType *p, SizeType value) {
+		if(trail) trail->record(p);
+		*p = value;
+	}
+
+	void release_storage() {
+		if(owns_storage) delete[] elements;
+		elements = nullptr;
+		owns_storage = false;
 	}
+public:
 
 	SizeType *begin() {
-		return elements.get();
+		return elements;
 	}
 
 	const SizeType *begin() const {
-		return elements.get();
+		return elements;
 	}
 
 	SizeType *end() {
@@ -69,7 +172,7 @@ struct partition {
 public: // the inverse is generally not valid during refinement
 
 	const SizeType *begin_inverse() const {
-		return inverse.get();
+		return inverse;
 	}
 
 	const SizeType *end_inverse() const {
@@ -84,12 +187,20 @@ public: // the inverse is generally not valid during refinement
 		SizeType i = begin;
 		auto iter = this->begin() + i;
 		for(SizeType i = begin; i != end; ++i, ++iter)
-			inverse[*iter] = i;
+			write(inverse + *iter, i);
+	}
+
+	// must be called before elements in the range are overwritten directly through begin()
+
+	void trail_elements(SizeType begin, SizeType end) {
+		if(!trail) return;
+		for(SizeType i = begin; i != end; ++i)
+			trail->record(elements + i);
 	}
 public: // v_idx_to_cell
 
 	const SizeType *begin_cell_from_v_idx() const {
-		return cell_from_v_idx.get();
+		return cell_from_v_idx;
 	}
 
 	SizeType get_cell_from_v_idx(SizeType idx) const {
@@ -100,24 +211,24 @@ public: // v_idx_to_cell
 		const auto cell_end = get_cell_end(cell);
 		assert(cell_end != 0);
 		for(SizeType i = cell; i != cell_end; ++i)
-			cell_from_v_idx[elements[i]] = cell;
+			write(cell_from_v_idx + elements[i], cell);
 	}
 public:
 
 	void swap_elements(SizeType a, SizeType b) {
 		SizeType aElem = elements[a];
 		SizeType bElem = elements[b];
-		elements[a] = bElem;
-		elements[b] = aElem;
-		inverse[aElem] = b;
-		inverse[bElem] = a;
+		write(elements + a, bElem);
+		write(elements + b, aElem);
+		write(inverse + aElem, b);
+		write(inverse + bElem, a);
 	}
 	// it only updates elements and the index map, the user must take care that no duplicates are introduced
 	// during the use of the partition
 
 	void put_element_on_index(SizeType value, SizeType element_idx) {
-		elements[element_idx] = value;
-		inverse[value] = element_idx;
+		write(elements + element_idx, value);
+		write(inverse + value, element_idx);
 	}
 public:
 
@@ -127,7 +238,7 @@ public:
 
 	SizeType get_cell_end(SizeType cell_begin) const {
 #ifdef BOOST_GRAPH_CANON_CHECK_PARTITION
-		assert(cell_begin < elements.size());
+		assert(cell_begin < n);
 		assert(next_cell_begin[cell_begin] != 0);
 		assert(next_cell_begin[cell_begin] != cell_begin);
 #endif
@@ -139,7 +250,22 @@ public:
 	}
 
 	const SizeType *begin_cell_end() const {
-		return next_cell_begin.get();
+		return next_cell_begin;
+	}
+
+	// the first index of the first non-singleton cell, or n if the partition is discrete
+
+	SizeType get_first_non_singleton() const {
+		return next_non_singleton[n];
+	}
+
+	// the first index of the non-singleton cell following the non-singleton cell starting at cell_begin, or n
+
+	SizeType get_next_non_singleton(SizeType cell_begin) const {
+#ifdef BOOST_GRAPH_CANON_CHECK_PARTITION
+		assert(get_cell_size(cell_begin) > 1);
+#endif
+		return next_non_singleton[cell_begin];
 	}
 public:
 
@@ -147,8 +273,13 @@ public:
 		friend struct partition;
 
 		cell_splitter(partition<SizeType> &pi, SizeType cell_begin, SizeType cell_end)
-		: pi(pi), cell_begin(cell_begin), cell_end(cell_end) {
+		: pi(pi), cell_begin(cell_begin), cell_end(cell_end), first_cell_begin(cell_begin) {
 			assert(cell_begin < cell_end);
+			// the links are only valid for non-singleton cells, but singletons are never split
+			if(cell_end - cell_begin > 1) {
+				prev_non_singleton = pi.prev_non_singleton[cell_begin];
+				next_non_singleton = pi.next_non_singleton[cell_begin];
+			}
 		}
 
 	public:
@@ -157,18 +288,36 @@ public:
 			assert(new_cell > cell_begin);
 			assert(new_cell < cell_end);
 			assert(pi.next_cell_begin[new_cell] == 0);
-			pi.next_cell_begin[cell_begin] = new_cell;
+			pi.write(pi.next_cell_begin + cell_begin, new_cell);
+			link_if_non_singleton(new_cell);
 			cell_begin = new_cell;
 			++pi.num_cells;
 		}
 
 		~cell_splitter() {
-			pi.next_cell_begin[cell_begin] = cell_end;
+			pi.write(pi.next_cell_begin + cell_begin, cell_end);
+			if(cell_begin == first_cell_begin) return; // no splits, the list is unchanged
+			link_if_non_singleton(cell_end);
+			pi.write(pi.next_non_singleton + prev_non_singleton, next_non_singleton);
+			pi.write(pi.prev_non_singleton + next_non_singleton, prev_non_singleton);
+		}
+	private:
+
+		// the current cell ends at cell_end, and takes the place of the original cell in the list if it is not a singleton
+
+		void link_if_non_singleton(SizeType cell_end) {
+			if(cell_end - cell_begin == 1) return;
+			pi.write(pi.next_non_singleton + prev_non_singleton, cell_begin);
+			pi.write(pi.prev_non_singleton + cell_begin, prev_non_singleton);
+			prev_non_singleton = cell_begin;
 		}
 	private:
 		partition<SizeType> &pi;
 		SizeType cell_begin;
 		const SizeType cell_end;
+		const SizeType first_cell_begin;
+		// the non-singleton cells around the cell being split
+		SizeType prev_non_singleton, next_non_singleton;
 	};
 	friend class cell_splitter;
 
@@ -192,14 +341,81 @@ public:
 			assert(checkA[i]);
 			assert(checkB[i]);
 		}
+		// the list of non-singleton cells must be exactly those cells, in order
+		SizeType non_singleton = n;
+		for(SizeType cell = 0; cell != n; cell = get_cell_end(cell)) {
+			if(get_cell_size(cell) == 1) continue;
+			assert(next_non_singleton[non_singleton] == cell);
+			assert(prev_non_singleton[cell] == non_singleton);
+			non_singleton = cell;
+		}
+		assert(next_non_singleton[non_singleton] == n);
+		assert(prev_non_singleton[n] == non_singleton);
 	}
 private:
 	SizeType n;
-	std::unique_ptr<SizeType[] > elements;
-	std::unique_ptr<SizeType[] > inverse;
-	std::unique_ptr<SizeType[] > next_cell_begin;
-	std::unique_ptr<SizeType[] > cell_from_v_idx;
+	// all arrays are stored in a single block of get_storage_size(n) elements, starting at elements
+	SizeType *elements;
+	SizeType *inverse;
+	SizeType *next_cell_begin;
+	SizeType *cell_from_v_idx;
+	SizeType *next_non_singleton; // n + 1 entries, the last being the list head
+	SizeType *prev_non_singleton; // n + 1 entries, the last being the list head
 	SizeType num_cells;
+	bool owns_storage;
+	partition_trail<SizeType> *trail = nullptr; // set if the storage is shared along a path of tree nodes
+};
+
+// A partition_trail is an undo log for a partition whose storage is shared by all tree nodes on a path.
+// The trail owns a copy of the partition of the root, whose storage is then shared by all other nodes.
+// Each tree node on the path opens a frame, and all writes done to the shared arrays
+// while the frame is open are recorded, at most once per array entry.
+// Backtracking to a node is then done by undoing the writes of all frames opened after it.
+
+template<typename SizeType>
+struct partition_trail {
+	friend struct partition<SizeType>;
+
+	partition_trail(const partition<SizeType> &pi_root)
+	: pi(pi_root), stamps(partition<SizeType>::get_storage_size(pi.n), 0) { }
+
+	// returns the mark to undo to for removing the writes of the new frame, and all later frames
+
+	std::size_t open_frame() {
+		++frame;
+		return entries.size();
+	}
+
+	void undo(std::size_t mark) {
+		assert(mark <= entries.size());
+		for(auto iter = entries.end(); iter != entries.begin() + mark;) {
+			--iter;
+			*iter->p = iter->old;
+		}
+		entries.resize(mark);
+	}
+
+	void record(SizeType *p) {
+		auto &stamp = stamps[p - pi.elements];
+		if(stamp == frame) return;
+		stamp = frame;
+		entries.push_back(entry{p, *p});
+	}
+
+	std::size_t size() const {
+		return entries.size();
+	}
+private:
+
+	struct entry {
+		SizeType *p;
+		SizeType old;
+	};
+private:
+	partition<SizeType> pi; // the shared storage
+	std::vector<std::size_t> stamps; // the frame which last recorded each entry
+	std::vector<entry> entries;
+	std::size_t frame = 0;
 };
 
 } // namespace detail
@@ -1,14 +1,76 @@
 #ifndef GRAPH_CANON_PERMUTED_GRAPH_VIEW_HPP
 #define GRAPH_CANON_PERMUTED_GRAPH_VIEW_HPP
 
+#include <graph_canon/detail/memory.hpp>
 #include <graph_canon/detail/partition.hpp>
 
 #include <boost/graph/graph_traits.hpp>
-#include <boost/graph/iteration_macros.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
 namespace graph_canon {
 namespace detail {
 
+// Lexicographically compare two arrays of integers.
+// Equal blocks are skipped with memcmp, so only the first differing block is compared element by element.
+
+template<typename T>
+long long compare_flat(const T *first1, const T *first2, const std::size_t size) {
+	static_assert(std::is_integral<T>::value, "memcmp is only used for testing equality of integers.");
+	constexpr std::size_t block_size = 64;
+	std::size_t i = 0;
+	while(i + block_size <= size && std::memcmp(first1 + i, first2 + i, block_size * sizeof(T)) == 0)
+		i += block_size;
+	const auto m = std::mismatch(first1 + i, first1 + size, first2 + i);
+	if(m.first == first1 + size) return 0;
+	return static_cast<long long> (*m.first) - static_cast<long long> (*m.second);
+}
+
+// The finalizer of splitmix64.
+
+inline std::uint64_t mix64(std::uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+// A hash of the graph permuted by the discrete partition pi, i.e., it only depends on the positions of the vertices.
+// The terms of the vertices and their neighbours are summed, so the graph can be traversed in any order.
+// Edge labels are not included, as the edge handler can only compare edges.
+
+template<typename State, typename Partition>
+std::uint64_t hash_permuted_graph(const State &state, const Partition &pi) {
+	const auto &g = state.g;
+	const auto &idx = state.idx;
+	std::uint64_t hash = mix64(state.n);
+	const auto vs = vertices(g);
+	for(auto v_iter = vs.first; v_iter != vs.second; ++v_iter) {
+		const auto v = *v_iter;
+		std::uint64_t neighbours = 0;
+		const auto oes = out_edges(v, g);
+		for(auto e_iter = oes.first; e_iter != oes.second; ++e_iter)
+			neighbours += mix64(pi.get_inverse(get(idx, target(*e_iter, g))));
+		hash += mix64(neighbours ^ mix64(pi.get_inverse(get(idx, v)) + 0x9e3779b97f4a7c15ull));
+	}
+	return hash;
+}
+
+// The graph permuted by the discrete partition of a leaf, in compressed sparse row format.
+// The neighbours of the vertex at position v_idx are given by their positions in
+// targets[offsets[v_idx]] to targets[offsets[v_idx + 1] - 1], in ascending order,
+// and edges holds the corresponding edge descriptors for the edge handler.
+// Views are ordered first by their offsets (i.e., the degree sequences), then by their targets,
+// and finally by their edges according to the edge handler.
+
 template<typename Config, typename TreeNode>
 struct permuted_graph_view {
 	using Graph = typename Config::Graph;
@@ -17,133 +79,120 @@ struct permuted_graph_view {
 	using Vertex = typename boost::graph_traits<Graph>::vertex_descriptor;
 	using Edge = typename boost::graph_traits<Graph>::edge_descriptor;
 
-	struct Adj {
-		Vertex v;
-		SizeType out_degree;
-		Edge *out_edges;
-	};
-
 	template<typename State>
-	struct edge_less {
+	permuted_graph_view(const State &state, const typename TreeNode::OwnerPtr &leaf_node)
+			: n(state.n), offsets(state.n + 1), next_pos(state.n) {
+		build(state, leaf_node);
+	}
 
-		edge_less(const State &state, const partition <SizeType> &pi) : state(state), begin_inverse(pi.begin_inverse()) {}
+	// reuses the buffers of the view
+	template<typename State>
+	void repermute(const State &state, const typename TreeNode::OwnerPtr &leaf_node_new) {
+		build(state, leaf_node_new);
+	}
 
-		bool operator()(const Edge &lhs, const Edge &rhs) const {
-			const Graph &g = state.g;
-			const IndexMap &idx = state.idx;
-			if(begin_inverse[get(idx, target(lhs, g))]
-				!= begin_inverse[get(idx, target(rhs, g))])
-				return begin_inverse[get(idx, target(lhs, g))] < begin_inverse[get(idx, target(rhs, g))];
-			return state.edge_handler.compare(state, lhs, rhs) < 0;
+	template<typename State>
+	static long long compare(const State &state,
+									 const permuted_graph_view<Config, typename State::TreeNode> &g1,
+									 const permuted_graph_view<Config, typename State::TreeNode> &g2) {
+		assert(g1.n == g2.n);
+		const auto offsets_diff = compare_flat(g1.offsets.data(), g2.offsets.data(), g1.offsets.size());
+		if(offsets_diff != 0) return offsets_diff;
+		assert(g1.targets.size() == g2.targets.size());
+		const auto targets_diff = compare_flat(g1.targets.data(), g2.targets.data(), g1.targets.size());
+		if(targets_diff != 0) return targets_diff;
+		for(std::size_t i = 0; i < g1.edges.size(); ++i) {
+			const auto edge_diff = state.edge_handler.compare(state, g1.edges[i], g2.edges[i]);
+			if(edge_diff != 0) return edge_diff;
 		}
+		return 0;
+	}
+
+	typename TreeNode::OwnerPtr get_node() const {
+		return leaf_node;
+	}
 
-	private:
-		const State &state;
-		const SizeType *begin_inverse;
-	};
+	// the view itself and its buffers
+
+	std::size_t get_memory_usage() const {
+		return sizeof(*this) + heap_bytes(offsets) + heap_bytes(targets) + heap_bytes(edges) + heap_bytes(next_pos);
+	}
+
+	const SizeType *get_targets_begin(SizeType v_idx) const {
+		return targets.data() + offsets[v_idx];
+	}
+
+	const SizeType *get_targets_end(SizeType v_idx) const {
+		return targets.data() + offsets[v_idx + 1];
+	}
+private:
 
 	template<typename State>
-	permuted_graph_view(const State &state, const typename TreeNode::OwnerPtr &leaf_node)
-			: leaf_node(leaf_node), n(state.n), repr(new Adj[n]), extra_repr(nullptr) {
+	void build(const State &state, const typename TreeNode::OwnerPtr &leaf_node_new) {
+		leaf_node = leaf_node_new;
 		const auto &pi = leaf_node->pi;
 		const Graph &g = state.g;
 		const IndexMap &idx = state.idx;
 		assert(pi.get_num_cells() == state.n);
 
-		edge_less<State> less(state, pi);
-
+		offsets[0] = 0;
 		const auto vs = vertices(g);
 		for(auto v_iter = vs.first; v_iter != vs.second; ++v_iter) {
 			const auto v = *v_iter;
-			const auto v_idx = pi.get_inverse(get(idx, v));
-
-			repr[v_idx].v = v;
-			const auto d = repr[v_idx].out_degree = out_degree(v, g);
-			Edge *edges = repr[v_idx].out_edges = new Edge[d];
-			SizeType i = 0;
-
-			const auto oes = out_edges(v, g);
+			offsets[pi.get_inverse(get(idx, v)) + 1] = out_degree(v, g);
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		targets.resize(offsets[n]);
+		edges.resize(offsets[n]);
+
+		// A counting sort by target position: visit the vertices in order of their position,
+		// and append that position to the list of each neighbour.
+		// The graph is undirected, so each out-edge is also the half-edge back from the neighbour.
+		std::copy(offsets.begin(), offsets.end() - 1, next_pos.begin());
+		for(SizeType t = 0; t < n; ++t) {
+			const auto w = vertex(pi.get(t), g);
+			const auto oes = out_edges(w, g);
 			for(auto e_iter = oes.first; e_iter != oes.second; ++e_iter) {
-				const auto e_out = *e_iter;
-				edges[i] = e_out;
-				++i;
+				const auto e = *e_iter;
+				const auto pos = next_pos[pi.get_inverse(get(idx, target(e, g)))]++;
+				targets[pos] = t;
+				edges[pos] = e;
 			}
-			std::sort(edges, edges + d, less);
 		}
+		assert(std::equal(next_pos.begin(), next_pos.end(), offsets.begin() + 1));
+		sort_equal_targets(state, std::integral_constant<bool, Config::ParallelEdges || Config::Loops>());
 	}
 
 	template<typename State>
-	void repermute(const State &state, const typename TreeNode::OwnerPtr &leaf_node_new) {
-		const auto &pi = leaf_node->pi;
-		const auto &pi_new = leaf_node_new->pi;
-		if(!extra_repr) extra_repr = new Adj[n];
-		edge_less<State> less(state, pi_new);
-		// copy each element of repr to extra_repr using the new index
-		// also sort all the out_edges again
-		for(SizeType v_id_old = 0; v_id_old < n; v_id_old++) {
-			const auto v_id = pi.get(v_id_old);
-			const auto v_id_new = pi_new.get_inverse(v_id);
-			extra_repr[v_id_new] = repr[v_id_old];
-
-			Edge *edges = extra_repr[v_id_new].out_edges;
-			std::sort(edges, edges + extra_repr[v_id_new].out_degree, less);
-		}
-		std::swap(repr, extra_repr);
-		leaf_node = leaf_node_new;
-	}
-
-	~permuted_graph_view() {
-		if(repr) {
-			for(SizeType i = 0; i < n; i++)
-				delete[] repr[i].out_edges;
-		}
-		delete[] repr;
-		delete[] extra_repr;
-	}
+	void sort_equal_targets(const State &state, std::false_type) { }
 
 	template<typename State>
-	static long long compare(const State &state,
-									 const permuted_graph_view<Config, typename State::TreeNode> &g1,
-									 const permuted_graph_view<Config, typename State::TreeNode> &g2) {
-		const Graph &g = state.g;
-		const IndexMap &idx = state.idx;
-		assert(g1.n == g2.n);
-		for(SizeType v_idx = 0; v_idx < g1.n; ++v_idx) {
-			const Adj &adj1 = g1.repr[v_idx];
-			const Adj &adj2 = g2.repr[v_idx];
-			if(adj1.out_degree != adj2.out_degree) {
-				return (adj1.out_degree) - (adj2.out_degree);
-			}
-			const Edge *edges1 = adj1.out_edges;
-			const Edge *edges2 = adj2.out_edges;
-			for(SizeType e_id = 0; e_id < adj1.out_degree; e_id++) {
-				const Edge e1 = edges1[e_id];
-				const Edge e2 = edges2[e_id];
-				const Vertex v1 = target(e1, g);
-				const Vertex v2 = target(e2, g);
-				const auto v_tar_idx1 = g1.leaf_node->pi.get_inverse(get(idx, v1));
-				const auto v_tar_idx2 = g2.leaf_node->pi.get_inverse(get(idx, v2));
-				if(v_tar_idx1 != v_tar_idx2)
-					return v_tar_idx1 - v_tar_idx2;
-				auto eDiff = state.edge_handler.compare(state, e1, e2);
-				if(eDiff != 0) return eDiff;
+	void sort_equal_targets(const State &state, std::true_type) {
+		// order the edges of each run of equal targets by the edge handler
+		const auto edge_less = [&state](const Edge &lhs, const Edge &rhs) {
+			return state.edge_handler.compare(state, lhs, rhs) < 0;
+		};
+		for(SizeType v_idx = 0; v_idx < n; ++v_idx) {
+			const std::size_t last = offsets[v_idx + 1];
+			for(std::size_t first = offsets[v_idx]; first != last;) {
+				std::size_t run_end = first + 1;
+				while(run_end != last && targets[run_end] == targets[first]) ++run_end;
+				if(run_end - first > 1)
+					std::sort(edges.begin() + first, edges.begin() + run_end, edge_less);
+				first = run_end;
 			}
 		}
-		return 0;
 	}
-
-	typename TreeNode::OwnerPtr get_node() const {
-		return leaf_node;
-	}
-
 private:
 	typename TreeNode::OwnerPtr leaf_node;
 	SizeType n;
-	Adj *repr;
-	Adj *extra_repr;
+	std::vector<std::size_t> offsets;
+	std::vector<SizeType> targets;
+	std::vector<Edge> edges;
+	std::vector<std::size_t> next_pos; // scratch space for the counting sort
 };
 
 } // namespace detail
 } // namespace graph_canon
 
-#endif /* GRAPH_CANON_PERMUTED_GRAPH_VIEW_HPP */
\ No newline at end of file
+#endif /* GRAPH_CANON_PERMUTED_GRAPH_VIEW_HPP */
@@ -1,11 +1,14 @@
 #ifndef GRAPH_CANON_TREE_NODE_HPP
 #define GRAPH_CANON_TREE_NODE_HPP
 
+#include <graph_canon/detail/memory.hpp>
 #include <graph_canon/detail/partition.hpp>
 
 #include <boost/intrusive_ptr.hpp>
 
 #include <cassert>
+#include <cstddef>
+#include <new>
 
 namespace graph_canon {
 namespace detail {
@@ -23,9 +26,11 @@ struct tree_node {
 private:
 
 	template<typename State>
-	tree_node(Self *parent, Partition &&pi_not_equitable, State &state)
+	tree_node(Self *parent, SizeType child_offset, bool has_partition_storage, Partition &&pi_not_equitable, State &state)
 	: ref_count(0), parent(parent), level(parent ? parent->level + 1 : 0),
-	pi(std::move(pi_not_equitable)), child_refiner_cell(state.n), is_pruned(false), data(state) {
+	pi(std::move(pi_not_equitable)), child_offset(child_offset), child_refiner_cell(state.n),
+	is_pruned(false), has_partition_storage(has_partition_storage), data(state) {
+		state.count_tree_node();
 		bool isCandidate = state.visitor.tree_create_node_begin(state, *this);
 		if(isCandidate) {
 			isCandidate = state.make_equitable(*this);
@@ -34,6 +39,9 @@ private:
 				assert(child_refiner_cell != state.n);
 				children.resize(pi.get_cell_size(child_refiner_cell), nullptr);
 				child_pruned.resize(children.size(), false);
+				// descendants will overwrite pi, so remember the elements defining our children
+				if(pi.get_trail())
+					child_elements.assign(pi.begin() + child_refiner_cell, pi.begin() + child_refiner_cell + children.size());
 			}
 		} else {
 			state.visitor.refine_abort(state, *this);
@@ -45,20 +53,16 @@ private:
 			is_pruned = true;
 			state.visitor.refine_abort(state, *this);
 		}
-		if(is_pruned) assert(get_parent());
+		if(is_pruned) assert(get_parent() || state.is_stopped());
+		state.update_memory(*this);
 	}
 
 	~tree_node() {
 		data.state.visitor.tree_destroy_node(data.state, *this);
+		data.state.replace_memory(memory_bytes, 0);
 		for(SizeType i = 0; i < children.size(); i++) assert(!children[i]);
 		if(!parent) return;
-		// first find our index into our parent's child list
-		const SizeType ind_idx = parent->get_child_individualized_position();
-		const SizeType ind_element = pi.get(ind_idx);
-		const SizeType ind_element_idx = parent->pi.get_inverse(ind_element);
-		assert(ind_element_idx >= parent->get_child_refiner_cell());
-		assert(ind_element_idx <= ind_idx);
-		const SizeType child_offset = ind_element_idx - parent->get_child_refiner_cell();
+		assert(child_offset < parent->children.size());
 		// mark it pruned, and set it null
 		parent->child_pruned[child_offset] = true;
 		parent->children[child_offset] = nullptr;
@@ -66,14 +70,63 @@ private:
 public:
 
 	template<typename State>
-	static OwnerPtr make(Self *parent, Partition &&pi_not_equitable, State &state) {
-		return OwnerPtr(new Self(parent, std::move(pi_not_equitable), state));
+	static OwnerPtr make(Partition &&pi_not_equitable, State &state) {
+		void *block = state.node_allocator.allocate(get_block_size(0));
+		return construct(block, nullptr, 0, false, std::move(pi_not_equitable), state);
+	}
+
+	// Each node is allocated as a single block from the state's node allocator:
+	// the node itself, followed by the storage for the arrays of its partition.
+	// The root and nodes sharing their partition through a trail only need the node itself.
+
+	static std::size_t get_block_size(SizeType n) {
+		return get_partition_offset() + Partition::get_storage_size(n) * sizeof(SizeType);
 	}
+private:
+
+	static std::size_t get_partition_offset() {
+		return (sizeof(Self) + alignof(SizeType) - 1) / alignof(SizeType) * alignof(SizeType);
+	}
+
+	static SizeType *get_partition_storage(void *block) {
+		return reinterpret_cast<SizeType*> (static_cast<char*> (block) + get_partition_offset());
+	}
+
+	// Deallocates a block unless it has been released to construct, which then owns it.
+
+	template<typename Allocator>
+	struct block_guard {
+		block_guard(Allocator &allocator, void *block, std::size_t size) : allocator(allocator), block(block), size(size) { }
+
+		block_guard(const block_guard&) = delete;
+		block_guard &operator=(const block_guard&) = delete;
+
+		~block_guard() {
+			if(block) allocator.deallocate(block, size);
+		}
+
+		void *release() {
+			void *res = block;
+			block = nullptr;
+			return res;
+		}
+	private:
+		Allocator &allocator;
+		void *block;
+		const std::size_t size;
+	};
 
 	template<typename State>
-	static OwnerPtr make(Partition &&pi_not_equitable, State &state) {
-		return OwnerPtr(new Self(nullptr, std::move(pi_not_equitable), state));
+	static OwnerPtr construct(void *block, Self *parent, SizeType child_offset, bool has_partition_storage,
+			Partition &&pi_not_equitable, State &state) {
+		try {
+			return OwnerPtr(new(block) Self(parent, child_offset, has_partition_storage, std::move(pi_not_equitable), state));
+		} catch(...) {
+			state.node_allocator.deallocate(block, get_block_size(has_partition_storage ? state.n : 0));
+			throw;
+		}
 	}
+public:
 
 	Self *get_parent() {
 		return parent.get();
@@ -88,7 +141,23 @@ public:
 	}
 
 	SizeType get_child_individualized_position() const {
-		return pi.get_cell_end(child_refiner_cell) - 1;
+		// the target cell is split in all descendants, so don't look at pi
+		assert(!children.empty());
+		return child_refiner_cell + children.size() - 1;
+	}
+
+	// the index of this node in the children of the parent
+
+	SizeType get_child_offset() const {
+		return child_offset;
+	}
+
+	// the element individualised to create the child with the given index
+
+	SizeType get_child_element(SizeType child_idx) const {
+		assert(child_idx < children.size());
+		if(!child_elements.empty()) return child_elements[child_idx];
+		else return pi.get(child_refiner_cell + child_idx);
 	}
 
 	bool get_is_pruned() const {
@@ -97,20 +166,70 @@ public:
 
 	template<typename State>
 	OwnerPtr create_child(std::size_t element_idx_to_individualise, State &state) {
+		return create_child_impl(element_idx_to_individualise, state, true, [this](void *block) {
+			return Partition(pi, get_partition_storage(block));
+		});
+	}
+
+	// Create the child in the partition shared through the trail, which must currently represent our partition.
+	// A new frame must have been opened in the trail, for undoing the changes of the child.
+
+	template<typename State>
+	OwnerPtr create_child(std::size_t element_idx_to_individualise, State &state, partition_trail<SizeType> &trail) {
+		return create_child_impl(element_idx_to_individualise, state, false, [this, &trail](void *block) {
+			return Partition::share(pi, trail);
+		});
+	}
+
+	// Give the node its own copy of a partition shared through a trail, e.g., before it is reported as a leaf.
+
+	void detach_partition() {
+		if(pi.get_trail()) pi = Partition(pi);
+	}
+
+	// Replace a partition shared through a trail by an empty partition, before the trail is destroyed.
+	// The shared storage no longer represents the partition of the node, so there is nothing to keep,
+	// but the elements of the target cell are still available through get_child_element.
+
+	void release_shared_partition() {
+		if(pi.get_trail()) pi = Partition(0);
+	}
+
+	// Recompute the bytes used by the node and replace its previous amount in the accounting of the state.
+	// Use canon_state::update_memory instead, which also updates the instance data.
+
+	template<typename State>
+	void update_memory(State &state) {
+		const std::size_t bytes = get_block_size(has_partition_storage ? state.n : 0) + pi.get_owned_bytes()
+				+ heap_bytes(children) + heap_bytes(child_pruned) + heap_bytes(child_elements)
+				+ state.visitor.memory_tree_node(state, *this);
+		state.replace_memory(memory_bytes, bytes);
+		memory_bytes = bytes;
+	}
+private:
+
+	template<typename State, typename MakePartition>
+	OwnerPtr create_child_impl(std::size_t element_idx_to_individualise, State &state,
+			bool has_partition_storage, MakePartition make_partition) {
 		SizeType child_idx = element_idx_to_individualise - child_refiner_cell;
 		assert(child_idx < children.size());
 		assert(!children[child_idx]);
 		assert(!child_pruned[child_idx]);
+		// the child is not pruned, the traversal will stop at its next check of the limits
+		if(!state.reserve_tree_node()) return nullptr;
 		state.visitor.tree_create_child(state, *this, element_idx_to_individualise);
 
 		assert(element_idx_to_individualise < state.n);
 		assert(child_refiner_cell < state.n);
 		assert(element_idx_to_individualise >= child_refiner_cell);
-		assert(element_idx_to_individualise < pi.get_cell_end(child_refiner_cell));
+		assert(element_idx_to_individualise <= get_child_individualized_position());
 
-		Partition pi_child(pi);
+		const std::size_t block_size = get_block_size(has_partition_storage ? state.n : 0);
+		void *block = state.node_allocator.allocate(block_size);
+		block_guard<typename State::NodeAlloc> guard(state.node_allocator, block, block_size);
+		Partition pi_child = make_partition(block);
 		// swap the vertex to be individualised up to the end
-		const auto ind_pos = pi.get_cell_end(child_refiner_cell) - 1;
+		const auto ind_pos = get_child_individualized_position();
 		pi_child.swap_elements(ind_pos, element_idx_to_individualise);
 		{ // and split the cell
 			auto raii_splitter = pi_child.split_cell(child_refiner_cell);
@@ -118,7 +237,7 @@ public:
 		}
 		pi_child.set_cell_from_v_idx(ind_pos);
 
-		OwnerPtr childPtr = make(this, std::move(pi_child), state);
+		OwnerPtr childPtr = construct(guard.release(), this, child_idx, has_partition_storage, std::move(pi_child), state);
 		assert(childPtr);
 		if(childPtr->get_is_pruned()) {
 			child_pruned[child_idx] = true;
@@ -128,6 +247,7 @@ public:
 			return childPtr;
 		}
 	}
+public:
 
 	template<typename State>
 	void prune_subtree(State &state, const bool allow_canon_leaf_pruning = false) {
@@ -161,7 +281,11 @@ public:
 	friend void intrusive_ptr_release(Self *t) {
 		assert(t->ref_count > 0);
 		--t->ref_count;
-		if(t->ref_count == 0) delete t;
+		if(t->ref_count != 0) return;
+		auto &state = t->data.state;
+		const std::size_t size = get_block_size(t->has_partition_storage ? state.n : 0);
+		t->~Self();
+		state.node_allocator.deallocate(t, size);
 	}
 public: // for debugging
 
@@ -179,8 +303,12 @@ public:
 	std::vector<Self*> children; // a nullptr child just means it hasn't been explored yet
 	std::vector<bool> child_pruned;
 private:
+	SizeType child_offset; // our index in the children of our parent
 	SizeType child_refiner_cell; // the cell in the partition which defines the children of the node
+	std::vector<SizeType> child_elements; // only used when pi is or was shared through a trail
 	bool is_pruned;
+	bool has_partition_storage; // whether pi is stored in the same block as the node
+	std::size_t memory_bytes = 0; // as last accounted in the state
 public:
 	Data data;
 };
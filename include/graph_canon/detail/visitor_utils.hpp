@@ -1,6 +1,7 @@
 #ifndef GRAPH_CANON_DETAIL_VISITOR_UTILS_HPP
 #define GRAPH_CANON_DETAIL_VISITOR_UTILS_HPP
 
+#include <graph_canon/detail/for_each_neighbour.hpp>
 #include <graph_canon/detail/meta.hpp>
 
 #include <boost/ref.hpp>
@@ -8,24 +9,6 @@
 namespace graph_canon {
 namespace detail {
 
-template<typename State, typename TreeNode, typename Vertex, typename Callback>
-inline void for_each_neighbour(const State &state, const TreeNode &node, const Vertex v, const Callback callback) {
-	const auto &pi = node.pi;
-	const auto *begin_cell_from_v_idx = pi.begin_cell_from_v_idx();
-	const auto *begin_cell_end = pi.begin_cell_end();
-	const auto oes = out_edges(v, state.g);
-	for(auto e_iter = oes.first; e_iter != oes.second; ++e_iter) {
-		const auto e_out = *e_iter;
-		const auto v_target = target(e_out, state.g);
-		const auto v_idx = get(state.idx, v_target);
-		const auto target_element_cell = begin_cell_from_v_idx[v_idx];
-		const auto target_element_cell_end = begin_cell_end[target_element_cell];
-		const bool is_singleton = target_element_cell + 1 == target_element_cell_end;
-		if(is_singleton) continue;
-		callback(e_out, v_idx, target_element_cell, target_element_cell_end);
-	}
-}
-
 // extract result
 // -----------------------------------------------------------------------------
 
@@ -4,6 +4,7 @@
 #include <graph_canon/sorting_utils.hpp>
 
 #include <algorithm>
+#include <type_traits>
 #include <vector>
 
 namespace graph_canon {
@@ -17,6 +18,7 @@ namespace graph_canon {
 template<typename SizeType>
 struct edge_handler_all_equal_impl {
 	static constexpr SizeType Max = 256;
+	using supports_partition_trail = std::true_type;
 
 	template<typename State>
 	void initialize(const State &state) { }
@@ -89,6 +91,7 @@ private:
 			else return do_sort(sorter);
 		}
 		// fallback, just sort
+		pi.trail_elements(idx_first, idx_last);
 		std::sort(first, last, [&counters](const auto a, const auto b) {
 			return counters[a] < counters[b];
 		});
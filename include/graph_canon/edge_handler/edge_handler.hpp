@@ -1,6 +1,8 @@
 #ifndef GRAPH_CANON_EDGE_HANDLER_EDGE_HANDLER_HPP
 #define GRAPH_CANON_EDGE_HANDLER_EDGE_HANDLER_HPP
 
+#include <type_traits>
+
 namespace graph_canon {
 
 // rst: .. concept:: template<typename T> EdgeHandlerCreator
@@ -55,9 +57,32 @@ namespace graph_canon {
 // rst: 	  but may also be used by visitors.
 // rst:		  Note that the function should not compare the end-points, only auxiliary data.
 // rst:
+// rst:		.. assoc_types::
+// rst:
+// rst:		.. type:: T::supports_partition_trail
+// rst:
+// rst:			Optional. If it is `std::true_type`, the handler declares that it only writes to a partition
+// rst:			through its member functions, or calls `trail_elements` before writing directly through `begin()`.
+// rst:			It is required by `traversal_dfs_trail`, which otherwise can not undo the writes.
+// rst:
 // rst:		.. todo:: List requirements from the WL-1 refiner.
 // rst:
 
+// rst: .. class:: template<typename EdgeHandler> \
+// rst:            edge_handler_supports_partition_trail
+// rst:
+// rst:		Derives from `EdgeHandler::supports_partition_trail` if it exists, and otherwise from `std::false_type`.
+// rst:
+
+template<typename EdgeHandler, typename = void>
+struct edge_handler_supports_partition_trail : std::false_type {
+};
+
+template<typename EdgeHandler>
+struct edge_handler_supports_partition_trail<EdgeHandler, std::void_t<typename EdgeHandler::supports_partition_trail> >
+: EdgeHandler::supports_partition_trail {
+};
+
 } // namespace graph_canon
 
 #endif /* GRAPH_CANON_EDGE_HANDLER_EDGE_HANDLER_HPP */
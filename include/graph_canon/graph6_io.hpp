@@ -0,0 +1,458 @@
+#ifndef GRAPH_CANON_GRAPH6_IO_HPP
+#define GRAPH_CANON_GRAPH6_IO_HPP
+
+#include <graph_canon/dimacs_graph_io.hpp> // line reader, edge selection, and graph building
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// rst: The graph6, sparse6, and digraph6 formats are the line-based formats of the nauty tools,
+// rst: described in https://users.cecs.anu.edu.au/~bdm/data/formats.txt.
+// rst: Each graph is a single line of printable characters, each holding 6 bits,
+// rst: starting with the number of vertices :math:`n`.
+// rst: A graph6 line holds the upper triangle of the adjacency matrix, so it can not represent loops or parallel edges.
+// rst: A sparse6 line starts with ``:`` and holds a list of edges, including loops and parallel edges.
+// rst: A digraph6 line starts with ``&`` and holds the full adjacency matrix of a directed graph, including loops.
+// rst: A line may start with one of the optional headers ``>>graph6<<``, ``>>sparse6<<``, or ``>>digraph6<<``.
+// rst:
+// rst: The vertices are numbered from 0 in the formats, but as for `read_dimacs_graph`
+// rst: the handlers for parallel edges and loops are given vertex IDs starting from 1.
+// rst:
+
+namespace graph_canon {
+namespace detail {
+
+constexpr unsigned int graph6_bias = 63;
+
+inline void graph6_append_size(std::string &out, std::uint64_t n) {
+	if(n <= 62) {
+		out += char(graph6_bias + n);
+		return;
+	}
+	int num_bytes;
+	if(n <= 258047) {
+		out += char(126);
+		num_bytes = 3;
+	} else {
+		out += char(126);
+		out += char(126);
+		num_bytes = 6;
+	}
+	for(int i = num_bytes - 1; i >= 0; --i)
+		out += char(graph6_bias + ((n >> (6 * i)) & 63));
+}
+
+// Packs bits into characters of 6 bits each, the most significant bit first.
+
+struct graph6_bit_writer {
+	explicit graph6_bit_writer(std::string &out) : out(out) { }
+
+	void put(unsigned int bit) {
+		cur = cur << 1 | bit;
+		if(++num_bits == 6) {
+			out += char(graph6_bias + cur);
+			cur = 0;
+			num_bits = 0;
+		}
+	}
+
+	void put(std::uint64_t x, int k) {
+		for(int i = k - 1; i >= 0; --i) put(unsigned(x >> i) & 1);
+	}
+
+	// the number of bits needed to complete the current character
+	int num_missing() const {
+		return num_bits == 0 ? 0 : 6 - num_bits;
+	}
+
+	void flush(unsigned int pad_bit) {
+		while(num_bits != 0) put(pad_bit);
+	}
+private:
+	std::string &out;
+	unsigned int cur = 0;
+	int num_bits = 0;
+};
+
+// Reads bits from characters of 6 bits each, the most significant bit first.
+
+struct graph6_bit_reader {
+	graph6_bit_reader(const char *p, const char *last) : p(p), last(last) { }
+
+	// false if there are fewer than k bits left
+	bool get(int k, std::uint64_t &x) {
+		x = 0;
+		for(int i = 0; i < k; ++i) {
+			if(num_bits == 0) {
+				if(p == last) return false;
+				cur = static_cast<unsigned char> (*p++) - graph6_bias;
+				num_bits = 6;
+			}
+			--num_bits;
+			x = x << 1 | ((cur >> num_bits) & 1);
+		}
+		return true;
+	}
+private:
+	const char *p, *last;
+	unsigned int cur = 0;
+	int num_bits = 0;
+};
+
+// The number of vertices, or false if the encoding is invalid or the graph has more vertices than we can index.
+
+inline bool graph6_parse_size(const char *&p, const char *last, unsigned int &n) {
+	int num_bytes = 1;
+	if(p != last && *p == 126) {
+		++p;
+		num_bytes = 3;
+		if(p != last && *p == 126) {
+			++p;
+			num_bytes = 6;
+		}
+	}
+	if(last - p < num_bytes) return false;
+	std::uint64_t res = 0;
+	for(int i = 0; i < num_bytes; ++i, ++p)
+		res = res << 6 | (static_cast<unsigned char> (*p) - graph6_bias);
+	// vertex IDs start from 1 in the handlers
+	if(res >= std::numeric_limits<unsigned int>::max()) return false;
+	n = static_cast<unsigned int> (res);
+	return true;
+}
+
+inline bool graph6_has_prefix(const char *&p, const char *last, const char *prefix) {
+	const std::size_t len = std::strlen(prefix);
+	if(static_cast<std::size_t> (last - p) < len || std::memcmp(p, prefix, len) != 0) return false;
+	p += len;
+	return true;
+}
+
+// Parse a single line in graph6, sparse6, or digraph6 format into data, with 1-based edges in the order of the encoding.
+// For digraph6 the edges are arcs from first to second.
+
+inline bool graph6_parse(const char *p, const char *last, dimacs_graph_data &data, bool &directed) {
+	data.edges.clear();
+	data.error.clear();
+	if(!graph6_has_prefix(p, last, ">>graph6<<") && !graph6_has_prefix(p, last, ">>sparse6<<"))
+		graph6_has_prefix(p, last, ">>digraph6<<");
+	const bool sparse = p != last && *p == ':';
+	directed = p != last && *p == '&';
+	if(sparse || directed) ++p;
+	for(const char *c = p; c != last; ++c) {
+		if(*c < 63 || *c > 126) {
+			data.error = "Invalid character in graph6 data.\n";
+			return false;
+		}
+	}
+	if(!graph6_parse_size(p, last, data.n)) {
+		data.error = "Invalid number of vertices in graph6 data.\n";
+		return false;
+	}
+	const std::uint64_t n = data.n;
+	// the vertices are unlabelled, so nothing is allocated from the untrusted size
+	data.labels.clear();
+	if(sparse) {
+		int k = 0;
+		while(n > 1 && ((n - 1) >> k) != 0) ++k;
+		graph6_bit_reader bits(p, last);
+		std::uint64_t v = 0, b, x;
+		// an incomplete pair at the end is padding
+		while(bits.get(1, b) && bits.get(k, x)) {
+			if(b) ++v;
+			if(v >= n) break;
+			if(x > v) v = x;
+			else data.edges.emplace_back(x + 1, v + 1);
+		}
+	} else {
+		const std::uint64_t num_bits = directed ? n * n : n * (n - 1) / 2;
+		if(static_cast<std::uint64_t> (last - p) != (num_bits + 5) / 6) {
+			data.error = "The length of the graph6 data does not match the number of vertices (" + std::to_string(n) + ").\n";
+			return false;
+		}
+		// the upper triangle column by column, or the full matrix row by row
+		std::uint64_t i = 0, j = directed ? 0 : 1, pos = 0;
+		for(; p != last; ++p) {
+			const unsigned int c = static_cast<unsigned char> (*p) - graph6_bias;
+			for(int bit = 5; bit >= 0 && pos != num_bits; --bit, ++pos) {
+				if((c >> bit) & 1) data.edges.emplace_back(i + 1, j + 1);
+				if(directed) {
+					if(++j == n) {
+						j = 0;
+						++i;
+					}
+				} else if(++i == j) {
+					i = 0;
+					++j;
+				}
+			}
+		}
+	}
+	data.m = data.edges.size();
+	return true;
+}
+
+template<typename Graph, typename ParallelHandler, typename LoopHandler>
+bool graph6_build_directed(const dimacs_graph_data &data, Graph &graph, std::ostream &err, ParallelHandler&, LoopHandler &loopHandler,
+		std::true_type /*is_directed*/) {
+	using Vertex = typename boost::graph_traits<Graph>::vertex_descriptor;
+	std::vector<Vertex> vertices(data.n);
+	for(unsigned int i = 0; i < data.n; i++) {
+		vertices[i] = add_vertex(graph);
+		put(boost::vertex_name_t(), graph, vertices[i], 0);
+	}
+	for(const auto &e : data.edges) {
+		if(e.first == e.second && !loopHandler(e.first)) continue;
+		add_edge(vertices[e.first - 1], vertices[e.second - 1], graph);
+	}
+	return true;
+}
+
+template<typename Graph, typename ParallelHandler, typename LoopHandler>
+bool graph6_build_directed(const dimacs_graph_data&, Graph&, std::ostream &err, ParallelHandler&, LoopHandler&,
+		std::false_type /*is_directed*/) {
+	err << "A graph in digraph6 format can only be stored in a directed graph.\n";
+	return false;
+}
+
+template<typename Graph, typename ParallelHandler, typename LoopHandler>
+bool graph6_build(const dimacs_graph_data &data, bool directed, Graph &graph, std::ostream &err,
+		ParallelHandler &parHandler, LoopHandler &loopHandler) {
+	if(directed) {
+		using IsDirected = std::integral_constant<bool, boost::is_directed_graph<Graph>::value>;
+		return graph6_build_directed(data, graph, err, parHandler, loopHandler, IsDirected());
+	}
+	return build_dimacs_graph(data, graph, err, parHandler, loopHandler);
+}
+
+// Write g with the vertex v at position canon_idx(v),
+// in graph6 ('g'), sparse6 ('s'), or digraph6 ('d') format.
+
+template<typename Graph, typename CanonIndex>
+void graph6_write(std::ostream &s, const Graph &g, CanonIndex canon_idx, char format) {
+	const std::uint64_t n = num_vertices(g);
+	std::string out;
+	if(format == 's') out += ':';
+	else if(format == 'd') out += '&';
+	graph6_append_size(out, n);
+	graph6_bit_writer bits(out);
+	if(format == 's') {
+		int k = 0;
+		while(n > 1 && ((n - 1) >> k) != 0) ++k;
+		// sorted by the larger end-point
+		std::vector<std::pair<std::uint64_t, std::uint64_t> > es;
+		es.reserve(num_edges(g));
+		const auto edge_range = edges(g);
+		for(auto iter = edge_range.first; iter != edge_range.second; ++iter) {
+			const std::uint64_t a = canon_idx(source(*iter, g)), b = canon_idx(target(*iter, g));
+			es.emplace_back(std::max(a, b), std::min(a, b));
+		}
+		std::sort(es.begin(), es.end());
+		std::uint64_t cur = 0;
+		for(const auto &e : es) {
+			const std::uint64_t v = e.first, u = e.second;
+			if(v == cur) {
+				bits.put(0);
+			} else {
+				bits.put(1);
+				if(v != cur + 1) {
+					bits.put(v, k);
+					bits.put(0);
+				}
+				cur = v;
+			}
+			bits.put(u, k);
+		}
+		// padding with 1-bits could be read as an edge from n - 1 to itself when the last edge ends at n - 2
+		if(k < 6 && n == (std::uint64_t(1) << k) && !es.empty() && cur == n - 2 && bits.num_missing() > k)
+			bits.put(0);
+		bits.flush(1);
+	} else {
+		const bool directed = format == 'd';
+		const std::uint64_t num_bits = directed ? n * n : n * (n - 1) / 2;
+		std::vector<bool> adj(num_bits, false);
+		const auto edge_range = edges(g);
+		for(auto iter = edge_range.first; iter != edge_range.second; ++iter) {
+			const std::uint64_t a = canon_idx(source(*iter, g)), b = canon_idx(target(*iter, g));
+			if(directed) adj[a * n + b] = true;
+			else if(a != b) {
+				const std::uint64_t u = std::min(a, b), v = std::max(a, b);
+				adj[v * (v - 1) / 2 + u] = true;
+			}
+		}
+		for(std::uint64_t i = 0; i != num_bits; ++i) bits.put(adj[i] ? 1 : 0);
+		bits.flush(0);
+	}
+	out += '\n';
+	s.write(out.data(), out.size());
+}
+
+template<typename Graph, typename IndexMap, typename Perm>
+struct graph6_canon_index {
+	IndexMap idx;
+	const Perm &canon_perm;
+
+	std::uint64_t operator()(typename boost::graph_traits<Graph>::vertex_descriptor v) const {
+		return canon_perm[get(idx, v)];
+	}
+};
+
+template<typename Graph>
+auto graph6_vertex_index(const Graph &g) {
+	return [&g](typename boost::graph_traits<Graph>::vertex_descriptor v) -> std::uint64_t {
+		return get(boost::vertex_index_t(), g, v);
+	};
+}
+
+} // namespace detail
+
+// rst: .. function:: template<typename Graph> \
+// rst:               void write_graph6(std::ostream &s, const Graph &g)
+// rst:               template<typename Graph> \
+// rst:               void write_sparse6(std::ostream &s, const Graph &g)
+// rst:               template<typename Graph> \
+// rst:               void write_digraph6(std::ostream &s, const Graph &g)
+// rst:
+// rst:		Write the given graph as a single line in graph6, sparse6, or digraph6 format, without a header.
+// rst:		The vertices must have indices, i.e., the expression `get(boost::vertex_index_t(), g)` must be valid.
+// rst:		Loops are not written in graph6 format, and parallel edges are written only in sparse6 format.
+// rst:		The digraph6 format requires `Graph` to be directed.
+// rst:
+// rst: .. function:: template<typename Graph, typename IndexMap, typename Perm> \
+// rst:               void write_graph6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm)
+// rst:               template<typename Graph, typename IndexMap, typename Perm> \
+// rst:               void write_sparse6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm)
+// rst:               template<typename Graph, typename IndexMap, typename Perm> \
+// rst:               void write_digraph6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm)
+// rst:
+// rst:		Write the canonical form of `g`, where `canon_perm[get(idx, v)]` is the canonical index of the vertex `v`,
+// rst:		e.g., the permutation returned by a `canonicalizer`.
+// rst:		Two graphs are thus isomorphic if and only if the written lines are equal,
+// rst:		as for the output of the ``labelg`` tool of nauty.
+// rst:		Note that the canonical labelling of this library differs from that of nauty,
+// rst:		so the lines are only comparable between graphs canonicalized with the same algorithm configuration.
+
+template<typename Graph>
+void write_graph6(std::ostream &s, const Graph &g) {
+	detail::graph6_write(s, g, detail::graph6_vertex_index(g), 'g');
+}
+
+template<typename Graph>
+void write_sparse6(std::ostream &s, const Graph &g) {
+	detail::graph6_write(s, g, detail::graph6_vertex_index(g), 's');
+}
+
+template<typename Graph>
+void write_digraph6(std::ostream &s, const Graph &g) {
+	static_assert(boost::is_directed_graph<Graph>::value, "The digraph6 format requires a directed graph.");
+	detail::graph6_write(s, g, detail::graph6_vertex_index(g), 'd');
+}
+
+template<typename Graph, typename IndexMap, typename Perm>
+void write_graph6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm) {
+	detail::graph6_write(s, g, detail::graph6_canon_index<Graph, IndexMap, Perm>{idx, canon_perm}, 'g');
+}
+
+template<typename Graph, typename IndexMap, typename Perm>
+void write_sparse6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm) {
+	detail::graph6_write(s, g, detail::graph6_canon_index<Graph, IndexMap, Perm>{idx, canon_perm}, 's');
+}
+
+template<typename Graph, typename IndexMap, typename Perm>
+void write_digraph6(std::ostream &s, const Graph &g, IndexMap idx, const Perm &canon_perm) {
+	static_assert(boost::is_directed_graph<Graph>::value, "The digraph6 format requires a directed graph.");
+	detail::graph6_write(s, g, detail::graph6_canon_index<Graph, IndexMap, Perm>{idx, canon_perm}, 'd');
+}
+
+// rst: .. function:: template<typename Graph, typename ParallelHandler, typename LoopHandler> \
+// rst:               bool read_graph6(std::istream &s, Graph &graph, std::ostream &err, ParallelHandler parHandler, LoopHandler loopHandler)
+// rst:
+// rst:		Parse the first line of `s` in graph6, sparse6, or digraph6 format, which is detected from the line,
+// rst:		and store the graph in the empty graph `graph`.
+// rst:		Reading errors are written to `err`.
+// rst:		The handlers are used as in `read_dimacs_graph`, and the vertex names are set to 0.
+// rst:		`Graph` may also be a `csr_graph`, as for `read_dimacs_graph_fast`.
+// rst:		A graph in digraph6 format can only be stored in a directed graph, where the handler for parallel edges is not used.
+
+template<typename Graph, typename ParallelHandler, typename LoopHandler>
+bool read_graph6(std::istream &s, Graph &graph, std::ostream &err, ParallelHandler parHandler, LoopHandler loopHandler) {
+	detail::dimacs_line_reader reader(s);
+	const char *first, *last;
+	if(!reader.next(first, last)) {
+		err << "No graph6 line in the input.\n";
+		return false;
+	}
+	detail::dimacs_graph_data data;
+	bool directed;
+	if(!detail::graph6_parse(first, last, data, directed)) {
+		err << data.error;
+		return false;
+	}
+	return detail::graph6_build(data, directed, graph, err, parHandler, loopHandler);
+}
+
+// rst: .. class:: graph6_stream
+// rst:
+// rst:		A reader of a collection of graphs with one graph per line, in graph6, sparse6, or digraph6 format,
+// rst:		as written by the nauty tools. Empty lines are skipped.
+// rst:		The lines are read in large blocks, and the edge buffer is reused between the graphs.
+// rst:
+
+class graph6_stream {
+public:
+	// rst:		.. function:: explicit graph6_stream(std::istream &s)
+
+	explicit graph6_stream(std::istream &s) : reader(s) { }
+
+	// rst:		.. function:: template<typename Graph, typename ParallelHandler, typename LoopHandler> \
+	// rst:		              bool read(Graph &graph, std::ostream &err, ParallelHandler parHandler, LoopHandler loopHandler)
+	// rst:
+	// rst:			Read the next graph into the empty graph `graph`, as by `read_graph6`.
+	// rst:
+	// rst:			:returns: `true` if a graph was read, and `false` at the end of the stream or on an error.
+	// rst:				After an error, `failed()` returns `true` and no further graphs are read.
+
+	template<typename Graph, typename ParallelHandler, typename LoopHandler>
+	bool read(Graph &graph, std::ostream &err, ParallelHandler parHandler, LoopHandler loopHandler) {
+		if(has_failed) return false;
+		const char *first, *last;
+		do {
+			if(!reader.next(first, last)) return false;
+		} while(first == last);
+		bool directed;
+		if(!detail::graph6_parse(first, last, data, directed)) {
+			err << data.error;
+			has_failed = true;
+			return false;
+		}
+		has_failed = !detail::graph6_build(data, directed, graph, err, parHandler, loopHandler);
+		return !has_failed;
+	}
+
+	// rst:		.. function:: bool failed() const
+	// rst:
+	// rst:			:returns: `true` if an error occurred.
+
+	bool failed() const {
+		return has_failed;
+	}
+private:
+	detail::dimacs_line_reader reader;
+	detail::dimacs_graph_data data;
+	bool has_failed = false;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_GRAPH6_IO_HPP */
@@ -2,6 +2,7 @@
 #define GRAPH_CANON_INVARIANT_SUPPORT_HPP
 
 #include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -62,8 +63,18 @@ public:
 	template<typename State>
 	void initialize(State &state) {
 		auto &i_data = get(instance_data_t(), state.data);
+		i_data.max_level = 0;
+		i_data.generation = 0;
 		i_data.trace.resize(state.n);
+		for(auto &t : i_data.trace) t.clear();
 		i_data.generations.resize(std::max(state.n, typename State::SizeType{1}));
+		i_data.visitor = 0;
+	}
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.trace) + detail::heap_bytes(i_data.generations);
 	}
 
 	template<typename State, typename TreeNode>
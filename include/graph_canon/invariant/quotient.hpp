@@ -2,6 +2,7 @@
 #define GRAPH_CANON_INVARIANT_QUOTIENT_HPP
 
 #include <graph_canon/invariant/coordinator.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 #include <cassert>
 #include <vector>
@@ -70,9 +71,17 @@ public:
 	void initialize(State &state) {
 		auto &i_data = get(instance_data_t(), state.data);
 		i_data.trace.resize(state.n);
+		for(auto &t : i_data.trace) t.clear();
+		i_data.max_level = 0;
 		i_data.visitor_type = invariant_coordinator::init_visitor(state);
 	}
 
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.trace);
+	}
+
 	template<typename State, typename TreeNode>
 	bool tree_create_node_begin(State &state, TreeNode &t) {
 		auto &i_data = get_data(state);
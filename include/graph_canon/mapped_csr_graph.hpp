@@ -0,0 +1,708 @@
+#ifndef GRAPH_CANON_MAPPED_CSR_GRAPH_HPP
+#define GRAPH_CANON_MAPPED_CSR_GRAPH_HPP
+
+#include <graph_canon/csr_graph.hpp>
+#include <graph_canon/detail/permuted_graph_view.hpp> // mix64
+
+#include <boost/assert.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/iteration_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph_canon {
+
+// rst: Binary CSR Graphs
+// rst: ========================================================================
+// rst:
+// rst: A binary file format holding an undirected graph in compressed sparse row format,
+// rst: laid out such that a memory mapping of the file can be used directly as the arrays of the graph.
+// rst: A file starts with a `csr_file_header` of 64 bytes, followed by the sections
+// rst:
+// rst: - the offsets, :math:`n + 1` unsigned 64-bit integers, where the out-edges of vertex :math:`v`
+// rst:   are the half-edges at the positions from `offsets[v]` to `offsets[v + 1]`,
+// rst: - the targets, an unsigned integer of `size_type_bytes` bytes for each half-edge,
+// rst: - optionally the vertex labels, an unsigned 64-bit integer for each vertex,
+// rst: - optionally the edge labels, an unsigned 64-bit integer for each half-edge.
+// rst:
+// rst: Each edge is stored as two half-edges, one at each end-point, and loops are not allowed, as in `csr_graph`.
+// rst: The header stores the position of each section, and each section starts at a multiple of `csr_file_alignment` bytes.
+// rst: All numbers are in the byte order of the machine that wrote the file,
+// rst: and files written with a different byte order are rejected when opened.
+// rst:
+
+// rst: .. var:: constexpr std::size_t csr_file_alignment = 64
+constexpr std::size_t csr_file_alignment = 64;
+
+// rst: .. class:: csr_file_header
+// rst:
+
+struct csr_file_header {
+	// rst:		.. var:: static constexpr std::uint32_t current_version = 1
+	static constexpr std::uint32_t current_version = 1;
+	// rst:		.. var:: static constexpr std::uint32_t byte_order_mark = 0x01020304
+	static constexpr std::uint32_t byte_order_mark = 0x01020304;
+	// rst:		.. var:: static constexpr std::uint16_t flag_vertex_labels = 1
+	// rst:		         static constexpr std::uint16_t flag_edge_labels = 2
+	static constexpr std::uint16_t flag_vertex_labels = 1;
+	static constexpr std::uint16_t flag_edge_labels = 2;
+public:
+	// rst:		.. var:: char magic[4]
+	// rst:
+	// rst:			The characters ``GCSR``.
+	char magic[4];
+	// rst:		.. var:: std::uint32_t version
+	std::uint32_t version;
+	// rst:		.. var:: std::uint32_t byte_order
+	// rst:
+	// rst:			The value `byte_order_mark` as written by the creating machine.
+	std::uint32_t byte_order;
+	// rst:		.. var:: std::uint16_t size_type_bytes
+	// rst:
+	// rst:			The width of each target vertex index: 1, 2, 4, or 8.
+	std::uint16_t size_type_bytes;
+	// rst:		.. var:: std::uint16_t flags
+	std::uint16_t flags;
+	// rst:		.. var:: std::uint64_t num_vertices
+	// rst:		         std::uint64_t num_half_edges
+	std::uint64_t num_vertices;
+	std::uint64_t num_half_edges;
+	// rst:		.. var:: std::uint64_t offsets_pos
+	// rst:		         std::uint64_t targets_pos
+	// rst:		         std::uint64_t vertex_labels_pos
+	// rst:		         std::uint64_t edge_labels_pos
+	// rst:
+	// rst:			The position in bytes of each section from the beginning of the file.
+	// rst:			The position of an absent label section is 0.
+	std::uint64_t offsets_pos;
+	std::uint64_t targets_pos;
+	std::uint64_t vertex_labels_pos;
+	std::uint64_t edge_labels_pos;
+};
+
+static_assert(sizeof(csr_file_header) == 64, "The header must be packed into 64 bytes.");
+
+namespace detail {
+
+inline std::uint64_t csr_file_align(std::uint64_t pos) {
+	return (pos + csr_file_alignment - 1) / csr_file_alignment * csr_file_alignment;
+}
+
+inline void csr_file_pad(std::ostream &s, std::uint64_t &pos, std::uint64_t target) {
+	static const char zeros[csr_file_alignment] = {};
+	s.write(zeros, target - pos);
+	pos = target;
+}
+
+template<typename T>
+void csr_file_write_array(std::ostream &s, std::uint64_t &pos, const std::vector<T> &data) {
+	s.write(reinterpret_cast<const char*> (data.data()), data.size() * sizeof(T));
+	pos += data.size() * sizeof(T);
+}
+
+template<typename SizeType, typename Graph, typename IndexMap, typename VertexLabelMap, typename EdgeLabelMap>
+bool write_csr_graph_impl(std::ostream &s, const Graph &g, IndexMap idx, VertexLabelMap vertex_label, EdgeLabelMap edge_label) {
+	BOOST_STATIC_ASSERT((std::is_convertible<typename boost::graph_traits<Graph>::directed_category, boost::undirected_tag>::value));
+	BOOST_STATIC_ASSERT_MSG(std::is_integral<SizeType>::value && std::is_unsigned<SizeType>::value, "SizeType must be an unsigned integer.");
+	using Vertex = typename boost::graph_traits<Graph>::vertex_descriptor;
+	constexpr bool has_vertex_labels = !std::is_same<VertexLabelMap, std::nullptr_t>::value;
+	constexpr bool has_edge_labels = !std::is_same<EdgeLabelMap, std::nullptr_t>::value;
+	const std::size_t n = num_vertices(g);
+	// check everything before writing, so nothing is written for a graph that can not be stored
+	if(n >= std::numeric_limits<SizeType>::max()) return false;
+	std::vector<Vertex> vertex_from_idx(n);
+	std::vector<std::uint64_t> offsets(n + 1, 0);
+	BGL_FORALL_VERTICES_T(v, g, Graph) {
+		const std::size_t v_idx = get(idx, v);
+		vertex_from_idx[v_idx] = v;
+		offsets[v_idx + 1] = out_degree(v, g);
+		BGL_FORALL_OUTEDGES_T(v, e, g, Graph) {
+			if(target(e, g) == v) return false;
+		}
+	}
+	for(std::size_t i = 0; i < n; ++i)
+		offsets[i + 1] += offsets[i];
+
+	csr_file_header h;
+	std::memcpy(h.magic, "GCSR", 4);
+	h.version = csr_file_header::current_version;
+	h.byte_order = csr_file_header::byte_order_mark;
+	h.size_type_bytes = sizeof(SizeType);
+	h.flags = (has_vertex_labels ? csr_file_header::flag_vertex_labels : 0)
+			| (has_edge_labels ? csr_file_header::flag_edge_labels : 0);
+	h.num_vertices = n;
+	h.num_half_edges = offsets[n];
+	h.offsets_pos = csr_file_align(sizeof(csr_file_header));
+	h.targets_pos = csr_file_align(h.offsets_pos + (n + 1) * sizeof(std::uint64_t));
+	std::uint64_t end = h.targets_pos + h.num_half_edges * sizeof(SizeType);
+	h.vertex_labels_pos = 0;
+	if(has_vertex_labels) {
+		h.vertex_labels_pos = csr_file_align(end);
+		end = h.vertex_labels_pos + n * sizeof(std::uint64_t);
+	}
+	h.edge_labels_pos = 0;
+	if(has_edge_labels)
+		h.edge_labels_pos = csr_file_align(end);
+
+	s.write(reinterpret_cast<const char*> (&h), sizeof(h));
+	std::uint64_t pos = sizeof(h);
+	csr_file_pad(s, pos, h.offsets_pos);
+	csr_file_write_array(s, pos, offsets);
+	csr_file_pad(s, pos, h.targets_pos);
+	// the remaining sections are written a vertex at a time, to not need a copy of the whole graph
+	std::vector<SizeType> targets;
+	std::vector<std::uint64_t> labels;
+	for(const Vertex v : vertex_from_idx) {
+		targets.clear();
+		BGL_FORALL_OUTEDGES_T(v, e, g, Graph) {
+			targets.push_back(get(idx, target(e, g)));
+		}
+		csr_file_write_array(s, pos, targets);
+	}
+	if constexpr(has_vertex_labels) {
+		csr_file_pad(s, pos, h.vertex_labels_pos);
+		labels.clear();
+		for(const Vertex v : vertex_from_idx)
+			labels.push_back(get(vertex_label, v));
+		csr_file_write_array(s, pos, labels);
+	}
+	if constexpr(has_edge_labels) {
+		csr_file_pad(s, pos, h.edge_labels_pos);
+		for(const Vertex v : vertex_from_idx) {
+			labels.clear();
+			BGL_FORALL_OUTEDGES_T(v, e, g, Graph) {
+				labels.push_back(get(edge_label, e));
+			}
+			csr_file_write_array(s, pos, labels);
+		}
+	}
+	return static_cast<bool> (s);
+}
+
+} // namespace detail
+
+// rst: .. function:: template<typename SizeType, typename Graph, typename IndexMap> \
+// rst:               bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx)
+// rst:               template<typename SizeType, typename Graph, typename IndexMap, typename VertexLabelMap> \
+// rst:               bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx, VertexLabelMap vertex_label)
+// rst:               template<typename SizeType, typename Graph, typename IndexMap, typename VertexLabelMap, typename EdgeLabelMap> \
+// rst:               bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx, VertexLabelMap vertex_label, EdgeLabelMap edge_label)
+// rst:
+// rst:		Write the undirected graph `g` to the binary stream `s` in the binary CSR format,
+// rst:		with target vertex indices of type `SizeType`.
+// rst:		The vertex `v` gets index `get(idx, v)`, and its out-edges are stored in the order given by `g`.
+// rst:		The vertex labels and edge labels are written if the corresponding property maps are given,
+// rst:		and their values must be convertible to `std::uint64_t`.
+// rst:
+// rst:		Requires `Graph` to model a `VertexListGraph` and an `IncidenceGraph`.
+// rst:
+// rst:		:returns: `true` if the stream is still good after writing.
+// rst:			`false` without writing anything if `g` has a loop or too many vertices for `SizeType`.
+
+template<typename SizeType, typename Graph, typename IndexMap>
+bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx) {
+	return detail::write_csr_graph_impl<SizeType>(s, g, idx, nullptr, nullptr);
+}
+
+template<typename SizeType, typename Graph, typename IndexMap, typename VertexLabelMap>
+bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx, VertexLabelMap vertex_label) {
+	return detail::write_csr_graph_impl<SizeType>(s, g, idx, vertex_label, nullptr);
+}
+
+template<typename SizeType, typename Graph, typename IndexMap, typename VertexLabelMap, typename EdgeLabelMap>
+bool write_csr_graph(std::ostream &s, const Graph &g, IndexMap idx, VertexLabelMap vertex_label, EdgeLabelMap edge_label) {
+	return detail::write_csr_graph_impl<SizeType>(s, g, idx, vertex_label, edge_label);
+}
+
+// rst: .. class:: template<typename SizeTypeT> csr_graph_view
+// rst:
+// rst:		A non-owning undirected graph over arrays in the layout of the binary CSR format,
+// rst:		typically obtained from a `mapped_csr_file`.
+// rst:		It models the same concepts as `csr_graph`, with vertex and edge labels of type `std::uint64_t`,
+// rst:		and has the same fast path for refinement when canonicalized with its own vertex index map.
+// rst:		Absent labels are all 0.
+// rst:		A view is cheap to copy, and is valid as long as the arrays are.
+// rst:
+
+template<typename SizeTypeT>
+struct csr_graph_view
+: detail::csr_graph_base<csr_graph_view<SizeTypeT>, SizeTypeT, std::uint64_t, std::uint64_t> {
+	using base_type = detail::csr_graph_base<csr_graph_view<SizeTypeT>, SizeTypeT, std::uint64_t, std::uint64_t>;
+	// rst:		.. type:: SizeType = SizeTypeT
+	using SizeType = SizeTypeT;
+	// rst:		.. type:: VertexLabel = std::uint64_t
+	using VertexLabel = std::uint64_t;
+	// rst:		.. type:: EdgeLabel = std::uint64_t
+	using EdgeLabel = std::uint64_t;
+	using typename base_type::edge_descriptor;
+public:
+
+	// rst:		.. function:: csr_graph_view()
+	// rst:
+	// rst:			Construct a view of the empty graph.
+
+	csr_graph_view() : offsets(&zero_label) { }
+
+	// rst:		.. function:: csr_graph_view(SizeType num_vertices, std::size_t num_half_edges, const std::uint64_t *offsets, \
+	// rst:		              const SizeType *targets, const std::uint64_t *vertex_labels, const std::uint64_t *edge_labels)
+	// rst:
+	// rst:			Construct a view of the given arrays, where `vertex_labels` and `edge_labels` may be null.
+
+	csr_graph_view(SizeType num_vertices, std::size_t num_half_edges, const std::uint64_t *offsets,
+			const SizeType *targets, const std::uint64_t *vertex_labels, const std::uint64_t *edge_labels)
+	: n(num_vertices), num_half_edges(num_half_edges), offsets(offsets), targets(targets),
+	vertex_labels(vertex_labels), edge_labels(edge_labels) { }
+public: // raw access
+
+	// rst:		.. function:: const SizeType *get_targets() const
+	// rst:		              SizeType get_num_vertices() const
+	// rst:		              std::size_t get_num_half_edges() const
+	// rst:		              std::size_t get_out_begin(SizeType v) const
+	// rst:		              std::size_t get_out_end(SizeType v) const
+	// rst:		              const VertexLabel &get_vertex_label(SizeType v) const
+	// rst:		              const EdgeLabel &get_edge_label(const edge_descriptor &e) const
+	// rst:
+	// rst:			As for `csr_graph`.
+
+	const SizeType *get_targets() const {
+		return targets;
+	}
+
+	SizeType get_num_vertices() const {
+		return n;
+	}
+
+	std::size_t get_num_half_edges() const {
+		return num_half_edges;
+	}
+
+	std::size_t get_out_begin(SizeType v) const {
+		return offsets[v];
+	}
+
+	std::size_t get_out_end(SizeType v) const {
+		return offsets[v + 1];
+	}
+
+	const VertexLabel &get_vertex_label(SizeType v) const {
+		return vertex_labels ? vertex_labels[v] : zero_label;
+	}
+
+	const EdgeLabel &get_edge_label(const edge_descriptor &e) const {
+		return edge_labels ? edge_labels[e.pos] : zero_label;
+	}
+private:
+	static constexpr std::uint64_t zero_label = 0;
+	SizeType n = 0;
+	std::size_t num_half_edges = 0;
+	const std::uint64_t *offsets;
+	const SizeType *targets = nullptr;
+	const std::uint64_t *vertex_labels = nullptr;
+	const std::uint64_t *edge_labels = nullptr;
+};
+
+// rst: .. class:: csr_image
+// rst:
+// rst:		The bytes of a single graph in the binary CSR format, starting with its header,
+// rst:		as provided by `mapped_csr_file` and `csr_graph_stream`.
+// rst:
+
+class csr_image {
+public:
+	// rst:		.. function:: const csr_file_header &get_header() const
+
+	const csr_file_header &get_header() const {
+		BOOST_ASSERT(data);
+		return header;
+	}
+
+	// rst:		.. function:: std::size_t get_size_type_bytes() const
+	// rst:
+	// rst:			:returns: the width of the stored vertex indices, which determines the `SizeType` of `view`.
+
+	std::size_t get_size_type_bytes() const {
+		return get_header().size_type_bytes;
+	}
+
+	// rst:		.. function:: template<typename SizeType> csr_graph_view<SizeType> view() const
+	// rst:
+	// rst:			:returns: a view of the graph.
+	// rst:			Requires `sizeof(SizeType) == get_size_type_bytes()` and `SizeType` to be unsigned.
+
+	template<typename SizeType>
+	csr_graph_view<SizeType> view() const {
+		BOOST_STATIC_ASSERT_MSG(std::is_integral<SizeType>::value && std::is_unsigned<SizeType>::value, "SizeType must be an unsigned integer.");
+		BOOST_ASSERT_MSG(sizeof(SizeType) == get_size_type_bytes(), "SizeType does not match the stored vertex index width.");
+		return csr_graph_view<SizeType>(header.num_vertices, header.num_half_edges,
+				section<std::uint64_t>(header.offsets_pos),
+				section<SizeType>(header.targets_pos),
+				header.vertex_labels_pos == 0 ? nullptr : section<std::uint64_t>(header.vertex_labels_pos),
+				header.edge_labels_pos == 0 ? nullptr : section<std::uint64_t>(header.edge_labels_pos));
+	}
+
+	// rst:		.. function:: bool validate(std::ostream &err) const
+	// rst:
+	// rst:			Check the contents of the sections in a single pass:
+	// rst:			the offsets must be non-decreasing from 0 to the number of half-edges,
+	// rst:			each target must be a vertex index different from the source,
+	// rst:			and the half-edges must pair up into edges.
+	// rst:			The pairing is checked through a sum of hashes of the half-edges,
+	// rst:			so an unpaired half-edge is detected with high probability without additional memory.
+	// rst:			Errors are written to `err`.
+	// rst:
+	// rst:			:returns: `true` if no errors were found.
+
+	bool validate(std::ostream &err) const {
+		switch(get_size_type_bytes()) {
+		case 1: return validate_impl<std::uint8_t>(err);
+		case 2: return validate_impl<std::uint16_t>(err);
+		case 4: return validate_impl<std::uint32_t>(err);
+		default: return validate_impl<std::uint64_t>(err);
+		}
+	}
+protected:
+	csr_image() = default;
+
+	template<typename T>
+	const T *section(std::uint64_t pos) const {
+		return reinterpret_cast<const T*> (data + pos);
+	}
+
+	// whether the section [pos, pos + count * width) is aligned and inside the file
+	bool check_section(const char *name, std::uint64_t pos, std::uint64_t count, std::uint64_t width, std::ostream &err) const {
+		if(pos < sizeof(csr_file_header) || pos % csr_file_alignment != 0) {
+			err << "Invalid position " << pos << " of the " << name << " section.\n";
+			return false;
+		}
+		if(pos > size || count > (size - pos) / width) {
+			err << "The " << name << " section extends beyond the end of the data.\n";
+			return false;
+		}
+		return true;
+	}
+
+	// the fields of the header, except the section positions
+	bool check_header(std::ostream &err) const {
+		if(std::memcmp(header.magic, "GCSR", 4) != 0) {
+			err << "Not a binary CSR file.\n";
+			return false;
+		}
+		if(header.version != csr_file_header::current_version) {
+			err << "Unsupported version " << header.version << " of binary CSR file.\n";
+			return false;
+		}
+		if(header.byte_order != csr_file_header::byte_order_mark) {
+			err << "The binary CSR file was written with a different byte order.\n";
+			return false;
+		}
+		const std::uint64_t w = header.size_type_bytes;
+		if(w != 1 && w != 2 && w != 4 && w != 8) {
+			err << "Invalid vertex index width " << w << ".\n";
+			return false;
+		}
+		const std::uint64_t max_n = w == 8 ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t(1) << (8 * w)) - 1;
+		if(header.num_vertices >= max_n || header.num_vertices >= std::numeric_limits<std::size_t>::max()) {
+			err << "Too many vertices (" << header.num_vertices << ") for a vertex index width of " << w << ".\n";
+			return false;
+		}
+		if((header.vertex_labels_pos != 0) != ((header.flags & csr_file_header::flag_vertex_labels) != 0)
+				|| (header.edge_labels_pos != 0) != ((header.flags & csr_file_header::flag_edge_labels) != 0)) {
+			err << "The label flags do not match the label sections.\n";
+			return false;
+		}
+		return true;
+	}
+
+	// the number of bytes from the header to the end of the last section, or 0 if it overflows
+	std::uint64_t record_size() const {
+		std::uint64_t res = sizeof(csr_file_header);
+		const auto extend = [&res](std::uint64_t pos, std::uint64_t count, std::uint64_t width) {
+			const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+			if(res == 0 || count > (max - pos) / width) res = 0;
+			else res = std::max(res, pos + count * width);
+		};
+		extend(header.offsets_pos, header.num_vertices + 1, sizeof(std::uint64_t));
+		extend(header.targets_pos, header.num_half_edges, header.size_type_bytes);
+		if(header.vertex_labels_pos != 0) extend(header.vertex_labels_pos, header.num_vertices, sizeof(std::uint64_t));
+		if(header.edge_labels_pos != 0) extend(header.edge_labels_pos, header.num_half_edges, sizeof(std::uint64_t));
+		return res;
+	}
+
+	// whether all sections are aligned and inside the data
+	bool check_sections(std::ostream &err) const {
+		const std::uint64_t w = header.size_type_bytes;
+		if(!check_section("offsets", header.offsets_pos, header.num_vertices + 1, sizeof(std::uint64_t), err)) return false;
+		if(!check_section("targets", header.targets_pos, header.num_half_edges, w, err)) return false;
+		if(header.vertex_labels_pos != 0
+				&& !check_section("vertex labels", header.vertex_labels_pos, header.num_vertices, sizeof(std::uint64_t), err))
+			return false;
+		if(header.edge_labels_pos != 0
+				&& !check_section("edge labels", header.edge_labels_pos, header.num_half_edges, sizeof(std::uint64_t), err))
+			return false;
+		return true;
+	}
+
+	template<typename SizeType>
+	bool validate_impl(std::ostream &err) const {
+		const auto g = view<SizeType>();
+		const std::uint64_t n = header.num_vertices;
+		const std::uint64_t *offsets = section<std::uint64_t>(header.offsets_pos);
+		const SizeType *targets = g.get_targets();
+		if(offsets[0] != 0 || offsets[n] != header.num_half_edges) {
+			err << "The offsets do not span the " << header.num_half_edges << " half-edges.\n";
+			return false;
+		}
+		std::uint64_t pairing = 0;
+		for(std::uint64_t v = 0; v != n; ++v) {
+			if(offsets[v + 1] < offsets[v]) {
+				err << "The offsets of vertex " << v << " are decreasing.\n";
+				return false;
+			}
+			for(std::uint64_t pos = offsets[v]; pos != offsets[v + 1]; ++pos) {
+				const std::uint64_t u = targets[pos];
+				if(u >= n) {
+					err << "Invalid target " << u << " of vertex " << v << ".\n";
+					return false;
+				}
+				if(u == v) {
+					err << "Loop on vertex " << v << ".\n";
+					return false;
+				}
+				// the two half-edges of an edge cancel out
+				const std::uint64_t h = detail::mix64(detail::mix64(std::min(u, v)) + std::max(u, v));
+				if(v < u) pairing += h;
+				else pairing -= h;
+			}
+		}
+		if(pairing != 0) {
+			err << "The half-edges do not pair up into undirected edges.\n";
+			return false;
+		}
+		return true;
+	}
+protected:
+	const char *data = nullptr;
+	std::size_t size = 0;
+	csr_file_header header;
+};
+
+// rst: .. class:: mapped_csr_file : public csr_image
+// rst:
+// rst:		A read-only memory mapping of a file in the binary CSR format.
+// rst:		Opening a file only checks the header and that the sections are inside the file,
+// rst:		so the cost is independent of the size of the graph, and pages are read by the operating system on demand.
+// rst:		Use `validate` for files from untrusted sources.
+// rst:		The object is movable but not copyable.
+// rst:
+
+class mapped_csr_file : public csr_image {
+public:
+	mapped_csr_file() = default;
+
+	mapped_csr_file(const mapped_csr_file&) = delete;
+	mapped_csr_file &operator=(const mapped_csr_file&) = delete;
+
+	mapped_csr_file(mapped_csr_file &&other) noexcept {
+		*this = std::move(other);
+	}
+
+	mapped_csr_file &operator=(mapped_csr_file &&other) noexcept {
+		if(this == &other) return *this;
+		close();
+		data = other.data;
+		size = other.size;
+		header = other.header;
+		other.data = nullptr;
+		other.size = 0;
+		return *this;
+	}
+
+	~mapped_csr_file() {
+		close();
+	}
+
+	// rst:		.. function:: bool open(const std::string &filename, std::ostream &err)
+	// rst:
+	// rst:			Map the given file, closing any previously mapped file.
+	// rst:			Errors are written to `err`.
+	// rst:
+	// rst:			:returns: `true` if the file was mapped and has a valid header.
+
+	bool open(const std::string &filename, std::ostream &err) {
+		close();
+		const int fd = ::open(filename.c_str(), O_RDONLY);
+		if(fd == -1) {
+			err << "Could not open file '" << filename << "'.\n";
+			return false;
+		}
+		struct stat st;
+		if(::fstat(fd, &st) == -1) {
+			err << "Could not stat file '" << filename << "'.\n";
+			::close(fd);
+			return false;
+		}
+		if(static_cast<std::uint64_t> (st.st_size) < sizeof(csr_file_header)) {
+			err << "File '" << filename << "' is too small for a CSR header.\n";
+			::close(fd);
+			return false;
+		}
+		void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // the mapping keeps the file alive
+		if(p == MAP_FAILED) {
+			err << "Could not map file '" << filename << "'.\n";
+			return false;
+		}
+		data = static_cast<const char*> (p);
+		size = st.st_size;
+		std::memcpy(&header, data, sizeof(header));
+		if(!check_header(err) || !check_sections(err)) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	// rst:		.. function:: void close()
+	// rst:
+	// rst:			Unmap the file, if any. All views of it become invalid.
+
+	void close() {
+		if(data) ::munmap(const_cast<char*> (data), size);
+		data = nullptr;
+		size = 0;
+	}
+
+	// rst:		.. function:: bool is_open() const
+
+	bool is_open() const {
+		return data != nullptr;
+	}
+};
+
+// rst: .. class:: csr_graph_stream : public csr_image
+// rst:
+// rst:		A reader of many graphs from a single stream, e.g., a whole collection of small graphs,
+// rst:		where each graph is a record with the same content as a binary CSR file,
+// rst:		and the next record follows directly after the last section of the previous.
+// rst:		The header of a record thereby determines its length, so binary CSR files can simply be concatenated.
+// rst:		Each record is read into a buffer owned by the reader, which is reused for the next record.
+// rst:
+
+class csr_graph_stream : public csr_image {
+public:
+	// rst:		.. function:: explicit csr_graph_stream(std::istream &s)
+
+	explicit csr_graph_stream(std::istream &s) : s(s) { }
+
+	csr_graph_stream(const csr_graph_stream&) = delete;
+	csr_graph_stream &operator=(const csr_graph_stream&) = delete;
+
+	// rst:		.. function:: bool read(std::ostream &err)
+	// rst:
+	// rst:			Read the next record, invalidating all views of the previous.
+	// rst:			The header and the section positions are checked as by `mapped_csr_file::open`.
+	// rst:			Errors are written to `err`.
+	// rst:
+	// rst:			:returns: `true` if a record was read, and `false` at the end of the stream or on an error.
+	// rst:				After an error, `failed()` returns `true` and no further records are read.
+
+	bool read(std::ostream &err) {
+		data = nullptr;
+		size = 0;
+		if(has_failed) return false;
+		s.read(reinterpret_cast<char*> (&header), sizeof(header));
+		if(s.gcount() == 0 && s.eof()) return false;
+		if(static_cast<std::size_t> (s.gcount()) != sizeof(header)) {
+			err << "The header of binary CSR record " << num_records << " is truncated.\n";
+			return fail();
+		}
+		if(!check_header(err)) return fail();
+		const std::uint64_t record_size = this->record_size();
+		if(record_size == 0 || record_size > std::numeric_limits<std::size_t>::max()) {
+			err << "The sections of binary CSR record " << num_records << " are too large.\n";
+			return fail();
+		}
+		// grow the buffer with the data actually read, so a corrupt header does not cause a huge allocation
+		const std::size_t max_step = std::size_t(1) << 26;
+		std::size_t num_read = sizeof(header);
+		buffer.resize(std::max(buffer.size(), std::size_t(sizeof(header) / sizeof(std::uint64_t))));
+		std::memcpy(buffer.data(), &header, sizeof(header));
+		while(num_read != record_size) {
+			const std::size_t step = std::min<std::uint64_t>(record_size - num_read, max_step);
+			const std::size_t needed = (num_read + step + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+			if(buffer.size() < needed) buffer.resize(std::max(needed, std::min(2 * buffer.size(), record_size / sizeof(std::uint64_t) + 1)));
+			s.read(reinterpret_cast<char*> (buffer.data()) + num_read, step);
+			num_read += s.gcount();
+			if(static_cast<std::size_t> (s.gcount()) != step) {
+				err << "Binary CSR record " << num_records << " is truncated.\n";
+				return fail();
+			}
+		}
+		data = reinterpret_cast<const char*> (buffer.data());
+		size = record_size;
+		if(!check_sections(err)) return fail();
+		++num_records;
+		return true;
+	}
+
+	// rst:		.. function:: bool failed() const
+	// rst:
+	// rst:			:returns: `true` if an error occurred.
+
+	bool failed() const {
+		return has_failed;
+	}
+private:
+
+	bool fail() {
+		data = nullptr;
+		size = 0;
+		has_failed = true;
+		return false;
+	}
+private:
+	std::istream &s;
+	std::vector<std::uint64_t> buffer; // for the alignment of the sections
+	std::size_t num_records = 0;
+	bool has_failed = false;
+};
+
+} // namespace graph_canon
+namespace boost {
+
+template<typename SizeType>
+struct property_map<graph_canon::csr_graph_view<SizeType>, vertex_index_t> {
+	using type = typed_identity_property_map<SizeType>;
+	using const_type = type;
+};
+
+template<typename SizeType>
+struct property_map<graph_canon::csr_graph_view<SizeType>, vertex_name_t> {
+	using type = typename graph_canon::csr_graph_view<SizeType>::vertex_label_map;
+	using const_type = type;
+};
+
+template<typename SizeType>
+struct property_map<graph_canon::csr_graph_view<SizeType>, edge_name_t> {
+	using type = typename graph_canon::csr_graph_view<SizeType>::edge_label_map;
+	using const_type = type;
+};
+
+} // namespace boost
+
+#endif /* GRAPH_CANON_MAPPED_CSR_GRAPH_HPP */
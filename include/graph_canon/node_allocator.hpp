@@ -0,0 +1,169 @@
+#ifndef GRAPH_CANON_NODE_ALLOCATOR_HPP
+#define GRAPH_CANON_NODE_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: .. concept:: template<typename T> NodeAllocator
+// rst:
+// rst:		A node allocator provides the raw storage for search tree nodes.
+// rst:		Each tree node is allocated as a single block holding both the node itself
+// rst:		and the arrays of its ordered partition.
+// rst:		An allocator object is default constructed and then either owned by a single `canon_state`,
+// rst:		or kept in the `canon_workspace` of a `canonicalizer` and reused for all its runs.
+// rst:		In both cases all blocks are returned before the allocator is destroyed or reset.
+// rst:
+// rst:		.. notation::
+// rst:
+// rst:		.. var:: T alloc
+// rst:		.. var:: std::size_t size
+// rst:		.. var:: void *p
+// rst:
+// rst:		.. valid_expr::
+// rst:
+// rst:		- `alloc.allocate(size)`: return a pointer to storage of at least `size` bytes,
+// rst:		  suitably aligned for any fundamental type.
+// rst:		- `alloc.deallocate(p, size)`: return the block `p`, previously obtained by `alloc.allocate(size)`.
+// rst:		- `alloc.reset()`: called at the beginning of each run, when all blocks have been returned.
+// rst:
+
+// rst: .. class:: node_allocator_new
+// rst:
+// rst:		A `NodeAllocator` that simply uses the global `operator new` and `operator delete` for each block.
+// rst:
+
+struct node_allocator_new {
+
+	void *allocate(std::size_t size) {
+		return ::operator new(size);
+	}
+
+	void deallocate(void *p, std::size_t size) {
+		::operator delete(p);
+	}
+
+	void reset() { }
+};
+
+// rst: .. class:: node_allocator_pool
+// rst:
+// rst:		A `NodeAllocator` that carves blocks out of large chunks of memory,
+// rst:		and recycles the blocks of destroyed nodes through a free list for each block size.
+// rst:		Memory is only given back to the system when the allocator is destroyed.
+// rst:		When it is reset, all chunks are kept and handed out again,
+// rst:		so an allocator reused by a `canonicalizer` only requests memory when a run needs more than any previous run.
+// rst:
+
+struct node_allocator_pool {
+	// rst:		.. var:: static constexpr std::size_t min_chunk_size
+	// rst:
+	// rst:			The size in bytes of the first chunk requested from the system.
+	// rst:			Each subsequent chunk is twice as large as the previous, up to `max_chunk_size`.
+	static constexpr std::size_t min_chunk_size = 1 << 16;
+	// rst:		.. var:: static constexpr std::size_t max_chunk_size
+	static constexpr std::size_t max_chunk_size = 1 << 24;
+private:
+	static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+	struct free_block {
+		free_block *next;
+	};
+
+	struct size_class {
+		std::size_t size;
+		free_block *head;
+	};
+
+	struct chunk {
+		char *begin;
+		std::size_t size;
+	};
+public:
+	node_allocator_pool() = default;
+	node_allocator_pool(const node_allocator_pool&) = delete;
+	node_allocator_pool &operator=(const node_allocator_pool&) = delete;
+
+	~node_allocator_pool() {
+		for(const chunk &c : chunks)
+			::operator delete(c.begin);
+	}
+
+	void *allocate(std::size_t size) {
+		size = round_size(size);
+		size_class &c = get_class(size);
+		if(c.head) {
+			free_block *b = c.head;
+			c.head = b->next;
+			return b;
+		}
+		if(static_cast<std::size_t>(chunk_end - chunk_next) < size)
+			next_chunk(size); // the remainder of the current chunk is wasted
+		void *p = chunk_next;
+		chunk_next += size;
+		return p;
+	}
+
+	void deallocate(void *p, std::size_t size) {
+		size_class &c = get_class(round_size(size));
+		free_block *b = static_cast<free_block*> (p);
+		b->next = c.head;
+		c.head = b;
+	}
+
+	// rst:		.. function:: void reset()
+	// rst:
+	// rst:			Forget all blocks, but keep the chunks for the following allocations.
+
+	void reset() {
+		classes.clear();
+		num_used_chunks = 0;
+		chunk_next = chunk_end = nullptr;
+	}
+private:
+
+	void next_chunk(std::size_t size) {
+		// first reuse the chunks from before the last reset
+		while(num_used_chunks != chunks.size()) {
+			const chunk c = chunks[num_used_chunks++];
+			if(c.size < size) continue;
+			chunk_next = c.begin;
+			chunk_end = c.begin + c.size;
+			return;
+		}
+		next_chunk_size = std::max(next_chunk_size, size);
+		char *begin = static_cast<char*> (::operator new(next_chunk_size));
+		chunks.push_back(chunk{begin, next_chunk_size});
+		++num_used_chunks;
+		chunk_next = begin;
+		chunk_end = begin + next_chunk_size;
+		next_chunk_size = std::min(2 * next_chunk_size, max_chunk_size);
+	}
+
+	static std::size_t round_size(std::size_t size) {
+		size = std::max(size, sizeof(free_block));
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	size_class &get_class(std::size_t size) {
+		// all nodes of a run have the same size, so this list is tiny
+		for(auto &c : classes)
+			if(c.size == size) return c;
+		classes.push_back(size_class{size, nullptr});
+		return classes.back();
+	}
+private:
+	std::vector<chunk> chunks;
+	std::size_t num_used_chunks = 0;
+	std::vector<size_class> classes;
+	char *chunk_next = nullptr;
+	char *chunk_end = nullptr;
+	std::size_t next_chunk_size = min_chunk_size;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_NODE_ALLOCATOR_HPP */
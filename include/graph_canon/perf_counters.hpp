@@ -0,0 +1,188 @@
+#ifndef GRAPH_CANON_PERF_COUNTERS_HPP
+#define GRAPH_CANON_PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace graph_canon {
+
+// rst: .. class:: perf_sample
+// rst:
+// rst:		Values of the hardware counters read by `perf_counters`,
+// rst:		either as absolute counts or as the difference between two readings.
+// rst:
+
+struct perf_sample {
+	// rst:		.. var:: std::uint64_t cycles
+	// rst:		         std::uint64_t instructions
+	// rst:		         std::uint64_t cache_misses
+	// rst:		         std::uint64_t branch_misses
+	std::uint64_t cycles = 0, instructions = 0, cache_misses = 0, branch_misses = 0;
+public:
+
+	// rst:		.. function:: double get_ipc() const
+	// rst:
+	// rst:			:returns: the number of instructions per cycle, or 0 if no cycles were counted.
+
+	double get_ipc() const {
+		return cycles == 0 ? 0 : double(instructions) / cycles;
+	}
+
+	perf_sample &operator+=(const perf_sample &other) {
+		cycles += other.cycles;
+		instructions += other.instructions;
+		cache_misses += other.cache_misses;
+		branch_misses += other.branch_misses;
+		return *this;
+	}
+
+	friend perf_sample operator-(const perf_sample &a, const perf_sample &b) {
+		perf_sample res;
+		res.cycles = a.cycles - b.cycles;
+		res.instructions = a.instructions - b.instructions;
+		res.cache_misses = a.cache_misses - b.cache_misses;
+		res.branch_misses = a.branch_misses - b.branch_misses;
+		return res;
+	}
+};
+
+// rst: .. class:: perf_counters
+// rst:
+// rst:		A group of hardware performance counters for the calling thread, opened with `perf_event_open` on Linux.
+// rst:		Only user space is counted, so the counters are normally available with the default
+// rst:		``/proc/sys/kernel/perf_event_paranoid`` setting of 2, but they may still be disallowed,
+// rst:		e.g., in containers or virtual machines without a PMU.
+// rst:		When they can not be opened, `open` returns `false`, and `read` returns zeros.
+// rst:		If the kernel multiplexes the counters, the values are scaled to the time the group was enabled.
+// rst:
+
+class perf_counters {
+	perf_counters(const perf_counters&) = delete;
+	perf_counters &operator=(const perf_counters&) = delete;
+public:
+	perf_counters() = default;
+
+	perf_counters(perf_counters &&other) {
+		*this = std::move(other);
+	}
+
+	perf_counters &operator=(perf_counters &&other) {
+		if(this == &other) return *this;
+		close();
+		std::swap(fds, other.fds);
+		error = std::move(other.error);
+		return *this;
+	}
+
+	~perf_counters() {
+		close();
+	}
+
+	// rst:		.. function:: bool open()
+	// rst:
+	// rst:			Open and start the counters, unless they are already open.
+	// rst:
+	// rst:			:returns: whether the counters are available.
+
+	bool open() {
+		if(is_open()) return true;
+#ifdef __linux__
+		const std::uint64_t configs[num_counters] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+		};
+		for(int i = 0; i != num_counters; ++i) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[i];
+			attr.disabled = i == 0; // the group is started through the leader
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+			if(fds[i] == -1) {
+				error = std::string("perf_event_open: ") + std::strerror(errno);
+				close();
+				return false;
+			}
+		}
+		ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		error.clear();
+		return true;
+#else
+		error = "hardware performance counters are only supported on Linux";
+		return false;
+#endif
+	}
+
+	// rst:		.. function:: void close()
+
+	void close() {
+#ifdef __linux__
+		for(int &fd : fds) {
+			if(fd != -1) ::close(fd);
+			fd = -1;
+		}
+#endif
+	}
+
+	// rst:		.. function:: bool is_open() const
+
+	bool is_open() const {
+		return fds[0] != -1;
+	}
+
+	// rst:		.. function:: const std::string &get_error() const
+	// rst:
+	// rst:			:returns: the reason the last call to `open` failed, or the empty string.
+
+	const std::string &get_error() const {
+		return error;
+	}
+
+	// rst:		.. function:: perf_sample read() const
+	// rst:
+	// rst:			:returns: the counts since the counters were opened. Each call is a system call.
+
+	perf_sample read() const {
+		perf_sample res;
+#ifdef __linux__
+		if(!is_open()) return res;
+		struct {
+			std::uint64_t nr, time_enabled, time_running;
+			std::uint64_t values[num_counters];
+		} buf;
+		if(::read(fds[0], &buf, sizeof(buf)) != sizeof(buf) || buf.nr != num_counters) return res;
+		const auto scaled = [&buf](std::uint64_t value) -> std::uint64_t {
+			if(buf.time_running == 0 || buf.time_running == buf.time_enabled) return value;
+			return static_cast<std::uint64_t> (double(value) * buf.time_enabled / buf.time_running);
+		};
+		res.cycles = scaled(buf.values[0]);
+		res.instructions = scaled(buf.values[1]);
+		res.cache_misses = scaled(buf.values[2]);
+		res.branch_misses = scaled(buf.values[3]);
+#endif
+		return res;
+	}
+private:
+	static constexpr int num_counters = 4;
+	int fds[num_counters] = {-1, -1, -1, -1};
+	std::string error;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_PERF_COUNTERS_HPP */
@@ -4,6 +4,7 @@
 #include <graph_canon/sorting_utils.hpp>
 #include <graph_canon/visitor/visitor.hpp>
 #include <graph_canon/detail/fixed_vector.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -40,6 +41,8 @@ public:
 		struct cell_data_ { // Various data, not inter-related.
 			// Whether the cell is in the refiner queue.
 			bool is_refiner = false;
+			// The refiner pass the remaining data belongs to, in other passes it is all zero.
+			SizeType pass = 0;
 			// The number of edges from a fixed refiner cell to each refinee cell.
 			SizeType hit_count = 0;
 			// For refinees of non-singleton refiners
@@ -50,13 +53,45 @@ public:
 			SizeType max_count = 0;
 			// How many counters have non-zero
 			SizeType non_zero_count = 0;
-			// We don't want to reset counters that don't need it.
-			// This is at least refinee_begin, but may be set higher for skip 'zero' counters.
+			// Set by the sorter, at least refinee_begin, but may be set higher for skip 'zero' counters.
 			SizeType first_non_zero;
 			// How to handle the sorting of the cell
 			refinee_type type;
 		};
 
+		// Edge counters for each vertex index.
+		// A counter is zero unless it has been incremented in the current refiner pass,
+		// so they never need to be cleared, at the cost of twice the memory of plain counters.
+		struct counter_map {
+			struct entry {
+				SizeType pass = 0;
+				SizeType value = 0;
+			};
+		public:
+
+			void resize(std::size_t n) {
+				entries.resize(n);
+			}
+
+			SizeType operator[](const SizeType v_idx) const {
+				const auto &e = entries[v_idx];
+				return e.pass == pass ? e.value : 0;
+			}
+
+			// returns the new value
+			SizeType increment(const SizeType v_idx) {
+				auto &e = entries[v_idx];
+				if(e.pass != pass) {
+					e.pass = pass;
+					e.value = 0;
+				}
+				return ++e.value;
+			}
+		public:
+			SizeType pass = 0;
+			std::vector<entry> entries;
+		};
+
 		struct refinee_cell {
 			refinee_cell() = default;
 
@@ -64,6 +99,27 @@ public:
 		public:
 			SizeType first, last;
 		};
+	public:
+
+		// Start a new refiner pass, which zeroes all counters and cell counts.
+		void next_pass() {
+			if(++counters.pass != 0) return;
+			// wrapped around, so old stamps could be mistaken for current ones
+			for(auto &e : counters.entries) e.pass = 0;
+			for(auto &d : cell_data) d.pass = 0;
+			counters.pass = 1;
+		}
+
+		// Returns true if the cell is hit for the first time in the current refiner pass.
+		bool hit_cell(cell_data_ &d) {
+			if(d.pass == counters.pass) return false;
+			d.pass = counters.pass;
+			d.hit_count = 0;
+			d.max = 0;
+			d.max_count = 0;
+			d.non_zero_count = 0;
+			return true;
+		}
 	public: // All this data must always be reset after use.
 		// Queue of cells to use as refiner.
 		std::vector<SizeType> refiner_cells;
@@ -71,10 +127,10 @@ public:
 		std::vector<SizeType> refined_beginnings;
 		// The cells that contain neighbours of vertices in the refiner cell.
 		detail::fixed_vector<refinee_cell> refinee_cells;
-		// Group of various data.
+		// Group of various data, the counts are only valid in the pass they were stamped with.
 		std::vector<cell_data_> cell_data;
-		// Edge counters
-		std::vector<SizeType> counters;
+		// Edge counters, stamped with the refiner pass.
+		counter_map counters;
 	};
 
 	template<typename Config, typename TreeNode>
@@ -93,6 +149,13 @@ public:
 		data.counters.resize(n);
 	}
 
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.refiner_cells) + detail::heap_bytes(i_data.refined_beginnings) + detail::heap_bytes(i_data.refinee_cells)
+				+ detail::heap_bytes(i_data.cell_data) + detail::heap_bytes(i_data.counters.entries);
+	}
+
 	template<typename State, typename TreeNode>
 	RefinementResult refine(State &state, TreeNode &node) {
 		using SizeType = typename State::SizeType;
@@ -124,7 +187,8 @@ public:
 					return refine_with_cell(state, node, refiner_begin, refiner_end, result);
 			}();
 
-			if(!continue_) {
+			// a stopped run is aborted as well, the node is then pruned
+			if(!continue_ || state.check_limits()) {
 				clear_remaining_refiners(i_refiner);
 				return RefinementResult::Abort;
 			}
@@ -170,6 +234,7 @@ private:
 		auto &cell_data = i_data.cell_data;
 
 		refinee_cells.clear();
+		i_data.next_pass();
 		// count neighbours
 		count_neighbours_from_singleton(state, node, refiner_begin);
 
@@ -179,8 +244,7 @@ private:
 		});
 
 		const auto clear_refinee_data = [&](const auto refinee_mid) {
-			for(const auto rp : refinee_cells)
-				cell_data[rp.first].hit_count = 0;
+			// the hit counts are cleared by the next pass
 			for(auto iter = refinee_cells.begin(); iter != refinee_mid; ++iter) {
 				sorter.clear_cell_singleton_refiner(state, node, iter->first, iter->last);
 			}
@@ -221,9 +285,9 @@ private:
 		auto &i_data = get(instance_data_t(), state.data);
 		auto &refinee_cells = i_data.refinee_cells;
 		auto &data = i_data.cell_data;
-		auto &counters = i_data.counters;
 
 		refinee_cells.clear();
+		i_data.next_pass();
 		// count neighbours
 		count_neighbours_from_cell(state, node, refiner_begin, refiner_end);
 
@@ -272,30 +336,11 @@ private:
 		}
 
 		const auto clear_refinee_data = [&](const auto refinee_mid) {
-			for(const auto rp : refinee_cells) {
-				data[rp.first].hit_count = 0;
-				data[rp.first].max = 0;
-				data[rp.first].max_count = 0;
-				data[rp.first].non_zero_count = 0;
-			}
-			for(auto iter = refinee_cells.begin(); iter != refinee_mid; ++iter) {
-				const auto cell = iter->first;
-				const auto cell_end = iter->last;
-				const auto first = node.pi.begin() + data[cell].first_non_zero;
-				const auto last = node.pi.begin() + cell_end;
-				for(auto iter = first; iter != last; ++iter)
-					counters[*iter] = 0;
-				sorter.clear_cell(state, node, cell, cell_end);
-			}
-			for(auto iter = refinee_mid; iter != refinee_cells.end(); ++iter) {
-				const auto cell = iter->first;
-				const auto cell_end = iter->last;
-				const auto first = node.pi.begin() + cell;
-				const auto last = node.pi.begin() + cell_end;
-				for(auto iter = first; iter != last; ++iter)
-					counters[*iter] = 0;
-				sorter.clear_cell_aborted(state, node, cell, cell_end);
-			}
+			// the cell data and counters are cleared by the next pass
+			for(auto iter = refinee_cells.begin(); iter != refinee_mid; ++iter)
+				sorter.clear_cell(state, node, iter->first, iter->last);
+			for(auto iter = refinee_mid; iter != refinee_cells.end(); ++iter)
+				sorter.clear_cell_aborted(state, node, iter->first, iter->last);
 		};
 		// cache the end in the start of each iteration so we don't try to refine the same area multiple times
 		const auto refinee_last = refinee_cells.end();
@@ -336,12 +381,10 @@ private:
 		const auto v = vertex(*(pi.begin() + refiner_begin), state.g);
 		const auto *begin_inverse = pi.begin_inverse();
 		for_each_neighbour(state, node, v, [&](const auto e_out, const auto v_idx, const auto cell, const auto cell_end) {
-			auto &hit_count = cell_data[cell].hit_count;
-			const bool has_been_hit = hit_count != 0;
-			if(!has_been_hit) {
+			if(i_data.hit_cell(cell_data[cell])) {
 				refinee_cells.emplace_back(cell, cell_end);
 			}
-			++hit_count;
+			const auto hit_count = ++cell_data[cell].hit_count;
 			const auto v_pos = begin_inverse[v_idx];
 			assert(v_pos >= cell);
 			assert(v_pos < cell_end);
@@ -369,17 +412,14 @@ private:
 			const auto v = vertex(*v_iter, state.g);
 			for_each_neighbour(state, node, v, [&](const auto e_out, const auto v_idx, const auto cell, const auto cell_end) {
 				auto &cell_data = data[cell];
-				auto &hit_count = cell_data.hit_count;
-				const bool has_been_hit = hit_count != 0;
-				if(!has_been_hit) {
+				if(i_data.hit_cell(cell_data)) {
 					refinee_cells.emplace_back(cell, cell_end);
 				}
-				++hit_count;
-				auto &c = counters[v_idx];
-				if(c == 0) {
+				++cell_data.hit_count;
+				const auto c = counters.increment(v_idx);
+				if(c == 1) {
 					++cell_data.non_zero_count;
 				}
-				++c;
 				if(c == cell_data.max) {
 					++cell_data.max_count;
 				} else if(c > cell_data.max) {
@@ -591,7 +631,8 @@ public:
 			}
 		} else {
 			// add all but one of the cells, so let's skip one of the largest cells
-			SizeType max_cell_index = -1;
+			// refined_beginnings.size() means none of the new cells are larger than the remaining one
+			SizeType max_cell_index = refined_beginnings.size();
 			SizeType max_cell_size = pi.get_cell_size(refinee_begin);
 			for(SizeType i_refined_begin = 0; i_refined_begin < refined_beginnings.size(); ++i_refined_begin) {
 				const auto size = pi.get_cell_size(refined_beginnings[i_refined_begin]);
@@ -600,7 +641,7 @@ public:
 					max_cell_index = i_refined_begin;
 				}
 			}
-			if(max_cell_index == -1) {
+			if(max_cell_index == refined_beginnings.size()) {
 				for(const SizeType new_refiner : refined_beginnings) {
 					refiner_cells.push_back(new_refiner);
 					cell_data[new_refiner].is_refiner = true;
@@ -43,17 +43,17 @@ struct refine_degree_1 : null_visitor {
 		auto &pi = node.pi;
 
 		RefinementResult result = RefinementResult::Never;
-		// Cache the cell end both because of efficiency,
-		// but also because if we split the cell we should skip the new ones.
-		SizeType cell_end = 0;
+		// Cache the next non-singleton cell,
+		// as a cell we split into singletons is removed from the list.
+		SizeType next_cell_begin = 0;
 		std::vector<SizeType> aut; // for reporting
-		for(SizeType cell_begin = 0; cell_begin != n; cell_begin = cell_end) {
-			cell_end = pi.get_cell_end(cell_begin);
+		for(SizeType cell_begin = pi.get_first_non_singleton(); cell_begin != n; cell_begin = next_cell_begin) {
+			next_cell_begin = pi.get_next_non_singleton(cell_begin);
+			const SizeType cell_end = pi.get_cell_end(cell_begin);
 			const Vertex v_first = vertex(pi.get(cell_begin), g);
 			const std::size_t d = degree(v_first, g);
 			if(d > 1) continue;
 			if(d == 0) continue;
-			if(cell_end == cell_begin + 1) continue;
 			result = RefinementResult::Unchanged;
 			bool fits = true;
 			const Edge e_first = *out_edges(v_first, g).first;
@@ -0,0 +1,109 @@
+#ifndef GRAPH_CANON_RESOURCE_LIMITS_HPP
+#define GRAPH_CANON_RESOURCE_LIMITS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+namespace graph_canon {
+
+// rst: .. enum-class:: canon_status
+// rst:
+// rst:		How a canonicalization run ended.
+// rst:
+// rst:		.. enumerator:: complete
+// rst:
+// rst:			The search tree was fully explored, so the permutation is canonical.
+// rst:
+// rst:		.. enumerator:: deadline
+// rst:		                tree_node_limit
+// rst:		                leaf_limit
+// rst:		                cancelled
+// rst:
+// rst:			The run was stopped by the corresponding member of `resource_limits`.
+// rst:
+
+enum class canon_status {
+	complete, deadline, tree_node_limit, leaf_limit, cancelled
+};
+
+// rst: .. function:: const char *to_string(canon_status s)
+// rst:
+// rst:		:returns: the name of the status.
+
+inline const char *to_string(canon_status s) {
+	switch(s) {
+	case canon_status::complete: return "complete";
+	case canon_status::deadline: return "deadline";
+	case canon_status::tree_node_limit: return "tree_node_limit";
+	case canon_status::leaf_limit: return "leaf_limit";
+	case canon_status::cancelled: return "cancelled";
+	}
+	return "unknown";
+}
+
+// rst: .. class:: resource_limits
+// rst:
+// rst:		The limits of a canonicalization run, see :expr:`canonicalizer::operator()`.
+// rst:		By default there are no limits.
+// rst:		The budgets of tree nodes and leaves are enforced exactly, as no child is created when the node budget is used up,
+// rst:		and the run stops when a leaf beyond the budget is found, without reporting it.
+// rst:		The cancellation flag and the deadline are polled by the tree traversals before each tree node
+// rst:		and by `refine_WL_1` before each refiner cell,
+// rst:		so a run stops shortly after they are reached, but the time until then depends on the graph.
+// rst:
+
+struct resource_limits {
+	// rst:		.. type:: clock = std::chrono::steady_clock
+	using clock = std::chrono::steady_clock;
+public:
+	// rst:		.. var:: clock::time_point deadline = clock::time_point::max()
+	// rst:
+	// rst:			The point in time after which the run stops.
+	// rst:			The clock is only read at every `deadline_poll_interval` poll.
+	clock::time_point deadline = clock::time_point::max();
+	// rst:		.. var:: std::size_t max_tree_nodes = std::numeric_limits<std::size_t>::max()
+	// rst:
+	// rst:			The maximum number of tree nodes to create, including the root and nodes pruned during their construction.
+	// rst:			Each created node is refined completely, so with 1 only the root is refined.
+	std::size_t max_tree_nodes = std::numeric_limits<std::size_t>::max();
+	// rst:		.. var:: std::size_t max_leaves = std::numeric_limits<std::size_t>::max()
+	// rst:
+	// rst:			The maximum number of leaves to report.
+	std::size_t max_leaves = std::numeric_limits<std::size_t>::max();
+	// rst:		.. var:: const std::atomic<bool> *cancel = nullptr
+	// rst:
+	// rst:			If not `nullptr`, the run stops when the flag becomes `true`, e.g., set by another thread.
+	// rst:			The flag must outlive the run.
+	const std::atomic<bool> *cancel = nullptr;
+	// rst:		.. var:: static constexpr unsigned int deadline_poll_interval = 32
+	static constexpr unsigned int deadline_poll_interval = 32;
+public:
+
+	// rst:		.. function:: resource_limits &set_timeout(clock::duration timeout)
+	// rst:
+	// rst:			Set the `deadline` to `timeout` from now.
+	// rst:
+	// rst:			:returns: `*this`
+
+	resource_limits &set_timeout(clock::duration timeout) {
+		deadline = clock::now() + timeout;
+		return *this;
+	}
+
+	// rst:		.. function:: bool is_unlimited() const
+	// rst:
+	// rst:			:returns: whether none of the limits are set.
+
+	bool is_unlimited() const {
+		return deadline == clock::time_point::max()
+				&& max_tree_nodes == std::numeric_limits<std::size_t>::max()
+				&& max_leaves == std::numeric_limits<std::size_t>::max()
+				&& !cancel;
+	}
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_RESOURCE_LIMITS_HPP */
@@ -17,14 +17,8 @@ struct target_cell_f : null_visitor {
 
 	template<typename State, typename TreeNode>
 	std::size_t select_target_cell(const State &state, const TreeNode &t) const {
-		const auto &pi = t.pi;
-		for(std::size_t cell_begin = 0;
-				cell_begin < state.n;
-				cell_begin = pi.get_cell_end(cell_begin)) {
-			std::size_t cell_end = pi.get_cell_end(cell_begin);
-			if(cell_end - cell_begin > 1) return cell_begin;
-		}
-		return state.n;
+		// the first non-singleton cell, or state.n for a discrete partition
+		return t.pi.get_first_non_singleton();
 	}
 };
 
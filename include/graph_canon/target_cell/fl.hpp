@@ -20,9 +20,9 @@ struct target_cell_fl : null_visitor {
     const auto &pi = t.pi;
     std::size_t max_size = 1;
     std::size_t result = state.n;
-    for(std::size_t cell_begin = 0;
-            cell_begin < state.n;
-            cell_begin = pi.get_cell_end(cell_begin)) {
+    for(std::size_t cell_begin = pi.get_first_non_singleton();
+            cell_begin != state.n;
+            cell_begin = pi.get_next_non_singleton(cell_begin)) {
       std::size_t cell_end = pi.get_cell_end(cell_begin);
       if(cell_end - cell_begin > max_size) {
         result = cell_begin;
@@ -2,6 +2,7 @@
 #define GRAPH_CANON_TARGET_CELL_FLM_HPP
 
 #include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 namespace graph_canon {
 
@@ -43,6 +44,12 @@ struct target_cell_flm : null_visitor {
 		get(instance_data_t(), state.data).data.resize(state.n);
 	}
 
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.data) + detail::heap_bytes(i_data.cells);
+	}
+
 	template<typename State, typename TreeNode>
 	std::size_t select_target_cell(State &state, const TreeNode &t) {
 		auto result = find_cell(state, t, [&](const auto cell, const auto cell_end) {
@@ -70,10 +77,8 @@ private:
 		SizeType max_size = 1;
 		SizeType max_joined = 0;
 		SizeType result = state.n;
-		SizeType cell_end;
-		for(SizeType cell_begin = 0; cell_begin != state.n; cell_begin = cell_end) {
-			cell_end = pi.get_cell_end(cell_begin);
-			if(cell_begin + 1 == cell_end) continue;
+		for(SizeType cell_begin = pi.get_first_non_singleton(); cell_begin != state.n; cell_begin = pi.get_next_non_singleton(cell_begin)) {
+			const SizeType cell_end = pi.get_cell_end(cell_begin);
 			if(!pred(cell_begin, cell_end)) continue;
 			const SizeType v_idx = pi.get(cell_begin);
 			const auto *begin_inverse = t.pi.begin_inverse();
@@ -2,6 +2,7 @@
 #define GRAPH_CANON_TARGET_CELL_FLMCR_HPP
 
 #include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/memory.hpp>
 
 namespace graph_canon {
 
@@ -40,20 +41,22 @@ struct target_cell_flmcr : null_visitor {
 		get(instance_data_t(), state.data).data.resize(state.n);
 	}
 
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &i_data = get(instance_data_t(), state.data);
+		return detail::heap_bytes(i_data.data) + detail::heap_bytes(i_data.cells);
+	}
+
 	template<typename State, typename TreeNode>
 	std::size_t select_target_cell(State &state, const TreeNode &t) {
 		const auto result = find_cell(state, t);
 		if(result != state.n) {
 			return result;
 		} else {
-			for(std::size_t cell_begin = 0;
-					cell_begin < state.n;
-					cell_begin = t.pi.get_cell_end(cell_begin)) {
-				std::size_t cell_end = t.pi.get_cell_end(cell_begin);
-				if(cell_end - cell_begin > 1) {
-					std::cout << "TargetCell   res=" << result << std::endl;
-					return cell_begin;
-				}
+			const std::size_t cell_begin = t.pi.get_first_non_singleton();
+			if(cell_begin != state.n) {
+				std::cout << "TargetCell   res=" << result << std::endl;
+				return cell_begin;
 			}
 			__builtin_unreachable();
 		}
@@ -102,19 +105,15 @@ private:
 		auto &i_data = get(instance_data_t(), state.data);
 		auto &data = i_data.data;
 		{ // initialize components to be individual
-			SizeType cell_end;
-			for(SizeType cell = 0; cell != state.n; cell = cell_end) {
-				cell_end = pi.get_cell_end(cell);
-				if(cell + 1 == cell_end) continue;
+			for(SizeType cell = pi.get_first_non_singleton(); cell != state.n; cell = pi.get_next_non_singleton(cell)) {
+				const SizeType cell_end = pi.get_cell_end(cell);
 				if(cell + 2 == cell_end) continue;
 				data[cell].component = cell;
 			}
 		}
 		{ // find the components, and record the each cells degree
-			SizeType cell_end;
-			for(SizeType cell = 0; cell != state.n; cell = cell_end) {
-				cell_end = pi.get_cell_end(cell);
-				if(cell + 1 == cell_end) continue;
+			for(SizeType cell = pi.get_first_non_singleton(); cell != state.n; cell = pi.get_next_non_singleton(cell)) {
+				const SizeType cell_end = pi.get_cell_end(cell);
 				if(cell + 2 == cell_end) continue;
 				find_non_uniform(state, t, cell, [&](const auto cell_other) {
 					++data[cell].degree;
@@ -126,10 +125,8 @@ private:
 			}
 		}
 		const SizeType comp = [&]() {
-			SizeType cell_end;
-			for(SizeType cell = 0; cell != state.n; cell = cell_end) {
-				cell_end = pi.get_cell_end(cell);
-				if(cell + 1 == cell_end) continue;
+			for(SizeType cell = pi.get_first_non_singleton(); cell != state.n; cell = pi.get_next_non_singleton(cell)) {
+				const SizeType cell_end = pi.get_cell_end(cell);
 				if(cell + 2 == cell_end) continue;
 				assert(data[cell].component == cell);
 				return cell;
@@ -141,10 +138,8 @@ private:
 		SizeType max_size = 1;
 		SizeType max_joined = 0;
 		SizeType result = state.n;
-		SizeType cell_end;
-		for(SizeType cell = comp; cell != state.n; cell = cell_end) {
-			cell_end = pi.get_cell_end(cell);
-			if(cell + 1 == cell_end) continue;
+		for(SizeType cell = comp; cell != state.n; cell = pi.get_next_non_singleton(cell)) {
+			const SizeType cell_end = pi.get_cell_end(cell);
 			if(cell + 2 == cell_end) continue;
 			if(data[cell].component != comp) continue;
 			const SizeType num_non_uniform = data[cell].degree;
@@ -160,8 +155,8 @@ private:
 			}
 		}
 		assert(result != state.n);
-		// cleanup
-		for(SizeType cell_begin = 0; cell_begin != state.n; cell_begin = cell_end) {
+		// cleanup, the size is also counted for singleton cells reached through find_non_uniform
+		for(SizeType cell_begin = 0; cell_begin != state.n; cell_begin = pi.get_cell_end(cell_begin)) {
 			data[cell_begin].degree = 0;
 			data[cell_begin].size = 0;
 		}
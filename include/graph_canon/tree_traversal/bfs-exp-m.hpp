@@ -4,6 +4,7 @@
 #include <graph_canon/tagged_list.hpp>
 
 #include <graph_canon/tree_traversal/dfs.hpp>
+#include <graph_canon/detail/memory.hpp>
 #include <graph_canon/detail/visitor_utils.hpp>
 
 #include <cassert>
@@ -27,9 +28,6 @@ struct traversal_bfs_exp_m : null_visitor {
 
 	template<typename SizeType, typename TreeNode>
 	struct instance_data {
-		std::size_t num_nodes = 0;
-		std::size_t max_num_nodes;
-		bool use_dfs = false;
 		std::vector<traversal_dfs::elem<SizeType, TreeNode> > dfs_stack;
 	};
 
@@ -58,8 +56,9 @@ public:
 	// rst:		.. function:: traversal_bfs_exp_m(const std::size_t max_mem_mb)
 	// rst:
 	// rst:			Construct with a given memory limit, in multiples of :math:`1024*1024` bytes.
-	// rst:			Note that memory usage is calculated conservatively and the algorithm uses slightly more meory.
-	// rst:			Memory usage by individual visitors is not factored in at this time.
+	// rst:			The limit lowers the memory budget of the `canon_state`, see :expr:`canon_state::limit_memory`.
+	// rst:			When the budget is exceeded, the experimental paths are replaced by depth-first traversals of their subtrees.
+	// rst:			The tree nodes already created are kept, so the budget may still be exceeded by the nodes of a single depth-first path.
 	traversal_bfs_exp_m(const std::size_t max_mem_mb) : max_mem_mb(max_mem_mb) { }
 private:
 
@@ -72,33 +71,29 @@ private:
 	static void keep_alive_end(TreeNode &t) {
 		get(tree_data_t(), t.data).keep_alive = nullptr;
 	}
+
+	// after the run was stopped, break the references of the level lists and of the nodes kept alive
+
+	template<typename TreeNode>
+	static void release_tree(TreeNode &t) {
+		const typename TreeNode::OwnerPtr self(&t);
+		for(std::size_t i = 0; i != t.children.size(); ++i)
+			if(t.children[i]) release_tree(*t.children[i]);
+		get(tree_data_t(), t.data).level_next = nullptr;
+		keep_alive_end(t);
+	}
 public:
 
 	template<typename State>
 	void initialize(State &state) {
 		auto &i_data = get(instance_data_t(), state.data);
-		const auto mem_per_node = state.n * 4 * sizeof (typename State::SizeType);
-		i_data.max_num_nodes = max_mem_mb * 1024 * 1024 / mem_per_node;
-		if(i_data.max_num_nodes == 0) i_data.max_num_nodes = 1;
-	}
-
-	template<typename State, typename TreeNode>
-	bool tree_create_node_begin(State &state, TreeNode &t) {
-		auto &i_data = get(instance_data_t(), state.data);
-		++i_data.num_nodes;
-		if(i_data.num_nodes == i_data.max_num_nodes) {
-			i_data.use_dfs = true;
-		}
-		return true;
+		i_data.dfs_stack.clear();
+		state.limit_memory(max_mem_mb * 1024 * 1024);
 	}
 
-	template<typename State, typename TreeNode>
-	void tree_destroy_node(State &state, TreeNode &t) {
-		auto &i_data = get(instance_data_t(), state.data);
-		if(i_data.num_nodes == i_data.max_num_nodes) {
-			i_data.use_dfs = false;
-		}
-		--i_data.num_nodes;
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		return detail::heap_bytes(get(instance_data_t(), state.data).dfs_stack);
 	}
 
 	template<typename State, typename TreeNode>
@@ -112,9 +107,10 @@ public:
 		using OwnerPtr = typename TreeNode::OwnerPtr;
 		const auto makeExperimentalPath = [&state](OwnerPtr node) {
 			while(true) {
+				if(state.check_limits()) return;
 				assert(!node->get_is_pruned());
 				auto &i_data = get(instance_data_t(), state.data);
-				if(i_data.use_dfs) {
+				if(state.is_memory_exceeded()) {
 					get(tree_data_t(), node->data).is_dfs_root = true;
 					i_data.dfs_stack.reserve(state.n);
 					traversal_dfs::traverse(state, i_data.dfs_stack, node);
@@ -133,6 +129,8 @@ public:
 				for(; next_child_index < node->children.size(); ++next_child_index) {
 					if(node->child_pruned[next_child_index]) continue;
 					if(node->children[next_child_index]) continue;
+					// the children may all be pruned during their construction
+					if(state.check_limits()) return;
 					child = node->create_child(next_child_index + node->get_child_refiner_cell(), state);
 					if(child) break; // yay
 				}
@@ -151,10 +149,10 @@ public:
 		makeExperimentalPath(state.root);
 		OwnerPtr head = state.root;
 		OwnerPtr headChildren;
-		while(head) {
+		while(head && !state.check_limits()) {
 			OwnerPtr *prevChildNext = &headChildren;
 			OwnerPtr nodeNext = nullptr;
-			for(OwnerPtr node = head; node; node = nodeNext) {
+			for(OwnerPtr node = head; node && !state.check_limits(); node = nodeNext) {
 				auto &t_data = get(tree_data_t(), node->data);
 				nodeNext = t_data.level_next;
 				// release from the level list
@@ -168,6 +166,7 @@ public:
 					continue; // just skip it, it was processed in makeExperimentalPath
 				}
 				for(std::size_t next_child_index = 0; next_child_index < node->children.size(); ++next_child_index) {
+					if(state.check_limits()) break;
 					// the experimental paths we create might, for example, discover automorphisms
 					state.visitor.tree_before_descend(state, *node);
 					if(node->get_is_pruned()) break;
@@ -194,6 +193,7 @@ public:
 			*prevChildNext = nullptr;
 			std::swap(head, headChildren);
 		}
+		if(state.is_stopped()) release_tree(*state.root);
 	}
 private:
 	const std::size_t max_mem_mb;
@@ -46,6 +46,18 @@ private:
 	static void keep_alive_end(TreeNode &t) {
 		get(tree_data_t(), t.data).keep_alive = nullptr;
 	}
+
+	// After the run was stopped, break the references of the level lists and of the nodes kept alive,
+	// so the remaining tree is released when the traversal returns.
+
+	template<typename TreeNode>
+	static void release_tree(TreeNode &t) {
+		const typename TreeNode::OwnerPtr self(&t);
+		for(std::size_t i = 0; i != t.children.size(); ++i)
+			if(t.children[i]) release_tree(*t.children[i]);
+		get(tree_data_t(), t.data).level_next = nullptr;
+		keep_alive_end(t);
+	}
 public:
 
 	template<typename State, typename TreeNode>
@@ -59,6 +71,7 @@ public:
 		using OwnerPtr = typename TreeNode::OwnerPtr;
 		const auto makeExperimentalPath = [&state](OwnerPtr node) {
 			while(true) {
+				if(state.check_limits()) return;
 				assert(!node->get_is_pruned());
 				state.visitor.tree_before_descend(state, *node);
 				// search for a child: not pruned, not existing, and isn't immediately pruned in the construction
@@ -73,6 +86,8 @@ public:
 				for(; next_child_index < node->children.size(); ++next_child_index) {
 					if(node->child_pruned[next_child_index]) continue;
 					if(node->children[next_child_index]) continue;
+					// the children may all be pruned during their construction
+					if(state.check_limits()) return;
 					child = node->create_child(next_child_index + node->get_child_refiner_cell(), state);
 					if(child) break; // yay
 				}
@@ -91,10 +106,10 @@ public:
 		makeExperimentalPath(state.root);
 		OwnerPtr head = state.root;
 		OwnerPtr headChildren;
-		while(head) {
+		while(head && !state.check_limits()) {
 			OwnerPtr *prevChildNext = &headChildren;
 			OwnerPtr nodeNext = nullptr;
-			for(OwnerPtr node = head; node; node = nodeNext) {
+			for(OwnerPtr node = head; node && !state.check_limits(); node = nodeNext) {
 				auto &data = get(tree_data_t(), node->data);
 				nodeNext = data.level_next;
 				// release from the level list
@@ -108,6 +123,7 @@ public:
 					continue; // just skip it, it was processed in makeExperimentalPath
 				}
 				for(std::size_t next_child_index = 0; next_child_index < node->children.size(); ++next_child_index) {
+					if(state.check_limits()) break;
 					// the experimental paths we create might, for example, discover automorphisms
 					state.visitor.tree_before_descend(state, *node);
 					if(node->get_is_pruned()) break;
@@ -132,6 +148,7 @@ public:
 			*prevChildNext = nullptr;
 			std::swap(head, headChildren);
 		}
+		if(state.is_stopped()) release_tree(*state.root);
 	}
 };
 
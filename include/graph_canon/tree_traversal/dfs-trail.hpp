@@ -0,0 +1,126 @@
+#ifndef GRAPH_CANON_TREE_TRAVERSAL_DFS_TRAIL_HPP
+#define GRAPH_CANON_TREE_TRAVERSAL_DFS_TRAIL_HPP
+
+#include <graph_canon/edge_handler/edge_handler.hpp>
+#include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/partition.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: .. class:: traversal_dfs_trail
+// rst:
+// rst:		Tree traversal visitor for depth-first traversal, where all tree nodes on the current path
+// rst:		share a single ordered partition instead of each having their own copy.
+// rst:		All changes to the shared partition are recorded in a trail,
+// rst:		and backtracking is done by undoing the recorded changes.
+// rst:		This reduces the memory needed for the partitions from :math:`O(dn)` to :math:`O(n + t)`,
+// rst:		for a tree of depth :math:`d` and a trail of length :math:`t`, and avoids copying a partition for each child.
+// rst:		Leaves get their own copy of the partition before they are reported.
+// rst:
+// rst:		Note that with this traversal `tree_node::pi` is only valid for the current tree node and for leaves.
+// rst:		Visitors must use `tree_node::get_child_element` to access the target cell of other tree nodes.
+// rst:		When the traversal ends, the non-leaf nodes still alive, e.g., the ancestors of the best leaf, are left with an empty `pi`.
+// rst:		The visitors in this library satisfy this requirement.
+// rst:		The `EdgeHandler` must declare `supports_partition_trail`, which is checked at compile time.
+// rst:
+// rst:		The class is DefaultConstructible.
+// rst:
+
+struct traversal_dfs_trail : null_visitor {
+	using can_explore_tree = std::true_type;
+
+	template<typename SizeType, typename TreeNode>
+	struct elem {
+
+		elem(const typename TreeNode::OwnerPtr &node, SizeType next_child, std::size_t mark)
+		: node(node), next_child(next_child), mark(mark) { }
+	public:
+		typename TreeNode::OwnerPtr node;
+		SizeType next_child;
+		std::size_t mark; // the size of the trail before the node was created
+	};
+
+	template<typename State>
+	static void explore_tree(State &state) {
+		using SizeType = typename State::SizeType;
+		using TreeNode = typename State::TreeNode;
+		using Elem = elem<SizeType, TreeNode>;
+		static_assert(edge_handler_supports_partition_trail<typename State::EHandler>::value,
+				"The edge handler must support partition trails, see EdgeHandler::supports_partition_trail.");
+		detail::partition_trail<SizeType> trail(state.root->pi);
+		// destroyed after the work stack has released its nodes, but before the trail
+		const release_guard<State> release(state);
+		std::vector<Elem> work_stack;
+		work_stack.reserve(state.n);
+		work_stack.emplace_back(state.root, 0, trail.size());
+		while(!work_stack.empty()) {
+			if(state.check_limits()) {
+				// release the nodes sharing the partition before the trail
+				work_stack.clear();
+				return;
+			}
+			typename TreeNode::OwnerPtr parent = work_stack.back().node;
+			std::size_t next_child_index = work_stack.back().next_child;
+			const std::size_t mark = work_stack.back().mark;
+			work_stack.pop_back();
+			// the shared partition now represents the partition of parent
+			// update the node
+			state.visitor.tree_before_descend(state, *parent);
+			// skip if pruned, and backtrack
+			if(parent->get_is_pruned()) {
+				trail.undo(mark);
+				continue;
+			}
+			// skip pruned children
+			while(next_child_index < parent->children.size() && parent->child_pruned[next_child_index])
+				next_child_index++;
+			if(next_child_index < parent->children.size()) {
+				// we still have children to explore
+				work_stack.emplace_back(parent, next_child_index + 1, mark);
+				const std::size_t child_mark = trail.open_frame();
+				typename TreeNode::OwnerPtr child = parent->create_child(next_child_index + parent->get_child_refiner_cell(), state, trail);
+				// if the child got pruned already, don't add it, but undo its changes
+				if(child) work_stack.emplace_back(child, 0, child_mark);
+				else trail.undo(child_mark);
+			} else {
+				if(next_child_index == 0) {
+					// this is actually a leaf node, which may be kept alive after we backtrack
+					assert(parent->pi.get_num_cells() == state.n);
+					parent->detach_partition();
+					state.report_leaf(parent);
+				}
+				trail.undo(mark);
+			}
+		}
+	}
+private:
+
+	// Releases the shared partitions of all nodes still alive, which are exactly those reachable from the root.
+
+	template<typename State>
+	struct release_guard {
+		release_guard(State &state) : state(state) { }
+
+		~release_guard() {
+			using TreeNode = typename State::TreeNode;
+			std::vector<TreeNode*> stack{state.root.get()};
+			while(!stack.empty()) {
+				TreeNode *t = stack.back();
+				stack.pop_back();
+				t->release_shared_partition();
+				for(TreeNode *child : t->children)
+					if(child) stack.push_back(child);
+			}
+		}
+	private:
+		State &state;
+	};
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_TREE_TRAVERSAL_DFS_TRAIL_HPP */
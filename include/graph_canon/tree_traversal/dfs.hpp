@@ -37,12 +37,30 @@ struct traversal_dfs : null_visitor {
 
 	template<typename State, typename Stack>
 	static void traverse(State &state, Stack &work_stack, typename State::TreeNode::OwnerPtr t_ptr) {
+		traverse(state, work_stack, t_ptr, [](const auto &parent, const auto next_child_index) {
+			return true;
+		});
+	}
+
+	// before_descend(parent, next_child_index) is called before updating each node,
+	// and the traversal is stopped if it returns false, or if the limits of the state are reached
+
+	template<typename State, typename Stack, typename BeforeDescend>
+	static void traverse(State &state, Stack &work_stack, typename State::TreeNode::OwnerPtr t_ptr, BeforeDescend before_descend) {
 		using TreeNode = typename State::TreeNode;
 		work_stack.emplace_back(t_ptr, 0);
 		while(!work_stack.empty()) {
+			if(state.check_limits()) {
+				work_stack.clear();
+				return;
+			}
 			typename TreeNode::OwnerPtr parent = work_stack.back().node;
 			std::size_t next_child_index = work_stack.back().next_child;
 			work_stack.pop_back();
+			if(!before_descend(*parent, next_child_index)) {
+				work_stack.clear();
+				return;
+			}
 			// update the node
 			state.visitor.tree_before_descend(state, *parent);
 			// skip if pruned
@@ -0,0 +1,325 @@
+#ifndef GRAPH_CANON_TREE_TRAVERSAL_PARALLEL_HPP
+#define GRAPH_CANON_TREE_TRAVERSAL_PARALLEL_HPP
+
+#include <graph_canon/tagged_list.hpp>
+#include <graph_canon/tree_traversal/dfs.hpp>
+#include <graph_canon/visitor/visitor.hpp>
+#include <graph_canon/detail/concurrent_search.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graph_canon {
+
+// rst: .. class:: traversal_parallel
+// rst:
+// rst:		Tree traversal visitor for depth-first traversal, where the subtrees of the root are divided between threads.
+// rst:
+// rst:		Each thread owns a separate `canon_state`, with its own copy of the visitor, the edge handler, and the node allocator,
+// rst:		and repeatedly claims the next child of the root, in the order of the children, and explores its subtree depth-first.
+// rst:		The threads share:
+// rst:
+// rst:		- The automorphisms found by comparing leaves.
+// rst:		  Before descending into a tree node, each thread reports the automorphisms published by the other threads
+// rst:		  through `Visitor::automorphism_implicit` with the tag `aut_tag_shared`, so automorphism pruners can prune with them.
+// rst:		- The best leaf found by each thread, as its path of child indices from the root.
+// rst:		  Before descending into a tree node, each thread recreates the new best leaves of the other threads
+// rst:		  that are in subtrees of the root before its current one, and reports them as leaves,
+// rst:		  so the node invariants and the leaves of the thread are compared with the best of them.
+// rst:		  Leaves in later subtrees are not used, as the thread may then prune subtrees with leaves that are equal but come first.
+// rst:
+// rst:		When all children of the root have been claimed and explored, the best leaves of the threads are compared
+// rst:		in a separate state, in the order of their paths, and only the path to the best of them is recreated
+// rst:		in the state of the run, after all automorphisms have been reported to it.
+// rst:		The result is thus the same as for `traversal_dfs`, the first leaf in depth-first order of those
+// rst:		with the best node invariants and the smallest permuted graph, so the permutation does not depend on the thread timing.
+// rst:		The state of the run only has the root and this path, so visitors like `stats_visitor` only count those nodes,
+// rst:		and the events of the other states are lost with them.
+// rst:
+// rst:		The states of the threads have the limits of the run, so the budgets of tree nodes and leaves apply to each thread,
+// rst:		but when one thread reaches a limit, all threads stop, and the run is stopped with that status
+// rst:		after the best leaf found so far has been recreated.
+// rst:		The visitor is copied for each thread, so all visitors must be copyable,
+// rst:		and they should not have side effects outside their instance data (e.g., `debug_visitor` should not be used).
+// rst:		The graph and the index map are read concurrently by all threads.
+// rst:
+
+struct traversal_parallel : null_visitor {
+	using can_explore_tree = std::true_type;
+	// rst:		.. var:: static constexpr std::size_t aut_tag_shared = 300
+	// rst:
+	// rst:			The tag used for reporting automorphisms found by other threads.
+	static constexpr std::size_t aut_tag_shared = 300;
+private:
+
+	// The data shared by the threads of a run.
+
+	template<typename SizeType>
+	struct search {
+
+		search(std::size_t num_threads, const std::atomic<bool> *cancel) : cancel(cancel), bests(num_threads) { }
+
+		// returns the index of the next child of the root to explore
+
+		std::size_t claim_child() {
+			return next_child.fetch_add(1);
+		}
+
+		template<typename TreeNode>
+		void publish_best(const std::size_t id, const TreeNode &leaf) {
+			std::vector<SizeType> path(leaf.level);
+			for(const TreeNode *t = &leaf; t->get_parent(); t = t->get_parent())
+				path[t->level - 1] = t->get_child_offset();
+			std::lock_guard<std::mutex> lock(m);
+			bests[id].path = std::move(path);
+			++bests[id].version;
+			num_changes.fetch_add(1, std::memory_order_release);
+		}
+
+		// append the best leaves of the other threads in subtrees of the root before child_end,
+		// which have changed since the versions in seen, and update those
+
+		void fetch_bests(const std::size_t id, const std::size_t child_end, std::vector<std::size_t> &seen,
+				std::vector<std::vector<SizeType> > &paths) const {
+			std::lock_guard<std::mutex> lock(m);
+			for(std::size_t i = 0; i != bests.size(); ++i) {
+				const auto &b = bests[i];
+				if(i == id || b.version == seen[i] || b.path.front() >= child_end) continue;
+				seen[i] = b.version;
+				paths.push_back(b.path);
+			}
+		}
+
+		// the best leaves of all threads, in the order of their paths
+
+		std::vector<std::vector<SizeType> > get_bests() const {
+			std::vector<std::vector<SizeType> > paths;
+			std::lock_guard<std::mutex> lock(m);
+			for(const auto &b : bests)
+				if(b.version != 0) paths.push_back(b.path);
+			std::sort(paths.begin(), paths.end());
+			return paths;
+		}
+
+		// record why a thread stopped, and stop the others
+
+		void stop(const canon_status s) {
+			{
+				std::lock_guard<std::mutex> lock(m);
+				if(status == canon_status::complete) status = s;
+			}
+			auts.done = true;
+		}
+
+		canon_status get_status() const {
+			std::lock_guard<std::mutex> lock(m);
+			return status;
+		}
+	public:
+		detail::shared_automorphisms<SizeType> auts;
+		const std::atomic<bool> *cancel; // the cancellation flag of the run
+		std::atomic<std::size_t> num_changes{0}; // of the best leaves
+	private:
+		struct best {
+			std::vector<SizeType> path;
+			std::size_t version = 0; // 0 until a leaf has been found
+		};
+	private:
+		mutable std::mutex m;
+		std::vector<best> bests;
+		canon_status status = canon_status::complete;
+		std::atomic<std::size_t> next_child{0};
+	};
+
+	// The view of a single thread on the shared data.
+
+	template<typename SizeType>
+	struct thread_data {
+
+		void attach(search<SizeType> *shared, const std::size_t id, const std::size_t num_threads) {
+			this->shared = shared;
+			auts.attach(shared ? &shared->auts : nullptr, id);
+			current_child = 0;
+			importing = false;
+			seen_changes = 0;
+			seen_child = 0;
+			seen_versions.assign(num_threads, 0);
+		}
+	public:
+		detail::concurrent_search_data<SizeType> auts;
+		search<SizeType> *shared = nullptr;
+		std::size_t current_child; // the child of the root being explored
+		bool importing; // whether the best leaves of other threads are being reported
+		std::size_t seen_changes, seen_child; // when the best leaves were last fetched
+		std::vector<std::size_t> seen_versions;
+		std::vector<std::vector<SizeType> > paths; // buffer
+	};
+public:
+
+	struct instance_data_t {
+	};
+
+	template<typename Config, typename TreeNode>
+	struct InstanceData {
+		using type = tagged_element<instance_data_t, thread_data<typename Config::SizeType> >;
+	};
+public:
+
+	// rst:		.. function:: traversal_parallel(std::size_t num_threads = std::thread::hardware_concurrency())
+	// rst:
+	// rst:			:param num_threads: the total number of threads, including the calling thread.
+	// rst:				With at most 1 thread the traversal is equivalent to `traversal_dfs`.
+
+	traversal_parallel(std::size_t num_threads = std::thread::hardware_concurrency()) : num_threads(num_threads) { }
+
+	template<typename State>
+	void initialize(State &state) {
+		get(instance_data_t(), state.data).attach(nullptr, 0, 0);
+	}
+
+	template<typename State, typename TreeNode>
+	void canon_new_best(State &state, TreeNode *previous) {
+		auto &i_data = get(instance_data_t(), state.data);
+		if(!i_data.shared || i_data.importing) return;
+		i_data.shared->publish_best(i_data.auts.id, *state.get_canon_leaf());
+	}
+
+	template<typename State, typename TreeNode, typename Perm>
+	void automorphism_leaf(State &state, TreeNode &t, const Perm &aut) {
+		get(instance_data_t(), state.data).auts.publish(state, aut);
+	}
+
+	template<typename State>
+	void explore_tree(State &state) {
+		using SizeType = typename State::SizeType;
+		using Partition = typename State::Partition;
+		const std::size_t num_root_children = state.root->children.size();
+		if(num_threads <= 1 || num_root_children <= 1) {
+			traversal_dfs::explore_tree(state);
+			return;
+		}
+		const std::size_t num_workers = std::min(num_threads, num_root_children);
+		search<SizeType> shared(num_workers, state.get_limits().cancel);
+		{
+			detail::helper_searches<State> helpers(state, num_workers - 1, shared.auts, [&shared, num_workers](State &w_state, std::size_t id) {
+				work(w_state, shared, id, num_workers);
+			});
+			typename State::EHandler edge_handler = state.edge_handler;
+			{
+				State w_state(state.g, state.idx, edge_handler, state.visitor, always_false(), Partition(state.root->pi),
+						nullptr, helpers.get_limits());
+				work(w_state, shared, 0, num_workers);
+			}
+			helpers.wait();
+		}
+		const auto no_descend = [](auto &t) { };
+		// compare the best leaves in the order of their paths, so the first of equal leaves is kept
+		std::vector<SizeType> winner;
+		{
+			typename State::EHandler edge_handler = state.edge_handler;
+			State m_state(state.g, state.idx, edge_handler, state.visitor, always_false(), Partition(state.root->pi), nullptr);
+			for(const auto &path : shared.get_bests())
+				report_path(m_state, path, no_descend);
+			if(const auto *leaf = m_state.get_canon_leaf()) {
+				winner.resize(leaf->level);
+				for(auto *t = leaf; t->get_parent(); t = t->get_parent())
+					winner[t->level - 1] = t->get_child_offset();
+			}
+		}
+		auto &i_data = get(instance_data_t(), state.data);
+		i_data.attach(&shared, num_workers, num_workers); // not an owner, so all automorphisms are reported
+		i_data.auts.report_new(state, *state.root, aut_tag_shared);
+		i_data.attach(nullptr, 0, 0);
+		if(!winner.empty()) report_path(state, winner, no_descend);
+		const canon_status status = shared.get_status();
+		if(status != canon_status::complete) state.stop(status);
+	}
+private:
+
+	template<typename State, typename SizeType>
+	static void work(State &state, search<SizeType> &shared, const std::size_t id, const std::size_t num_threads) {
+		using TreeNode = typename State::TreeNode;
+		using Elem = traversal_dfs::elem<SizeType, TreeNode>;
+		auto &i_data = get(instance_data_t(), state.data);
+		i_data.attach(&shared, id, num_threads);
+		std::vector<Elem> work_stack;
+		work_stack.reserve(state.n);
+		const auto before_descend = [&](TreeNode &t, const std::size_t next_child_index) {
+			if(state.check_limits()) return false; // includes the done flag
+			if(shared.cancel && shared.cancel->load(std::memory_order_relaxed)) {
+				shared.stop(canon_status::cancelled);
+				return false;
+			}
+			i_data.auts.report_new(state, t, aut_tag_shared);
+			import_bests(state, i_data);
+			return true;
+		};
+		TreeNode &root = *state.root;
+		while(true) {
+			const std::size_t child_index = shared.claim_child();
+			if(child_index >= root.children.size()) break;
+			i_data.current_child = child_index;
+			if(!before_descend(root, child_index)) break;
+			state.visitor.tree_before_descend(state, root);
+			if(root.get_is_pruned()) break;
+			if(root.child_pruned[child_index] || root.children[child_index]) continue;
+			auto child = root.create_child(child_index + root.get_child_refiner_cell(), state);
+			if(child) traversal_dfs::traverse(state, work_stack, child, before_descend);
+			if(state.is_stopped()) break;
+		}
+		// a cancelled state was stopped by another thread, or by the flag of the run
+		if(state.is_stopped() && state.get_status() != canon_status::cancelled)
+			shared.stop(state.get_status());
+		i_data.attach(nullptr, 0, 0);
+	}
+
+	template<typename State, typename ThreadData>
+	static void import_bests(State &state, ThreadData &i_data) {
+		const std::size_t num_changes = i_data.shared->num_changes.load(std::memory_order_acquire);
+		if(num_changes == i_data.seen_changes && i_data.current_child == i_data.seen_child) return;
+		i_data.seen_changes = num_changes;
+		i_data.seen_child = i_data.current_child;
+		i_data.shared->fetch_bests(i_data.auts.id, i_data.current_child, i_data.seen_versions, i_data.paths);
+		i_data.importing = true;
+		for(const auto &path : i_data.paths) {
+			report_path(state, path, [&state](auto &t) {
+				state.visitor.tree_before_descend(state, t);
+			});
+		}
+		i_data.importing = false;
+		i_data.paths.clear();
+	}
+
+	// Recreate the leaf with the given path from the root, and report it, unless it has been reported before.
+	// before_descend(t) is called for each node on the path, before its child is taken,
+	// and nothing is reported if a node on the path is pruned.
+
+	template<typename State, typename Path, typename BeforeDescend>
+	static void report_path(State &state, const Path &path, BeforeDescend before_descend) {
+		using OwnerPtr = typename State::TreeNode::OwnerPtr;
+		OwnerPtr node = state.root;
+		bool is_new = false;
+		for(const auto child_index : path) {
+			before_descend(*node);
+			if(node->get_is_pruned() || node->child_pruned[child_index]) return;
+			OwnerPtr child = node->children[child_index];
+			is_new = !child;
+			if(is_new) child = node->create_child(child_index + node->get_child_refiner_cell(), state);
+			if(!child) return;
+			node = std::move(child);
+		}
+		if(!is_new) return;
+		assert(node->pi.get_num_cells() == state.n);
+		state.report_leaf(node);
+	}
+private:
+	std::size_t num_threads;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_TREE_TRAVERSAL_PARALLEL_HPP */
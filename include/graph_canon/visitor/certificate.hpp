@@ -0,0 +1,33 @@
+#ifndef GRAPH_CANON_VISITOR_CERTIFICATE_HPP
+#define GRAPH_CANON_VISITOR_CERTIFICATE_HPP
+
+#include <graph_canon/visitor/visitor.hpp>
+
+#include <cstdint>
+
+namespace graph_canon {
+
+// rst: .. class:: certificate_visitor
+// rst:
+// rst:		A visitor for returning the certificate of the canonical form, see `canon_state::get_canon_certificate`.
+// rst:		The certificate can for example be used as a key for removing isomorphic duplicates from a collection of graphs,
+// rst:		without first building an `ordered_graph` for each of them.
+// rst:
+
+struct certificate_visitor : null_visitor {
+	// rst:		.. class:: result_t
+	// rst:
+	// rst:			The tag type used for returning the certificate, as a `std::uint64_t`.
+
+	struct result_t {
+	};
+
+	template<typename State>
+	tagged_element<result_t, std::uint64_t> extract_result(State &state) {
+		return {state.get_canon_certificate()};
+	}
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_VISITOR_CERTIFICATE_HPP */
@@ -280,6 +280,24 @@ public:
 			v.invariant_better(state, t);
 		});
 	}
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		std::size_t res = 0;
+		detail::tuple_for_each(visitors, [&](auto &v) {
+			res += v.memory_instance(state);
+		});
+		return res;
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &state, const TreeNode &t) {
+		std::size_t res = 0;
+		detail::tuple_for_each(visitors, [&](auto &v) {
+			res += v.memory_tree_node(state, t);
+		});
+		return res;
+	}
 public:
 	std::tuple<Visitors...> visitors;
 };
@@ -58,6 +58,10 @@ public:
 
 	template<typename State>
 	void initialize(State &state) {
+		auto &i_data = get(instance_data_t(), state.data);
+		i_data.cell_splitting_in_progress = false;
+		i_data.num_nodes = 0;
+		i_data.cur_num_tree_nodes = 0;
 		if(log) {
 			auto &s = *log;
 			s << "[\n" << R"({"type":"graph")";
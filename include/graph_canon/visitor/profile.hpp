@@ -0,0 +1,658 @@
+#ifndef GRAPH_CANON_VISITOR_PROFILE_HPP
+#define GRAPH_CANON_VISITOR_PROFILE_HPP
+
+#include <graph_canon/perf_counters.hpp>
+#include <graph_canon/visitor/visitor.hpp>
+
+#include <graph_canon/detail/memory.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace graph_canon {
+
+// rst: .. enum-class:: profile_event
+// rst:
+// rst:		The events timed by `profile_visitor`, one for each `Visitor` method,
+// rst:		and the following:
+// rst:
+// rst:		.. enumerator:: select_target_cell
+// rst:		                explore_tree
+// rst:
+// rst:			The calls of the target cell selector and of the tree traversal.
+// rst:			They are only timed if the wrapped visitor provides them.
+// rst:
+// rst:		.. enumerator:: report_leaf
+// rst:
+// rst:			The span of `canon_state::report_leaf`, from the beginning of `Visitor::tree_leaf`
+// rst:			to the end of the `Visitor::canon_new_best`, `Visitor::automorphism_leaf`, or `Visitor::canon_worse` it calls.
+// rst:			Its self time is thus the hashing of the permuted graph, and the construction and comparison of the permuted graphs.
+// rst:
+
+enum class profile_event : std::size_t {
+	tree_create_node_begin, tree_create_node_end, tree_destroy_node, tree_before_descend, tree_create_child, tree_leaf, tree_prune_node,
+	canon_new_best, canon_worse, canon_prune,
+	automorphism_leaf, automorphism_implicit,
+	refine, refine_cell_split_begin, refine_new_cell, refine_cell_split_end, refine_quotient_edge, refine_refiner_done, refine_abort,
+	invariant_better,
+	select_target_cell, explore_tree, report_leaf
+};
+
+constexpr std::size_t profile_num_events = static_cast<std::size_t> (profile_event::report_leaf) + 1;
+
+// rst: .. function:: const char *to_string(profile_event e)
+// rst:
+// rst:		:returns: the name of the event.
+
+inline const char *to_string(profile_event e) {
+	static const char * const names[profile_num_events] = {
+		"tree_create_node_begin", "tree_create_node_end", "tree_destroy_node", "tree_before_descend", "tree_create_child", "tree_leaf", "tree_prune_node",
+		"canon_new_best", "canon_worse", "canon_prune",
+		"automorphism_leaf", "automorphism_implicit",
+		"refine", "refine_cell_split_begin", "refine_new_cell", "refine_cell_split_end", "refine_quotient_edge", "refine_refiner_done", "refine_abort",
+		"invariant_better",
+		"select_target_cell", "explore_tree", "report_leaf"
+	};
+	return names[static_cast<std::size_t> (e)];
+}
+
+// rst: .. enum-class:: profile_phase
+// rst:
+// rst:		The phases of a run for which `profile_visitor` can collect hardware performance counters.
+// rst:
+// rst:		.. enumerator:: root_refinement
+// rst:
+// rst:			The creation of the root, i.e., the refinement of the initial partition and the selection of its target cell.
+// rst:
+// rst:		.. enumerator:: tree_search
+// rst:
+// rst:			The traversal of the search tree, including the leaf comparisons done during it.
+// rst:
+// rst:		.. enumerator:: leaf_comparison
+// rst:
+// rst:			The spans timed as `profile_event::report_leaf`.
+// rst:
+
+enum class profile_phase : std::size_t {
+	root_refinement, tree_search, leaf_comparison
+};
+
+constexpr std::size_t profile_num_phases = static_cast<std::size_t> (profile_phase::leaf_comparison) + 1;
+
+// rst: .. function:: const char *to_string(profile_phase p)
+// rst:
+// rst:		:returns: the name of the phase.
+
+inline const char *to_string(profile_phase p) {
+	static const char * const names[profile_num_phases] = {
+		"root_refinement", "tree_search", "leaf_comparison"
+	};
+	return names[static_cast<std::size_t> (p)];
+}
+
+namespace detail {
+
+// A time stamp in ticks of the time stamp counter where available, otherwise of the steady clock.
+// The ticks are converted to seconds by comparing with the steady clock over a whole run.
+
+inline std::uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+} // namespace detail
+
+// rst: .. class:: profile_data
+// rst:
+// rst:		The timings collected by `profile_visitor` for one run.
+// rst:		The inclusive time of an event is the time spent in the wrapped visitor for it,
+// rst:		while its self time excludes the time of other events nested in it,
+// rst:		e.g., the `Visitor::refine_new_cell` calls made by a refiner during `Visitor::refine`.
+// rst:
+
+struct profile_data {
+	// rst:		.. class:: entry
+	// rst:
+	// rst:			.. var:: std::size_t calls
+	// rst:			         std::uint64_t ticks
+	// rst:			         std::uint64_t self_ticks
+	// rst:
+	// rst:				The number of calls, and the inclusive and self time in ticks.
+
+	struct entry {
+		std::size_t calls = 0;
+		std::uint64_t ticks = 0, self_ticks = 0;
+	};
+
+	using entries = std::array<entry, profile_num_events>;
+
+	struct frame {
+		profile_event event;
+		std::size_t level;
+		std::uint64_t start, nested;
+	};
+public:
+
+	// rst:		.. function:: double get_seconds(std::uint64_t ticks) const
+	// rst:
+	// rst:			:returns: the number of seconds corresponding to `ticks`.
+
+	double get_seconds(std::uint64_t ticks) const {
+		return ticks * seconds_per_tick;
+	}
+
+	// rst:		.. function:: const entry &get(profile_event e) const
+	// rst:
+	// rst:			:returns: the totals of event `e` over the whole tree.
+
+	const entry &get(profile_event e) const {
+		return events[static_cast<std::size_t> (e)];
+	}
+
+	// rst:		.. function:: const entry &get(profile_event e, std::size_t level) const
+	// rst:
+	// rst:			:returns: the totals of event `e` for the tree nodes with distance `level` to the root.
+	// rst:				Events without a tree node, i.e., `profile_event::canon_prune` and `profile_event::explore_tree`, are not counted per level.
+
+	const entry &get(profile_event e, std::size_t level) const {
+		static const entry empty;
+		if(level >= levels.size()) return empty;
+		return levels[level][static_cast<std::size_t> (e)];
+	}
+
+	// rst:		.. function:: const perf_sample &get(profile_phase p) const
+	// rst:
+	// rst:			:returns: the hardware counters of phase `p`, or zeros if `has_counters` is `false`.
+
+	const perf_sample &get(profile_phase p) const {
+		return phases[static_cast<std::size_t> (p)];
+	}
+
+	// rst:		.. function:: std::size_t get_num_levels() const
+	// rst:
+	// rst:			:returns: one more than the largest level with a timed event.
+
+	std::size_t get_num_levels() const {
+		return levels.size();
+	}
+
+	// rst:		.. function:: friend std::ostream &operator<<(std::ostream &s, const profile_data &d)
+	// rst:
+	// rst:			Print the events ranked by their self time, and the self time per tree level of the most expensive events.
+
+	friend std::ostream &operator<<(std::ostream &s, const profile_data &d) {
+		std::vector<profile_event> ranked;
+		for(std::size_t e = 0; e != profile_num_events; ++e)
+			if(d.events[e].calls != 0) ranked.push_back(static_cast<profile_event> (e));
+		std::stable_sort(ranked.begin(), ranked.end(), [&d](profile_event a, profile_event b) {
+			return d.get(a).self_ticks > d.get(b).self_ticks;
+		});
+		const auto ms = [&d](std::uint64_t ticks) {
+			return d.get_seconds(ticks) * 1000;
+		};
+		const auto flags = s.flags();
+		const auto precision = s.precision();
+		s << std::fixed << std::setprecision(3);
+		s << "total:                   " << ms(d.total_ticks) << " ms\n";
+		s << std::left << std::setw(25) << "event" << std::right << std::setw(12) << "calls"
+				<< std::setw(14) << "total (ms)" << std::setw(14) << "self (ms)" << std::setw(9) << "self %" << '\n';
+		for(const auto e : ranked) {
+			const auto &totals = d.get(e);
+			s << std::left << std::setw(25) << to_string(e) << std::right << std::setw(12) << totals.calls
+					<< std::setw(14) << ms(totals.ticks) << std::setw(14) << ms(totals.self_ticks)
+					<< std::setw(8) << std::setprecision(1) << (d.total_ticks == 0 ? 0.0 : 100.0 * totals.self_ticks / d.total_ticks)
+					<< std::setprecision(3) << "%\n";
+		}
+		// the per-level self times of the events with the most self time overall
+		const std::size_t num_columns = std::min<std::size_t>(ranked.size(), 5);
+		if(!d.levels.empty() && num_columns != 0) {
+			s << "self (ms) per level:\n" << std::left << std::setw(8) << "level" << std::right;
+			for(std::size_t i = 0; i != num_columns; ++i)
+				s << ' ' << std::setw(std::max<std::size_t>(std::strlen(to_string(ranked[i])), 12)) << to_string(ranked[i]);
+			s << '\n';
+			for(std::size_t level = 0; level != d.levels.size(); ++level) {
+				s << std::left << std::setw(8) << level << std::right;
+				for(std::size_t i = 0; i != num_columns; ++i)
+					s << ' ' << std::setw(std::max<std::size_t>(std::strlen(to_string(ranked[i])), 12)) << ms(d.get(ranked[i], level).self_ticks);
+				s << '\n';
+			}
+		}
+		if(d.has_counters) {
+			s << std::left << std::setw(25) << "phase" << std::right << std::setw(16) << "cycles" << std::setw(16) << "instructions"
+					<< std::setw(16) << "cache-misses" << std::setw(16) << "branch-misses" << std::setw(8) << "IPC" << '\n';
+			for(std::size_t p = 0; p != profile_num_phases; ++p) {
+				const auto &c = d.phases[p];
+				s << std::left << std::setw(25) << to_string(static_cast<profile_phase> (p)) << std::right
+						<< std::setw(16) << c.cycles << std::setw(16) << c.instructions
+						<< std::setw(16) << c.cache_misses << std::setw(16) << c.branch_misses
+						<< std::setw(8) << std::setprecision(2) << c.get_ipc() << std::setprecision(3) << '\n';
+			}
+		} else if(!d.counter_error.empty()) {
+			s << "hardware counters unavailable: " << d.counter_error << '\n';
+		}
+		s.flags(flags);
+		s.precision(precision);
+		return s;
+	}
+public:
+	entries events;
+	std::vector<entries> levels;
+	std::uint64_t total_ticks = 0;
+	double seconds_per_tick = 0;
+	// rst:		.. var:: bool has_counters
+	// rst:		         std::string counter_error
+	// rst:
+	// rst:			Whether the hardware counters were collected, and otherwise why they could not be opened, if they were requested.
+	bool has_counters = false;
+	std::string counter_error;
+	std::array<perf_sample, profile_num_phases> phases;
+	// run state
+	std::array<perf_sample, profile_num_phases> phase_start;
+	std::array<bool, profile_num_phases> in_phase = {};
+	std::vector<frame> stack;
+	std::uint64_t start_ticks = 0;
+	std::chrono::steady_clock::time_point start_time;
+};
+
+// rst: .. class:: profile_result_t
+// rst:
+// rst:		The tag type used by all specializations of `profile_visitor` for returning the `profile_data`.
+// rst:
+
+struct profile_result_t {
+};
+
+// rst: .. class:: template<typename Visitor> \
+// rst:            profile_visitor
+// rst:
+// rst:		A visitor that forwards all methods to the given `Visitor` and times each call,
+// rst:		accumulating the time per `profile_event`, both in total and per level of the search tree.
+// rst:		As each visitor in a `compound_visitor` is called in turn, the timing must be done around the visitors to measure,
+// rst:		so typically the profiled visitor is the complete visitor given to the `canonicalizer`, e.g.,
+// rst:
+// rst:		.. code-block:: c++
+// rst:
+// rst:			make_visitor(profile_visitor(make_visitor(refine_WL_1(), target_cell_flm(), traversal_dfs(), aut_pruner_basic())), stats_visitor())
+// rst:
+// rst:		The time stamp counter is used where available, otherwise the steady clock.
+// rst:		Each timed call costs two time stamps, which is noticeable for the frequent refinement events,
+// rst:		so the totals are mostly useful for comparing events with each other.
+// rst:		The data is kept in the instance data of each `canon_state`, so the visitor can be copied by `traversal_parallel`,
+// rst:		but then only the events of the state of the run are returned, i.e., of the root and the path to the canonical leaf.
+// rst:
+// rst:		Optionally, the hardware counters of `perf_counters` are sampled at the boundaries of each `profile_phase`.
+// rst:		This is independent of the timing, and as a phase is only sampled twice, the overhead is small,
+// rst:		except for `profile_phase::leaf_comparison` with many leaves.
+// rst:		The counters are opened at the first run and kept in the instance data for the following runs.
+// rst:		They only count the calling thread as well.
+// rst:
+
+template<typename Visitor>
+struct profile_visitor {
+	using can_select_target_cell = typename Visitor::can_select_target_cell;
+	using can_explore_tree = typename Visitor::can_explore_tree;
+
+	// rst:		.. type:: result_t = profile_result_t
+
+	using result_t = profile_result_t;
+
+	struct counters_t {
+	};
+
+	template<typename Config, typename TreeNode>
+	struct InstanceData {
+		using type = typename tagged_list_concat<
+				tagged_element<result_t, profile_data>,
+				tagged_element<counters_t, perf_counters>,
+				typename Visitor::template InstanceData<Config, TreeNode>::type
+				>::type;
+	};
+
+	template<typename Config, typename TreeNode>
+	struct TreeNodeData {
+		using type = typename Visitor::template TreeNodeData<Config, TreeNode>::type;
+	};
+private:
+	static constexpr std::size_t no_level = -1;
+
+	// Times the calls between construction and destruction, so also an event left by an exception.
+
+	template<typename State>
+	struct scope {
+
+		scope(State &state, profile_event event, std::size_t level) : d(&data(state)) {
+			d->stack.push_back({event, level, detail::profile_ticks(), 0});
+		}
+
+		~scope() {
+			pop(*d);
+		}
+	private:
+		profile_data *d;
+	};
+
+	static void pop(profile_data &d) {
+		const auto end = detail::profile_ticks();
+		const auto f = d.stack.back();
+		d.stack.pop_back();
+		const std::uint64_t ticks = end - f.start;
+		const std::uint64_t self_ticks = ticks > f.nested ? ticks - f.nested : 0;
+		if(!d.stack.empty()) d.stack.back().nested += ticks;
+		const auto add = [&](profile_data::entry & e) {
+			++e.calls;
+			e.ticks += ticks;
+			e.self_ticks += self_ticks;
+		};
+		add(d.events[static_cast<std::size_t> (f.event)]);
+		if(f.level == no_level) return;
+		if(f.level >= d.levels.size()) d.levels.resize(f.level + 1);
+		add(d.levels[f.level][static_cast<std::size_t> (f.event)]);
+	}
+
+	template<typename State>
+	static profile_data &data(State &state) {
+		return get(result_t(), state.data);
+	}
+
+	template<typename State, typename TreeNode, typename F>
+	decltype(auto) timed(State &state, profile_event event, const TreeNode &t, F f) {
+		if(!enabled) return f();
+		scope<State> s(state, event, t.level);
+		return f();
+	}
+
+	template<typename State, typename F>
+	decltype(auto) timed(State &state, profile_event event, F f) {
+		if(!enabled) return f();
+		scope<State> s(state, event, no_level);
+		return f();
+	}
+
+	// report_leaf is not a visitor method, so it is timed from the start of tree_leaf
+	// to the end of the method it ends with
+
+	template<typename State>
+	void end_report_leaf(State &state) {
+		end_phase(state, profile_phase::leaf_comparison);
+		if(!enabled) return;
+		auto &d = data(state);
+		if(!d.stack.empty() && d.stack.back().event == profile_event::report_leaf) pop(d);
+	}
+
+	template<typename State>
+	void begin_phase(State &state, profile_phase p) {
+		if(!counters) return;
+		auto &d = data(state);
+		const auto i = static_cast<std::size_t> (p);
+		if(!d.has_counters || d.in_phase[i]) return;
+		d.in_phase[i] = true;
+		d.phase_start[i] = get(counters_t(), state.data).read();
+	}
+
+	template<typename State>
+	void end_phase(State &state, profile_phase p) {
+		if(!counters) return;
+		auto &d = data(state);
+		const auto i = static_cast<std::size_t> (p);
+		if(!d.in_phase[i]) return;
+		d.in_phase[i] = false;
+		d.phases[i] += get(counters_t(), state.data).read() - d.phase_start[i];
+	}
+public:
+
+	// rst:		.. function:: profile_visitor(Visitor visitor, bool enabled = true, bool counters = false)
+	// rst:
+	// rst:			:param enabled: whether to time the calls, otherwise they are only forwarded and the returned data is empty.
+	// rst:			:param counters: whether to collect the hardware counters per `profile_phase`.
+	// rst:				If they can not be opened, the run continues without them, see `profile_data::counter_error`.
+
+	profile_visitor(Visitor visitor, bool enabled = true, bool counters = false)
+	: visitor(visitor), enabled(enabled), counters(counters) { }
+
+	template<typename State>
+	void initialize(State &state) {
+		auto &d = data(state);
+		// it may have been moved out in a previous run
+		d.events = profile_data::entries();
+		d.levels.clear();
+		d.stack.clear();
+		d.total_ticks = 0;
+		d.seconds_per_tick = 0;
+		d.phases.fill(perf_sample());
+		d.in_phase.fill(false);
+		d.has_counters = false;
+		d.counter_error.clear();
+		if(counters) {
+			auto &c = get(counters_t(), state.data);
+			d.has_counters = c.open();
+			d.counter_error = c.get_error();
+		}
+		d.start_time = std::chrono::steady_clock::now();
+		d.start_ticks = detail::profile_ticks();
+		visitor.initialize(state);
+	}
+
+	// rst:		.. function:: template<typename State> \
+	// rst:		              auto extract_result(State &state)
+	// rst:
+	// rst:			:returns: the `profile_data` tagged with `result_t`, followed by the result of the wrapped visitor.
+	// rst:				The total time is from the initialization of the `canon_state` until this call.
+
+	template<typename State>
+	auto extract_result(State &state) {
+		auto &d = data(state);
+		if(enabled) {
+			d.total_ticks = detail::profile_ticks() - d.start_ticks;
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - d.start_time).count();
+			d.seconds_per_tick = d.total_ticks == 0 ? 0 : seconds / d.total_ticks;
+		} else {
+			d.levels.clear();
+		}
+		d.stack.clear();
+		for(std::size_t p = 0; p != profile_num_phases; ++p)
+			end_phase(state, static_cast<profile_phase> (p));
+		auto rest = visitor.extract_result(state);
+		return make_tagged_list(tagged_element<result_t, profile_data>{std::move(d)}, std::move(rest));
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t select_target_cell(State &state, TreeNode &t) {
+		return timed(state, profile_event::select_target_cell, t, [&]() {
+			return visitor.select_target_cell(state, t);
+		});
+	}
+
+	template<typename State>
+	void explore_tree(State &state) {
+		begin_phase(state, profile_phase::tree_search);
+		timed(state, profile_event::explore_tree, [&]() {
+			visitor.explore_tree(state);
+		});
+		end_phase(state, profile_phase::tree_search);
+	}
+public:
+
+	template<typename State, typename TreeNode>
+	bool tree_create_node_begin(State &state, TreeNode &t) {
+		if(t.level == 0) begin_phase(state, profile_phase::root_refinement);
+		return timed(state, profile_event::tree_create_node_begin, t, [&]() {
+			return visitor.tree_create_node_begin(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	bool tree_create_node_end(State &state, TreeNode &t) {
+		const bool res = timed(state, profile_event::tree_create_node_end, t, [&]() {
+			return visitor.tree_create_node_end(state, t);
+		});
+		if(t.level == 0) end_phase(state, profile_phase::root_refinement);
+		return res;
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_destroy_node(State &state, TreeNode &t) {
+		timed(state, profile_event::tree_destroy_node, t, [&]() {
+			visitor.tree_destroy_node(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_before_descend(State &state, TreeNode &t) {
+		timed(state, profile_event::tree_before_descend, t, [&]() {
+			visitor.tree_before_descend(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_create_child(State &state, TreeNode &t, std::size_t element_idx_to_individualise) {
+		timed(state, profile_event::tree_create_child, t, [&]() {
+			visitor.tree_create_child(state, t, element_idx_to_individualise);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_leaf(State &state, TreeNode &t) {
+		// the report_leaf scope is left open, see end_report_leaf
+		begin_phase(state, profile_phase::leaf_comparison);
+		if(enabled) data(state).stack.push_back({profile_event::report_leaf, t.level, detail::profile_ticks(), 0});
+		timed(state, profile_event::tree_leaf, t, [&]() {
+			visitor.tree_leaf(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void tree_prune_node(State &state, TreeNode &t) {
+		timed(state, profile_event::tree_prune_node, t, [&]() {
+			visitor.tree_prune_node(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void canon_new_best(State &state, TreeNode *previous) {
+		timed(state, profile_event::canon_new_best, *state.get_canon_leaf(), [&]() {
+			visitor.canon_new_best(state, previous);
+		});
+		end_report_leaf(state);
+	}
+
+	template<typename State, typename TreeNode>
+	void canon_worse(State &state, TreeNode &t) {
+		timed(state, profile_event::canon_worse, t, [&]() {
+			visitor.canon_worse(state, t);
+		});
+		end_report_leaf(state);
+	}
+
+	template<typename State>
+	void canon_prune(State &state) {
+		timed(state, profile_event::canon_prune, [&]() {
+			visitor.canon_prune(state);
+		});
+	}
+
+	template<typename State, typename TreeNode, typename Perm>
+	void automorphism_leaf(State &state, TreeNode &t, const Perm &aut) {
+		timed(state, profile_event::automorphism_leaf, t, [&]() {
+			visitor.automorphism_leaf(state, t, aut);
+		});
+		end_report_leaf(state);
+	}
+
+	template<typename State, typename TreeNode, typename Perm>
+	void automorphism_implicit(State &state, TreeNode &t, const Perm &aut, std::size_t tag) {
+		timed(state, profile_event::automorphism_implicit, t, [&]() {
+			visitor.automorphism_implicit(state, t, aut, tag);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	RefinementResult refine(State &state, TreeNode &t) {
+		return timed(state, profile_event::refine, t, [&]() {
+			return visitor.refine(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void refine_cell_split_begin(State &state, TreeNode &t, std::size_t refiner_begin,
+			std::size_t refinee_begin, std::size_t refinee_end) {
+		timed(state, profile_event::refine_cell_split_begin, t, [&]() {
+			visitor.refine_cell_split_begin(state, t, refiner_begin, refinee_begin, refinee_end);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	bool refine_new_cell(State &state, TreeNode &t, std::size_t new_cell, std::size_t type) {
+		return timed(state, profile_event::refine_new_cell, t, [&]() {
+			return visitor.refine_new_cell(state, t, new_cell, type);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void refine_cell_split_end(State &state, TreeNode &t, std::size_t refiner_begin,
+			std::size_t refinee_begin, std::size_t refinee_end) {
+		timed(state, profile_event::refine_cell_split_end, t, [&]() {
+			visitor.refine_cell_split_end(state, t, refiner_begin, refinee_begin, refinee_end);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	bool refine_quotient_edge(State &state, TreeNode &t, std::size_t refiner, std::size_t refinee, std::size_t count) {
+		return timed(state, profile_event::refine_quotient_edge, t, [&]() {
+			return visitor.refine_quotient_edge(state, t, refiner, refinee, count);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	bool refine_refiner_done(State &state, TreeNode &t, const std::size_t refiner, const std::size_t refiner_end) {
+		return timed(state, profile_event::refine_refiner_done, t, [&]() {
+			return visitor.refine_refiner_done(state, t, refiner, refiner_end);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void refine_abort(State &state, TreeNode &t) {
+		timed(state, profile_event::refine_abort, t, [&]() {
+			visitor.refine_abort(state, t);
+		});
+	}
+
+	template<typename State, typename TreeNode>
+	void invariant_better(State &state, TreeNode &t) {
+		timed(state, profile_event::invariant_better, t, [&]() {
+			visitor.invariant_better(state, t);
+		});
+	}
+public: // not timed, the memory accounting is done by the canon_state
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		const auto &d = data(state);
+		return detail::heap_bytes(d.levels) + detail::heap_bytes(d.stack) + visitor.memory_instance(state);
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &state, const TreeNode &t) {
+		return visitor.memory_tree_node(state, t);
+	}
+public:
+	Visitor visitor;
+	bool enabled, counters;
+};
+
+} // namespace graph_canon
+
+#endif /* GRAPH_CANON_VISITOR_PROFILE_HPP */
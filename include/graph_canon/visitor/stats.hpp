@@ -47,6 +47,8 @@ struct stats_visitor : null_visitor {
 		std::size_t vIdCanon;
 		std::size_t cur_num_tree_nodes = 0;
 		std::size_t max_num_tree_nodes = 0;
+		// in bytes, see canon_state::get_memory_usage, the current usage is at the end of the run
+		std::size_t memory_peak = 0, memory_current = 0;
 	public:
 
 		// rst:			.. function:: friend std::ostream &operator<<(std::ostream &s, const ResultData &d)
@@ -63,6 +65,8 @@ struct stats_visitor : null_visitor {
 			s << "num_explicit_automorphisms: " << d.num_explicit_automorphisms << '\n';
 			s << "num_implicit_automorphisms: " << d.num_implicit_automorphisms << '\n';
 			s << "max_root_distance:          " << d.max_root_distance << '\n';
+			s << "memory_peak:                " << d.memory_peak << '\n';
+			s << "memory_current:             " << d.memory_current << '\n';
 			return s;
 		}
 	};
@@ -98,8 +102,15 @@ public:
 
 	stats_visitor(std::ostream *tree_dump = nullptr) : tree_dump(tree_dump) { }
 
+	template<typename State>
+	void initialize(State &state) {
+		data(state) = ResultData(); // it may have been moved out in a previous run
+	}
+
 	template<typename State>
 	auto extract_result(State &state) {
+		data(state).memory_peak = state.get_memory_peak();
+		data(state).memory_current = state.get_memory_usage();
 		if(tree_dump) {
 			auto &d = data(state);
 			std::ostream &s = *tree_dump;
@@ -101,7 +101,14 @@ struct null_visitor : no_instance_data, no_tree_node_data, no_result {
 	// rst:			.. type:: type
 	// rst:
 	// rst:				An alias for either a `tagged_list` or a `tagged_element`.
-	// rst:				An object of the this type will be instantiated in each `canon_state`.
+	// rst:				An object of the this type will be used by each `canon_state`,
+	// rst:				and is kept by the `canonicalizer` for its later runs, see `canon_workspace`.
+	// rst:				The object is therefore only default constructed for the first run,
+	// rst:				and a later run, possibly of a graph with a different number of vertices,
+	// rst:				receives it as the previous run left it.
+	// rst:				It is the responsibility of `Vis::initialize` to reset every member
+	// rst:				that the visitor expects to be in its default state.
+	// rst:				Note that this is a change from earlier versions, where the object was constructed for every run.
 	// rst:				If non is needed, you can derive from `no_instance_data`.
 	// rst:
 	// rst:		.. class:: template<typename Config, typename TreeNode> \
@@ -126,6 +133,7 @@ struct null_visitor : no_instance_data, no_tree_node_data, no_result {
 	// rst:			An alias for either `std::true_type` or `std::false_type`
 	// rst:			to denote whether the visitor want to provide the tree traversal algorithm.
 	// rst:			If so, the expression `vis.explore_tree(state)` must be valid.
+	// rst:			The traversal must stop when :expr:`canon_state::check_limits` returns `true`.
 	// rst:
 	using can_explore_tree = std::false_type;
 public:
@@ -135,6 +143,11 @@ public:
 	// rst:		- | Expression: `vis.initialize(state)`
 	// rst:		  | Return type: `void`
 	// rst:		  | Called: before the root node is constructed.
+	// rst:		  | The instance data may have been used by a previous run of the same `canonicalizer`,
+	// rst:		    so it must be reset, preferably without giving back the memory of its buffers.
+	// rst:		    Buffers indexed by vertex must be resized to :math:`n`,
+	// rst:		    and data that is only valid during a run (e.g., counters, pointers to tree nodes, or statistics)
+	// rst:		    must be cleared here, as the constructor of the instance data is not run again.
 
 	template<typename State>
 	void initialize(State &state) { }
@@ -348,6 +361,35 @@ public:
 
 	template<typename State, typename TreeNode>
 	void invariant_better(State &state, TreeNode &t) { }
+
+	// rst:
+	// rst:		**Memory Accounting Methods**
+	// rst:
+	// rst:		The returned sizes only cover memory allocated dynamically by the visitor,
+	// rst:		as the fixed-size instance data and tree node data are already accounted for by the `canon_state`.
+	// rst:		See `canon_state::get_memory_usage`.
+	// rst:
+
+	// rst:		- | Expression: `vis.memory_instance(state)`
+	// rst:		  | Return type: `std::size_t`
+	// rst:		  | Called: by `canon_state::update_memory`, e.g., after each tree node construction.
+	// rst:		  | Returns the number of bytes allocated for the instance data of the visitor.
+
+	template<typename State>
+	std::size_t memory_instance(const State &state) {
+		return 0;
+	}
+
+	// rst:		- | Expression: `vis.memory_tree_node(state, t)`
+	// rst:		  | Return type: `std::size_t`
+	// rst:		  | Called: by `canon_state::update_memory`, at least in the end of the `tree_node` constructor.
+	// rst:		  | Returns the number of bytes allocated for the tree node data of the visitor in `t`.
+	// rst:		    Visitors that later grow this data must call `state.update_memory(t)`.
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &state, const TreeNode &t) {
+		return 0;
+	}
 };
 
 } // namespace graph_canon
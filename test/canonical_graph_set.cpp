@@ -0,0 +1,79 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/canonical_graph_set.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+using Set = graph_canon::canonical_graph_set<unsigned int>;
+
+std::set<std::pair<unsigned int, unsigned int> > canonical_edges(const Graph &g, const std::vector<unsigned int> &p) {
+	std::set<std::pair<unsigned int, unsigned int> > res;
+	BGL_FORALL_EDGES(e, g, Graph) {
+		const auto u = p[source(e, g)], v = p[target(e, g)];
+		res.emplace(std::min(u, v), std::max(u, v));
+	}
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	std::vector<Graph> graphs;
+	for(int i = 0; i < 100; ++i) {
+		graphs.push_back(make_random_graph<Graph>(gen, 1 + gen() % 12, 0.3));
+		for(int j = gen() % 3; j > 0; --j)
+			graphs.push_back(make_relabelled(gen, graphs.back()));
+	}
+	std::vector<std::vector<unsigned int> > perms;
+	std::set<std::pair<std::size_t, std::set<std::pair<unsigned int, unsigned int> > > > expected;
+	for(const auto &g : graphs) {
+		perms.push_back(canonical_permutation(g));
+		expected.emplace(num_vertices(g), canonical_edges(g, perms.back()));
+	}
+
+	{ // sequential, and the encoding itself
+		Set set(1);
+		std::size_t num_new = 0;
+		for(std::size_t i = 0; i != graphs.size(); ++i) {
+			const auto &g = graphs[i];
+			std::vector<unsigned int> form;
+			Set::encode(g, get(boost::vertex_index_t(), g), perms[i], form);
+			BOOST_REQUIRE_EQUAL(form.size(), 2 + num_vertices(g) + num_edges(g));
+			const bool was_new = !set.contains(g, get(boost::vertex_index_t(), g), perms[i]);
+			BOOST_CHECK_EQUAL(set.insert(g, get(boost::vertex_index_t(), g), perms[i]), was_new);
+			BOOST_CHECK(set.contains_form(form));
+			num_new += was_new;
+		}
+		BOOST_CHECK_EQUAL(num_new, expected.size());
+		BOOST_CHECK_EQUAL(set.size(), expected.size());
+	}
+	{ // concurrent
+		Set set;
+		const std::size_t num_threads = 4;
+		std::vector<std::size_t> num_new(num_threads);
+		std::vector<std::thread> threads;
+		for(std::size_t t = 0; t != num_threads; ++t) {
+			threads.emplace_back([&, t]() {
+				for(std::size_t i = t; i < graphs.size(); i += num_threads)
+					num_new[t] += set.insert(graphs[i], get(boost::vertex_index_t(), graphs[i]), perms[i]);
+			});
+		}
+		for(auto &t : threads) t.join();
+		BOOST_CHECK_EQUAL(std::accumulate(num_new.begin(), num_new.end(), std::size_t(0)), expected.size());
+		BOOST_CHECK_EQUAL(set.size(), expected.size());
+	}
+}
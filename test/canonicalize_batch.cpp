@@ -0,0 +1,82 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/batch.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+using Canonicalizer = graph_canon::canonicalizer<unsigned int, graph_canon::edge_handler_all_equal, false, false>;
+
+const auto canon_dfs = [](Canonicalizer &c, const Graph &g) {
+	return c(g, get(boost::vertex_index_t(), g), graph_canon::always_false(), graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1())).first;
+};
+
+// the results must be delivered in input order and be the same as for each graph on its own
+
+void check_batch(const std::vector<Graph> &graphs, std::size_t num_threads) {
+	std::vector<std::vector<unsigned int> > perms;
+	graph_canon::canonicalize_batch<unsigned int, false, false>(graphs, graph_canon::edge_handler_all_equal(), canon_dfs,
+			[&perms](std::size_t i, std::vector<unsigned int> &&perm) {
+				BOOST_REQUIRE_EQUAL(i, perms.size());
+				perms.push_back(std::move(perm));
+			}, num_threads);
+	BOOST_REQUIRE_EQUAL(perms.size(), graphs.size());
+	for(std::size_t i = 0; i < graphs.size(); ++i)
+		BOOST_CHECK(perms[i] == canonical_permutation(graphs[i]));
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	std::vector<Graph> graphs;
+	for(int i = 0; i < 50; ++i) {
+		if(i % 10 == 0) graphs.push_back(make_cycle<Graph>(100 + gen() % 100));
+		else graphs.push_back(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2));
+	}
+	for(std::size_t num_threads : {1, 2, 3, 8})
+		check_batch(graphs, num_threads);
+	check_batch({make_complete<Graph>(5)}, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_empty) {
+	for(std::size_t num_threads : {1, 4}) {
+		const std::vector<Graph> graphs;
+		bool called = false;
+		graph_canon::canonicalize_batch<unsigned int, false, false>(graphs, graph_canon::edge_handler_all_equal(), canon_dfs,
+				[&called](std::size_t, std::vector<unsigned int>&&) {
+					called = true;
+				}, num_threads);
+		BOOST_CHECK(!called);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_exception) {
+	std::vector<Graph> graphs;
+	for(int i = 0; i < 20; ++i)
+		graphs.push_back(make_cycle<Graph>(3 + i));
+	for(std::size_t num_threads : {1, 4}) {
+		std::size_t num_delivered = 0;
+		const auto canon = [&graphs](Canonicalizer &c, const Graph &g) {
+			if(&g == &graphs[5]) throw std::runtime_error("graph 5");
+			return canon_dfs(c, g);
+		};
+		const auto callback = [&num_delivered](std::size_t i, std::vector<unsigned int>&&) {
+			BOOST_REQUIRE_EQUAL(i, num_delivered);
+			++num_delivered;
+		};
+		BOOST_CHECK_THROW((graph_canon::canonicalize_batch<unsigned int, false, false>(graphs,
+				graph_canon::edge_handler_all_equal(), canon, callback, num_threads)), std::runtime_error);
+		BOOST_CHECK_LE(num_delivered, 5);
+	}
+}
@@ -0,0 +1,90 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/aut/pruner_schreier.hpp>
+#include <graph_canon/invariant/cell_split.hpp>
+#include <graph_canon/invariant/partial_leaf.hpp>
+#include <graph_canon/invariant/quotient.hpp>
+#include <graph_canon/tree_traversal/bfs-exp-m.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+using Canonicalizer = graph_canon::canonicalizer<unsigned int, graph_canon::edge_handler_all_equal, false, false>;
+
+// graphs of varying size, so the reused buffers both grow and shrink
+
+std::vector<Graph> make_graphs(std::mt19937 &gen) {
+	std::vector<Graph> graphs;
+	graphs.push_back(make_cycle<Graph>(30));
+	graphs.push_back(make_random_graph<Graph>(gen, 10, 0.3));
+	graphs.push_back(make_complete<Graph>(7));
+	graphs.push_back(make_random_graph<Graph>(gen, 50, 0.1));
+	graphs.push_back(make_cycle<Graph>(5));
+	graphs.push_back(make_cycle<Graph>(30));
+	for(int i = 0; i < 10; ++i)
+		graphs.push_back(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2));
+	return graphs;
+}
+
+// A run on a canonicalizer that has already been used for other graphs must give the same as a run on a new one.
+
+template<typename Vis>
+void check_reuse(const std::vector<Graph> &graphs, Vis vis) {
+	const auto run = [&vis](Canonicalizer &canon, const Graph &g) {
+		return canon(g, get(boost::vertex_index_t(), g), graph_canon::always_false(), vis);
+	};
+	Canonicalizer reused(graph_canon::edge_handler_all_equal{});
+	for(std::size_t i = 0; i < graphs.size(); ++i) {
+		BOOST_TEST_CONTEXT("graph " << i) {
+			const Graph &g = graphs[i];
+			Canonicalizer canon(graph_canon::edge_handler_all_equal{});
+			const auto fresh = run(canon, g);
+			const auto res = run(reused, g);
+			BOOST_REQUIRE(fresh.first == res.first);
+			const auto &stats_fresh = get(graph_canon::stats_visitor::result_t(), fresh.second);
+			const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+			BOOST_CHECK_EQUAL(stats_fresh.num_refine, stats.num_refine);
+			BOOST_CHECK_EQUAL(stats_fresh.num_refine_abort, stats.num_refine_abort);
+			BOOST_CHECK_EQUAL(stats_fresh.num_tree_nodes, stats.num_tree_nodes);
+			BOOST_CHECK_EQUAL(stats_fresh.num_terminals, stats.num_terminals);
+			BOOST_CHECK_EQUAL(stats_fresh.num_pruned, stats.num_pruned);
+			BOOST_CHECK_EQUAL(stats_fresh.num_new_best_leaf, stats.num_new_best_leaf);
+			BOOST_CHECK_EQUAL(stats_fresh.num_canon_pruned, stats.num_canon_pruned);
+			BOOST_CHECK_EQUAL(stats_fresh.num_explicit_automorphisms, stats.num_explicit_automorphisms);
+			BOOST_CHECK_EQUAL(stats_fresh.max_root_distance, stats.max_root_distance);
+			BOOST_CHECK_EQUAL(stats_fresh.max_num_tree_nodes, stats.max_num_tree_nodes);
+			BOOST_CHECK_EQUAL(stats_fresh.nodes.size(), stats.nodes.size());
+			const auto &group_fresh = get(graph_canon::aut_pruner_schreier::result_t(), fresh.second);
+			const auto &group = get(graph_canon::aut_pruner_schreier::result_t(), res.second);
+			BOOST_CHECK_EQUAL(group_fresh->generators().size(), group->generators().size());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_dfs_invariants) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	check_reuse(make_graphs(gen), graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1(),
+			graph_canon::aut_pruner_schreier(), graph_canon::invariant_cell_split(), graph_canon::invariant_quotient(),
+			graph_canon::invariant_partial_leaf(), graph_canon::stats_visitor()));
+}
+
+BOOST_AUTO_TEST_CASE(test_bfs_exp_m) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	check_reuse(make_graphs(gen), graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_bfs_exp_m(1024), graph_canon::refine_WL_1(),
+			graph_canon::aut_pruner_schreier(), graph_canon::stats_visitor()));
+}
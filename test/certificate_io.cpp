@@ -0,0 +1,105 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/certificate_io.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+using Certificate = graph_canon::canonical_certificate<unsigned int>;
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	std::vector<Graph> graphs;
+	for(int i = 0; i < 50; ++i) {
+		graphs.push_back(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2));
+		set_random_vertex_names(gen, graphs.back(), 3);
+		graphs.push_back(make_relabelled(gen, graphs.back(), std::true_type()));
+	}
+	std::vector<std::vector<unsigned int> > perms;
+	for(const auto &g : graphs)
+		perms.push_back(canonical_permutation(g, graph_canon::make_property_less(get(boost::vertex_name_t(), g))));
+
+	std::stringstream s;
+	{
+		graph_canon::canonical_certificate_writer writer(s);
+		for(std::size_t i = 0; i != graphs.size(); ++i) {
+			const auto &g = graphs[i];
+			if(i % 4 < 2)
+				writer.write(g, get(boost::vertex_index_t(), g), perms[i], i % 4 == 1);
+			else
+				writer.write_labelled(g, get(boost::vertex_index_t(), g), perms[i], get(boost::vertex_name_t(), g), i % 4 == 3);
+		}
+	}
+	std::stringstream err;
+	graph_canon::canonical_certificate_reader reader(s, err);
+	std::vector<Certificate> certificates;
+	Certificate c;
+	while(reader.read(c)) certificates.push_back(c);
+	BOOST_REQUIRE_MESSAGE(!reader.failed(), err.str());
+	BOOST_REQUIRE_EQUAL(certificates.size(), graphs.size());
+	for(std::size_t i = 0; i != graphs.size(); ++i) {
+		const auto &g = graphs[i];
+		std::vector<unsigned int> form;
+		graph_canon::detail::encode_canonical_form(g, get(boost::vertex_index_t(), g), perms[i], form);
+		BOOST_CHECK(certificates[i].form == form);
+		BOOST_CHECK_EQUAL(certificates[i].num_vertices(), num_vertices(g));
+		BOOST_CHECK_EQUAL(certificates[i].num_edges(), num_edges(g));
+		if(i % 2 == 1) // the relabelled copy, written in the same way as the original
+			BOOST_CHECK(certificates[i] == certificates[i - 1]);
+		if(i % 4 == 1 || i % 4 == 3)
+			BOOST_CHECK(certificates[i].permutation == perms[i]);
+		else
+			BOOST_CHECK(certificates[i].permutation.empty());
+		BOOST_CHECK_EQUAL(certificates[i].vertex_labels.empty(), i % 4 < 2);
+	}
+
+	{ // rewriting gives the same bytes
+		std::stringstream s2;
+		graph_canon::canonical_certificate_writer writer(s2);
+		for(const auto &c : certificates) writer.write(c);
+		BOOST_CHECK(s2.str() == s.str());
+	}
+	{ // truncated streams are detected
+		const std::string bytes = s.str();
+		std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+		std::stringstream err;
+		graph_canon::canonical_certificate_reader reader(truncated, err);
+		while(reader.read(c));
+		BOOST_CHECK(reader.failed());
+	}
+	{ // a huge header with little data must fail without allocating for the header
+		std::stringstream header;
+		graph_canon::canonical_certificate_writer writer(header);
+		std::string bytes = header.str();
+		graph_canon::detail::append_varint(bytes, 4000000000u);
+		graph_canon::detail::append_varint(bytes, 4000000000u);
+		graph_canon::detail::append_varint(bytes, 0);
+		bytes += std::string(3, '\x01');
+		std::stringstream bad(bytes);
+		std::stringstream err;
+		graph_canon::canonical_certificate_reader reader(bad, err);
+		BOOST_CHECK(!reader.read(c));
+		BOOST_CHECK(reader.failed());
+	}
+	{ // wrong magic
+		std::stringstream bad("GCCX\x01");
+		std::stringstream err;
+		graph_canon::canonical_certificate_reader reader(bad, err);
+		BOOST_CHECK(!reader.read(c));
+		BOOST_CHECK(reader.failed());
+	}
+}
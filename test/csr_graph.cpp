@@ -0,0 +1,118 @@
+#include "util.hpp" // from bin/
+
+#include <graph_canon/canonicalization.hpp>
+#include <graph_canon/csr_graph.hpp>
+#include <graph_canon/target_cell/flm.hpp>
+#include <graph_canon/tree_traversal/dfs.hpp>
+#include <graph_canon/visitor/certificate.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_concepts.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+using CSR = graph_canon::csr_graph<unsigned int, std::size_t, std::size_t>;
+using AdjList = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t>,
+		boost::property<boost::edge_name_t, std::size_t> >;
+
+template<typename Gen>
+std::vector<std::pair<unsigned int, unsigned int> > make_random_edges(Gen &gen, unsigned int n, double edge_probability) {
+	std::vector<std::pair<unsigned int, unsigned int> > edges;
+	std::uniform_real_distribution<double> dist_real(0.0, 1.0);
+	for(unsigned int u = 0; u < n; ++u)
+		for(unsigned int v = u + 1; v < n; ++v)
+			if(dist_real(gen) <= edge_probability) edges.emplace_back(u, v);
+	return edges;
+}
+
+// the sorted edges of the canonical form, and its certificate
+std::pair<std::vector<std::pair<std::size_t, std::size_t> >, std::uint64_t> canonical_edges(const CSR &g) {
+	auto res = graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::make_property_less(get(boost::vertex_name_t(), g)),
+			graph_canon::edge_handler_all_equal(),
+			graph_canon::make_visitor(graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1(),
+			graph_canon::certificate_visitor()));
+	const auto &permutation = res.first;
+	std::vector<std::pair<std::size_t, std::size_t> > result;
+	BGL_FORALL_EDGES(e, g, CSR) {
+		std::size_t u = permutation[source(e, g)];
+		std::size_t v = permutation[target(e, g)];
+		result.emplace_back(std::min(u, v), std::max(u, v));
+	}
+	std::sort(result.begin(), result.end());
+	return std::make_pair(result, get(graph_canon::certificate_visitor::result_t(), res.second));
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	BOOST_CONCEPT_ASSERT((boost::VertexListGraphConcept<CSR>));
+	BOOST_CONCEPT_ASSERT((boost::EdgeListGraphConcept<CSR>));
+	BOOST_CONCEPT_ASSERT((boost::IncidenceGraphConcept<CSR>));
+	BOOST_CONCEPT_ASSERT((boost::AdjacencyGraphConcept<CSR>));
+	BOOST_CONCEPT_ASSERT((boost::BidirectionalGraphConcept<CSR>));
+
+	const unsigned int n = 60;
+	const double edge_probability = 0.2;
+	const std::size_t max_vertex_name = 3;
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	const auto edge_list = make_random_edges(gen, n, edge_probability);
+	AdjList gAdj(n);
+	std::uniform_int_distribution<std::size_t> dist(0, max_vertex_name);
+	BGL_FORALL_VERTICES(v, gAdj, AdjList) {
+		put(boost::vertex_name_t(), gAdj, v, dist(gen));
+	}
+	for(const auto &e : edge_list) {
+		const auto e_new = add_edge(e.first, e.second, gAdj).first;
+		put(boost::edge_name_t(), gAdj, e_new, dist(gen));
+	}
+	const CSR g(gAdj, get(boost::vertex_index_t(), gAdj),
+			get(boost::vertex_name_t(), gAdj), get(boost::edge_name_t(), gAdj));
+
+	{ // structure and labels
+		BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gAdj));
+		BOOST_REQUIRE_EQUAL(num_edges(g), num_edges(gAdj));
+		std::size_t num_listed_edges = 0;
+		BGL_FORALL_EDGES(e, g, CSR) {
+			BOOST_REQUIRE(source(e, g) < target(e, g));
+			++num_listed_edges;
+		}
+		BOOST_REQUIRE_EQUAL(num_listed_edges, num_edges(g));
+		BGL_FORALL_VERTICES(v, gAdj, AdjList) {
+			BOOST_REQUIRE_EQUAL(get(get(boost::vertex_name_t(), g), v), get(boost::vertex_name_t(), gAdj, v));
+			BOOST_REQUIRE_EQUAL(out_degree(v, g), out_degree(v, gAdj));
+			auto e_iter = out_edges(v, g).first;
+			auto adj_iter = adjacent_vertices(v, g).first;
+			BGL_FORALL_OUTEDGES(v, e, gAdj, AdjList) {
+				BOOST_REQUIRE_EQUAL(source(*e_iter, g), v);
+				BOOST_REQUIRE_EQUAL(target(*e_iter, g), target(e, gAdj));
+				BOOST_REQUIRE_EQUAL(*adj_iter, target(e, gAdj));
+				BOOST_REQUIRE_EQUAL(get(get(boost::edge_name_t(), g), *e_iter), get(boost::edge_name_t(), gAdj, e));
+				++e_iter;
+				++adj_iter;
+			}
+			BGL_FORALL_INEDGES(v, e, g, CSR) {
+				BOOST_REQUIRE_EQUAL(target(e, g), v);
+			}
+		}
+	}
+	{ // canonicalization is invariant under relabelling
+		std::vector<unsigned int> id_permutation(n);
+		for(unsigned int i = 0; i < n; ++i) id_permutation[i] = i;
+		const auto permutation = make_random_permutation(gen, id_permutation);
+		std::vector<std::pair<unsigned int, unsigned int> > edge_list_permuted;
+		for(const auto &e : edge_list)
+			edge_list_permuted.emplace_back(permutation[e.first], permutation[e.second]);
+		const CSR g1(n, edge_list.begin(), edge_list.end());
+		const CSR g2(n, edge_list_permuted.begin(), edge_list_permuted.end());
+		BOOST_REQUIRE(canonical_edges(g1) == canonical_edges(g2));
+	}
+}
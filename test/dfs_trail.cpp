@@ -0,0 +1,92 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/tree_traversal/dfs-trail.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::no_property, boost::property<boost::edge_name_t, std::size_t> >;
+
+// Reads the partition and the target cell of each node when it is destroyed,
+// which for the ancestors of the best leaf is after the traversal, when the trail is gone.
+
+struct read_destroyed_visitor : graph_canon::null_visitor {
+	read_destroyed_visitor(std::size_t &sum) : sum(sum) { }
+
+	template<typename State, typename TreeNode>
+	void tree_destroy_node(State &state, TreeNode &t) {
+		sum = std::accumulate(t.pi.begin(), t.pi.end(), sum);
+		for(std::size_t i = 0; i != t.children.size(); ++i)
+			sum += t.get_child_element(i);
+	}
+private:
+	std::size_t &sum;
+};
+
+template<typename EdgeHandlerCreator, typename Traversal>
+auto canonicalize(const Graph &g, EdgeHandlerCreator edge_handler, Traversal traversal) {
+	const auto res = graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::always_false(), edge_handler, graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), traversal, graph_canon::refine_WL_1(), graph_canon::stats_visitor()));
+	return std::make_pair(res.first, get(graph_canon::stats_visitor::result_t(), res.second));
+}
+
+// the trail must give the same tree as when each node has its own partition
+
+template<typename EdgeHandlerCreator>
+void check_trail(const Graph &g, EdgeHandlerCreator edge_handler) {
+	const auto dfs = canonicalize(g, edge_handler, graph_canon::traversal_dfs());
+	const auto trail = canonicalize(g, edge_handler, graph_canon::traversal_dfs_trail());
+	BOOST_REQUIRE(dfs.first == trail.first);
+	BOOST_CHECK_EQUAL(dfs.second.num_tree_nodes, trail.second.num_tree_nodes);
+	BOOST_CHECK_EQUAL(dfs.second.num_terminals, trail.second.num_terminals);
+	BOOST_CHECK_EQUAL(dfs.second.num_pruned, trail.second.num_pruned);
+	BOOST_CHECK_EQUAL(dfs.second.num_new_best_leaf, trail.second.num_new_best_leaf);
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	check_trail(make_cycle<Graph>(20), graph_canon::edge_handler_all_equal());
+	check_trail(make_complete<Graph>(6), graph_canon::edge_handler_all_equal());
+	for(int i = 0; i < 30; ++i)
+		check_trail(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.1 + 0.1 * (gen() % 4)), graph_canon::edge_handler_all_equal());
+}
+
+BOOST_AUTO_TEST_CASE(test_edge_names) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	for(int i = 0; i < 30; ++i) {
+		Graph g = i % 3 == 0 ? make_complete<Graph>(3 + gen() % 6) : make_random_graph<Graph>(gen, 1 + gen() % 40, 0.3);
+		set_random_edge_names(gen, g, 3);
+		check_trail(g, edge_handler_name());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_nodes_alive_after_traversal) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	for(int i = 0; i < 10; ++i) {
+		const Graph g = i % 2 == 0 ? make_cycle<Graph>(10 + gen() % 20) : make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2);
+		std::size_t sum = 0;
+		const auto res = graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+				graph_canon::always_false(), graph_canon::edge_handler_all_equal(), graph_canon::make_visitor(
+				graph_canon::target_cell_flm(), graph_canon::traversal_dfs_trail(), graph_canon::refine_WL_1(),
+				read_destroyed_visitor(sum)));
+		BOOST_CHECK(res.first == canonical_permutation(g));
+	}
+}
@@ -0,0 +1,210 @@
+#include <graph_canon/csr_graph.hpp>
+#include <graph_canon/dimacs_graph_io.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+using DiGraph = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+using CSR = graph_canon::csr_graph<unsigned int>;
+
+template<typename Gen>
+std::string make_random_dimacs(Gen &gen) {
+	const std::vector<std::string> noise = {
+		"", "c comment", "e 1", "e 0 2", "e 1 1000", "n 0 1", "n 1", "x 1 2", "p edge 3 3", "e -1 2", "e +1 2",
+		"e 4294967297 1", "e\t1   2 trailing", "e1 2", "n 1 2\r", "e 1 2\r", "\r", " e 1 2"
+	};
+	std::ostringstream s;
+	if(gen() % 20 == 0) return gen() % 2 ? "" : "c only a comment\n\n";
+	for(int i = gen() % 3; i > 0; --i) s << (gen() % 2 ? "c header\n" : "\n");
+	const unsigned int n = gen() % 12;
+	unsigned int m = gen() % 30;
+	switch(gen() % 20) {
+	case 0: s << "p edge " << n << '\n';
+		break;
+	case 1: s << "q edge " << n << ' ' << m << '\n';
+		break;
+	default:
+		s << "p  edge\t" << n << ' ' << (gen() % 10 == 0 ? m + 1 : m) << '\n';
+	}
+	for(unsigned int i = 0; i < m; ++i) {
+		if(n != 0 && gen() % 4 == 0) s << "n " << (1 + gen() % n) << ' ' << gen() % 4 << '\n';
+		if(gen() % 40 == 0) {
+			s << noise[gen() % noise.size()] << '\n';
+			continue;
+		}
+		if(n == 0) {
+			s << "e 1 1\n";
+			continue;
+		}
+		// few vertices, so plenty of loops and parallel edges
+		s << "e " << (1 + gen() % n) << ' ' << (1 + gen() % n) << '\n';
+	}
+	std::string res = s.str();
+	if(!res.empty() && gen() % 4 == 0) res.pop_back(); // no final newline
+	return res;
+}
+
+// handlers accepting based on a random choice, logging all calls
+struct Handlers {
+	std::mt19937 gen;
+	std::vector<std::tuple<char, unsigned int, unsigned int> > calls;
+	bool acceptPar, acceptLoop;
+
+	explicit Handlers(std::size_t seed) : gen(seed), acceptPar(gen() % 2), acceptLoop(gen() % 2) { }
+
+	auto par() {
+		return [this](unsigned int src, unsigned int tar) {
+			calls.emplace_back('p', src, tar);
+			return acceptPar || gen() % 2 == 0;
+		};
+	}
+
+	auto loop() {
+		return [this](unsigned int v) {
+			calls.emplace_back('l', v, v);
+			return acceptLoop || gen() % 2 == 0;
+		};
+	}
+};
+
+template<typename G>
+std::vector<std::pair<std::size_t, std::size_t> > edge_list(const G &g) {
+	std::vector<std::pair<std::size_t, std::size_t> > res;
+	BGL_FORALL_EDGES_T(e, g, G) {
+		res.emplace_back(source(e, g), target(e, g));
+	}
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	{ // lines are split as by std::getline, also across blocks
+		for(int i = 0; i < 100; ++i) {
+			std::string text;
+			for(int j = gen() % 50; j > 0; --j)
+				text += gen() % 5 == 0 ? '\n' : char('a' + gen() % 26);
+			std::istringstream sExpected(text), s(text);
+			graph_canon::detail::dimacs_line_reader reader(s, 1 + gen() % 8);
+			std::string expected;
+			const char *first, *last;
+			while(std::getline(sExpected, expected)) {
+				BOOST_REQUIRE(reader.next(first, last));
+				BOOST_REQUIRE_EQUAL(std::string(first, last), expected);
+			}
+			BOOST_REQUIRE(!reader.next(first, last));
+		}
+	}
+	for(int i = 0; i < 2000; ++i) {
+		const std::string text = make_random_dimacs(gen);
+		const std::size_t handlerSeed = gen();
+		Handlers hExpected(handlerSeed), h(handlerSeed);
+		Graph gExpected, g;
+		std::ostringstream errExpected, err;
+		std::istringstream sExpected(text), s(text);
+		const bool resExpected = graph_canon::read_dimacs_graph(sExpected, gExpected, errExpected, hExpected.par(), hExpected.loop());
+		const bool res = graph_canon::read_dimacs_graph_fast(s, g, err, h.par(), h.loop());
+		BOOST_TEST_CONTEXT("Input:\n" << text) {
+			BOOST_REQUIRE_EQUAL(res, resExpected);
+			BOOST_REQUIRE_EQUAL(err.str(), errExpected.str());
+			BOOST_REQUIRE(h.calls == hExpected.calls);
+			BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gExpected));
+			BGL_FORALL_VERTICES(v, g, Graph) {
+				BOOST_REQUIRE_EQUAL(get(boost::vertex_name_t(), g, v), get(boost::vertex_name_t(), gExpected, v));
+			}
+			BOOST_REQUIRE(edge_list(g) == edge_list(gExpected));
+
+			// the same through a csr_graph, when no loops are accepted
+			Handlers hCSR(handlerSeed);
+			hCSR.acceptLoop = false;
+			Handlers hNoLoops(handlerSeed);
+			hNoLoops.acceptLoop = false;
+			CSR gCSR;
+			Graph gNoLoops;
+			std::ostringstream errCSR, errNoLoops;
+			std::istringstream sCSR(text), sNoLoops(text);
+			const auto rejectLoop = [](unsigned int) {
+				return false;
+			};
+			const bool resCSR = graph_canon::read_dimacs_graph_fast(sCSR, gCSR, errCSR, hCSR.par(), rejectLoop);
+			const bool resNoLoops = graph_canon::read_dimacs_graph(sNoLoops, gNoLoops, errNoLoops, hNoLoops.par(), rejectLoop);
+			BOOST_REQUIRE_EQUAL(resCSR, resNoLoops);
+			BOOST_REQUIRE_EQUAL(errCSR.str(), errNoLoops.str());
+			BOOST_REQUIRE_EQUAL(num_vertices(gCSR), num_vertices(gNoLoops));
+			BOOST_REQUIRE_EQUAL(num_edges(gCSR), num_edges(gNoLoops));
+			BGL_FORALL_VERTICES(v, gNoLoops, Graph) {
+				BOOST_REQUIRE_EQUAL(get(get(boost::vertex_name_t(), gCSR), v), get(boost::vertex_name_t(), gNoLoops, v));
+				BOOST_REQUIRE_EQUAL(out_degree(v, gCSR), out_degree(v, gNoLoops));
+			}
+
+			// the same for a directed graph, where (u, v) and (v, u) are not parallel
+			Handlers hDiExpected(handlerSeed), hDi(handlerSeed);
+			DiGraph gDiExpected, gDi;
+			std::ostringstream errDiExpected, errDi;
+			std::istringstream sDiExpected(text), sDi(text);
+			const bool resDiExpected = graph_canon::read_dimacs_graph(sDiExpected, gDiExpected, errDiExpected, hDiExpected.par(), hDiExpected.loop());
+			const bool resDi = graph_canon::read_dimacs_graph_fast(sDi, gDi, errDi, hDi.par(), hDi.loop());
+			BOOST_REQUIRE_EQUAL(resDi, resDiExpected);
+			BOOST_REQUIRE_EQUAL(errDi.str(), errDiExpected.str());
+			BOOST_REQUIRE(hDi.calls == hDiExpected.calls);
+			BOOST_REQUIRE(edge_list(gDi) == edge_list(gDiExpected));
+		}
+	}
+	for(int i = 0; i < 100; ++i) { // concatenated graphs
+		const auto rejectPar = [](unsigned int, unsigned int) {
+			return false;
+		};
+		const auto acceptLoop = [](unsigned int) {
+			return true;
+		};
+		const std::size_t numGraphs = gen() % 6;
+		std::vector<Graph> expected;
+		std::string text;
+		while(expected.size() < numGraphs) {
+			std::string single = make_random_dimacs(gen);
+			// only valid graphs with a single problem line
+			if(single.find("\np") != std::string::npos) continue;
+			std::istringstream s(single);
+			Graph g;
+			std::ostringstream err;
+			if(!graph_canon::read_dimacs_graph(s, g, err, rejectPar, acceptLoop)) continue;
+			if(single.empty() || single.back() != '\n') single += '\n';
+			text += single;
+			expected.push_back(std::move(g));
+		}
+		const bool withError = gen() % 4 == 0;
+		if(withError) text += "p edge 2 1\ne 1 3\n";
+		std::istringstream s(text);
+		graph_canon::dimacs_graph_stream stream(s);
+		std::ostringstream err;
+		BOOST_TEST_CONTEXT("Input:\n" << text) {
+			for(const Graph &gExpected : expected) {
+				Graph g;
+				BOOST_REQUIRE_MESSAGE(stream.read(g, err, rejectPar, acceptLoop), err.str());
+				BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gExpected));
+				BGL_FORALL_VERTICES(v, g, Graph) {
+					BOOST_REQUIRE_EQUAL(get(boost::vertex_name_t(), g, v), get(boost::vertex_name_t(), gExpected, v));
+				}
+				BOOST_REQUIRE(edge_list(g) == edge_list(gExpected));
+			}
+			Graph g;
+			BOOST_REQUIRE(!stream.read(g, err, rejectPar, acceptLoop));
+			BOOST_REQUIRE_EQUAL(stream.failed(), withError);
+		}
+	}
+}
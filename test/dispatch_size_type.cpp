@@ -0,0 +1,110 @@
+#include "graph_generators.hpp"
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+
+// the number of bytes of the selected SizeType
+
+std::size_t selected_size(std::size_t num_vertices, std::size_t num_edges) {
+	return graph_canon::dispatch_size_type(num_vertices, num_edges, [](auto size_type_tag) {
+		return sizeof(typename decltype(size_type_tag)::type);
+	});
+}
+
+BOOST_AUTO_TEST_CASE(test_boundaries) {
+	const std::size_t p8 = std::size_t(1) << 8;
+	const std::size_t p16 = std::size_t(1) << 16;
+	const std::size_t p32 = std::size_t(1) << 32;
+	BOOST_CHECK_EQUAL(selected_size(0, 0), 2);
+	// std::uint16_t is the narrowest
+	BOOST_CHECK_EQUAL(selected_size(p8 - 1, p8 - 1), 2);
+	BOOST_CHECK_EQUAL(selected_size(p8, p8), 2);
+	// the maximum value is kept free
+	BOOST_CHECK_EQUAL(selected_size(p16 - 2, p16 - 2), 2);
+	BOOST_CHECK_EQUAL(selected_size(p16 - 1, 0), 4);
+	BOOST_CHECK_EQUAL(selected_size(0, p16 - 1), 4);
+	BOOST_CHECK_EQUAL(selected_size(p16, p16), 4);
+	BOOST_CHECK_EQUAL(selected_size(p32 - 2, p32 - 2), 4);
+	BOOST_CHECK_EQUAL(selected_size(p32 - 1, 0), 8);
+	BOOST_CHECK_EQUAL(selected_size(0, p32 - 1), 8);
+	BOOST_CHECK_EQUAL(selected_size(p32, p32), 8);
+}
+
+// the permutation to the canonical form when canonicalizing with the given SizeType
+
+template<typename SizeType>
+std::vector<std::size_t> canonical_permutation_as(const Graph &g) {
+	const auto perm = graph_canon::canonicalize<SizeType, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::make_property_less(get(boost::vertex_name_t(), g)), graph_canon::edge_handler_all_equal(),
+			graph_canon::make_visitor(graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1())).first;
+	return std::vector<std::size_t>(perm.begin(), perm.end());
+}
+
+// each SizeType that dispatch_size_type may select for g must give the same as unsigned int
+
+void check_size_types(const Graph &g) {
+	const auto expected = canonical_permutation_as<unsigned int>(g);
+	const std::size_t max16 = std::numeric_limits<std::uint16_t>::max();
+	if(num_vertices(g) < max16 && num_edges(g) < max16)
+		BOOST_CHECK(canonical_permutation_as<std::uint16_t>(g) == expected);
+	BOOST_CHECK(canonical_permutation_as<std::uint32_t>(g) == expected);
+	BOOST_CHECK(canonical_permutation_as<std::uint64_t>(g) == expected);
+	const auto dispatched = graph_canon::dispatch_size_type(num_vertices(g), num_edges(g), [&g](auto size_type_tag) {
+		return canonical_permutation_as<typename decltype(size_type_tag)::type>(g);
+	});
+	BOOST_CHECK(dispatched == expected);
+}
+
+// a graph with exactly m edges chosen at random, and no vertex names
+
+template<typename Gen>
+Graph make_random_graph_with_edges(Gen &gen, std::size_t n, std::size_t m) {
+	std::vector<std::pair<std::size_t, std::size_t> > pairs;
+	for(std::size_t u = 0; u < n; ++u)
+		for(std::size_t v = u + 1; v < n; ++v)
+			pairs.emplace_back(u, v);
+	std::shuffle(pairs.begin(), pairs.end(), gen);
+	Graph g(n);
+	for(std::size_t i = 0; i < m; ++i)
+		add_edge(pairs[i].first, pairs[i].second, g);
+	return g;
+}
+
+BOOST_AUTO_TEST_CASE(test_canonicalize) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	for(int i = 0; i < 20; ++i) {
+		Graph g = i % 5 == 0 ? make_cycle<Graph>(3 + gen() % 30) : make_random_graph<Graph>(gen, 1 + gen() % 40, 0.3);
+		if(i % 2 == 0) set_random_vertex_names(gen, g, 3);
+		check_size_types(g);
+	}
+	const std::size_t p16 = std::size_t(1) << 16;
+	// the most edges, and one more, for std::uint16_t
+	check_size_types(make_random_graph_with_edges(gen, 400, p16 - 2));
+	check_size_types(make_random_graph_with_edges(gen, 400, p16 - 1));
+	// the most vertices, and one more, for std::uint16_t,
+	// with distinct names so the root partition is discrete and the run stays short
+	for(const std::size_t n : {p16 - 2, p16 - 1}) {
+		Graph g(n);
+		for(std::size_t v = 1; v < n; ++v) // a random tree
+			add_edge(gen() % v, v, g);
+		const auto names = make_random_relabelling(gen, n);
+		for(std::size_t v = 0; v < n; ++v)
+			put(boost::vertex_name_t(), g, v, names[v]);
+		check_size_types(g);
+	}
+}
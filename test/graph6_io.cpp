@@ -0,0 +1,165 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/csr_graph.hpp>
+#include <graph_canon/graph6_io.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+using Digraph = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
+		boost::property<boost::vertex_name_t, std::size_t> >;
+using CSR = graph_canon::csr_graph<unsigned int>;
+
+const auto acceptPar = [](unsigned int, unsigned int) {
+	return true;
+};
+const auto acceptLoop = [](unsigned int) {
+	return true;
+};
+
+template<typename G>
+std::vector<std::pair<std::size_t, std::size_t> > sorted_edges(const G &g) {
+	std::vector<std::pair<std::size_t, std::size_t> > res;
+	BGL_FORALL_EDGES_T(e, g, G) {
+		std::size_t u = source(e, g), v = target(e, g);
+		if(!boost::is_directed_graph<G>::value && u > v) std::swap(u, v);
+		res.emplace_back(u, v);
+	}
+	std::sort(res.begin(), res.end());
+	return res;
+}
+
+template<typename G>
+G read_line(const std::string &line) {
+	std::istringstream s(line);
+	std::ostringstream err;
+	G g;
+	BOOST_REQUIRE_MESSAGE(graph_canon::read_graph6(s, g, err, acceptPar, acceptLoop), err.str());
+	return g;
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	{ // the examples of the format description
+		Graph g(5);
+		add_edge(0, 2, g);
+		add_edge(0, 4, g);
+		add_edge(1, 3, g);
+		add_edge(3, 4, g);
+		std::ostringstream s;
+		graph_canon::write_graph6(s, g);
+		BOOST_CHECK_EQUAL(s.str(), "DQc\n");
+		BOOST_CHECK(sorted_edges(read_line<Graph>("DQc")) == sorted_edges(g));
+		BOOST_CHECK(sorted_edges(read_line<Graph>(">>graph6<<DQc")) == sorted_edges(g));
+
+		Graph h(7);
+		add_edge(0, 1, h);
+		add_edge(0, 2, h);
+		add_edge(1, 2, h);
+		add_edge(5, 6, h);
+		s.str("");
+		graph_canon::write_sparse6(s, h);
+		BOOST_CHECK_EQUAL(s.str(), ":Fa@x^\n");
+		BOOST_CHECK(sorted_edges(read_line<Graph>(":Fa@x^")) == sorted_edges(h));
+
+		Digraph d(5);
+		add_edge(0, 2, d);
+		add_edge(0, 4, d);
+		add_edge(3, 1, d);
+		add_edge(3, 4, d);
+		s.str("");
+		graph_canon::write_digraph6(s, d);
+		BOOST_CHECK_EQUAL(s.str(), "&DI?AO?\n");
+		BOOST_CHECK(sorted_edges(read_line<Digraph>("&DI?AO?")) == sorted_edges(d));
+	}
+	for(int i = 0; i < 300; ++i) { // round trips, also with the special padding of sparse6
+		const unsigned int n = gen() % 4 == 0 ? std::vector<unsigned int>{1, 2, 4, 8, 16}[gen() % 5] : gen() % 100;
+		const Graph g = make_random_graph<Graph>(gen, n, 0.1 + 0.5 * (gen() % 2));
+		std::ostringstream s6, sS6;
+		graph_canon::write_graph6(s6, g);
+		graph_canon::write_sparse6(sS6, g);
+		BOOST_TEST_CONTEXT(s6.str() << sS6.str()) {
+			BOOST_REQUIRE(sorted_edges(read_line<Graph>(s6.str())) == sorted_edges(g));
+			BOOST_REQUIRE(sorted_edges(read_line<Graph>(sS6.str())) == sorted_edges(g));
+		}
+		const Graph gMulti = make_random_graph<Graph>(gen, n, 0.3, true, true);
+		std::ostringstream sMulti;
+		graph_canon::write_sparse6(sMulti, gMulti);
+		BOOST_TEST_CONTEXT(sMulti.str()) {
+			BOOST_REQUIRE(sorted_edges(read_line<Graph>(sMulti.str())) == sorted_edges(gMulti));
+		}
+		const Digraph d = make_random_graph<Digraph>(gen, n, 0.2, true);
+		std::ostringstream sD;
+		graph_canon::write_digraph6(sD, d);
+		BOOST_REQUIRE(sorted_edges(read_line<Digraph>(sD.str())) == sorted_edges(d));
+	}
+	{ // a stream of graphs, into a csr_graph, with the same handler calls as for DIMACS
+		std::vector<Graph> graphs;
+		std::stringstream s;
+		for(int i = 0; i < 20; ++i) {
+			graphs.push_back(make_random_graph<Graph>(gen, gen() % 30, 0.2, true, true));
+			if(i % 2 == 0) graph_canon::write_sparse6(s, graphs.back());
+			else graph_canon::write_graph6(s, graphs.back());
+			if(i % 5 == 0) s << '\n';
+		}
+		graph_canon::graph6_stream stream(s);
+		std::ostringstream err;
+		const auto rejectPar = [](unsigned int, unsigned int) {
+			return false;
+		};
+		const auto rejectLoop = [](unsigned int) {
+			return false;
+		};
+		for(const Graph &gExpected : graphs) {
+			CSR g;
+			BOOST_REQUIRE_MESSAGE(stream.read(g, err, rejectPar, rejectLoop), err.str());
+			BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gExpected));
+			std::vector<std::pair<std::size_t, std::size_t> > expected = sorted_edges(gExpected);
+			expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+			expected.erase(std::remove_if(expected.begin(), expected.end(), [](const auto &e) {
+				return e.first == e.second;
+			}), expected.end());
+			BOOST_REQUIRE_EQUAL(num_edges(g), expected.size());
+		}
+		CSR g;
+		BOOST_REQUIRE(!stream.read(g, err, rejectPar, rejectLoop));
+		BOOST_REQUIRE(!stream.failed());
+	}
+	{ // canonical forms
+		for(int i = 0; i < 50; ++i) {
+			const Graph g = make_random_graph<Graph>(gen, 1 + gen() % 30, 0.3);
+			const Graph h = make_relabelled(gen, g);
+			const auto canon = [](const Graph &g) {
+				const auto perm = canonical_permutation(g);
+				std::ostringstream s;
+				graph_canon::write_graph6(s, g, get(boost::vertex_index_t(), g), perm);
+				return s.str();
+			};
+			BOOST_REQUIRE_EQUAL(canon(g), canon(h));
+		}
+	}
+	{ // invalid input
+		std::ostringstream err;
+		Graph g;
+		std::istringstream tooShort("DQ"), badChar("D Qc"), digraph("&DI?AO?");
+		BOOST_CHECK(!graph_canon::read_graph6(tooShort, g, err, acceptPar, acceptLoop));
+		BOOST_CHECK(!graph_canon::read_graph6(badChar, g, err, acceptPar, acceptLoop));
+		BOOST_CHECK(!graph_canon::read_graph6(digraph, g, err, acceptPar, acceptLoop));
+		std::cout << "Expected errors:\n" << err.str();
+	}
+}
@@ -0,0 +1,161 @@
+#ifndef GRAPHCANON_TEST_GRAPH_GENERATORS_HPP
+#define GRAPHCANON_TEST_GRAPH_GENERATORS_HPP
+
+// Graphs and canonical forms shared by the tests.
+
+#include <graph_canon/canonicalization.hpp>
+#include <graph_canon/refine/WL_1.hpp>
+#include <graph_canon/target_cell/flm.hpp>
+#include <graph_canon/tree_traversal/dfs.hpp>
+#include <graph_canon/util.hpp>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/iteration_macros.hpp>
+#include <boost/graph/properties.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// Each pair of vertices is adjacent with the given probability, in both directions independently for directed graphs.
+// With multi, an edge is doubled with probability 1/4.
+
+template<typename Graph, typename Gen>
+Graph make_random_graph(Gen &gen, std::size_t n, double edge_probability, bool loops = false, bool multi = false) {
+	Graph g(n);
+	std::uniform_real_distribution<double> dist_real(0.0, 1.0);
+	for(std::size_t u = 0; u < n; ++u) {
+		for(std::size_t v = boost::is_directed_graph<Graph>::value ? 0 : u; v < n; ++v) {
+			if(u == v && !loops) continue;
+			if(dist_real(gen) > edge_probability) continue;
+			add_edge(u, v, g);
+			if(multi && gen() % 4 == 0) add_edge(u, v, g);
+		}
+	}
+	return g;
+}
+
+template<typename Graph, typename Gen>
+void set_random_vertex_names(Gen &gen, Graph &g, std::size_t num_names) {
+	BGL_FORALL_VERTICES_T(v, g, Graph) {
+		put(boost::vertex_name_t(), g, v, gen() % num_names);
+	}
+}
+
+template<typename Graph, typename Gen>
+void set_random_edge_names(Gen &gen, Graph &g, std::size_t num_names) {
+	BGL_FORALL_EDGES_T(e, g, Graph) {
+		put(boost::edge_name_t(), g, e, gen() % num_names);
+	}
+}
+
+template<typename Graph>
+Graph make_cycle(std::size_t n) {
+	Graph g(n);
+	for(std::size_t i = 0; i < n; ++i)
+		add_edge(i, (i + 1) % n, g);
+	return g;
+}
+
+template<typename Graph>
+Graph make_complete(std::size_t n) {
+	Graph g(n);
+	for(std::size_t u = 0; u < n; ++u)
+		for(std::size_t v = u + 1; v < n; ++v)
+			add_edge(u, v, g);
+	return g;
+}
+
+// vertex v of the original becomes p[v], the vertex names are copied if the graph has them
+
+template<typename Graph>
+Graph relabel(const Graph &g, const std::vector<unsigned int> &p, std::false_type has_vertex_names = {}) {
+	Graph h(num_vertices(g));
+	BGL_FORALL_EDGES_T(e, g, Graph) {
+		add_edge(p[source(e, g)], p[target(e, g)], h);
+	}
+	return h;
+}
+
+template<typename Graph>
+Graph relabel(const Graph &g, const std::vector<unsigned int> &p, std::true_type has_vertex_names) {
+	Graph h = relabel(g, p);
+	BGL_FORALL_VERTICES_T(v, g, Graph) {
+		put(boost::vertex_name_t(), h, p[v], get(boost::vertex_name_t(), g, v));
+	}
+	return h;
+}
+
+template<typename Gen>
+std::vector<unsigned int> make_random_relabelling(Gen &gen, std::size_t n) {
+	std::vector<unsigned int> p(n);
+	std::iota(p.begin(), p.end(), 0);
+	std::shuffle(p.begin(), p.end(), gen);
+	return p;
+}
+
+template<typename Graph, typename Gen, typename HasVertexNames = std::false_type>
+Graph make_relabelled(Gen &gen, const Graph &g, HasVertexNames has_vertex_names = {}) {
+	return relabel(g, make_random_relabelling(gen, num_vertices(g)), has_vertex_names);
+}
+
+// An edge handler for the edge names, which sorts the partition directly.
+// After refining with a singleton cell, the hit vertices are split by the name of the edge to the singleton.
+
+template<typename SizeType>
+struct edge_handler_name_impl : graph_canon::edge_handler_all_equal_impl<SizeType> {
+	using supports_partition_trail = std::true_type;
+
+	template<typename State>
+	void initialize(const State &state) {
+		names.assign(state.n, 0);
+	}
+
+	template<typename State, typename TreeNode, typename Edge>
+	void add_edge_singleton_refiner(State &state, TreeNode &node, const SizeType cell, const SizeType cell_end, const Edge &e_out, const SizeType target_pos) {
+		names[node.pi.get(target_pos)] = get(boost::edge_name_t(), state.g, e_out);
+	}
+
+	template<bool ParallelEdges, bool Loops, typename Partition, typename Splits>
+	void sort_singleton_refiner(Partition &pi, const SizeType cell, const SizeType cell_mid, const SizeType cell_end, Splits &splits) {
+		pi.trail_elements(cell_mid, cell_end);
+		std::sort(pi.begin() + cell_mid, pi.begin() + cell_end, [this](const SizeType a, const SizeType b) {
+			return names[a] < names[b];
+		});
+		pi.reset_inverse(cell_mid, cell_end);
+		for(SizeType i = cell_mid + 1; i < cell_end; ++i)
+			if(names[pi.get(i - 1)] != names[pi.get(i)]) splits.push_back(i);
+	}
+
+	template<typename State, typename Edge>
+	long long compare(State &state, const Edge &e_left, const Edge &e_right) const {
+		const std::size_t left = get(boost::edge_name_t(), state.g, e_left);
+		const std::size_t right = get(boost::edge_name_t(), state.g, e_right);
+		return left < right ? -1 : (left > right ? 1 : 0);
+	}
+private:
+	std::vector<std::size_t> names; // of the vertices hit by the current singleton refiner
+};
+
+struct edge_handler_name {
+	template<typename SizeType>
+	using type = edge_handler_name_impl<SizeType>;
+
+	template<typename SizeType>
+	type<SizeType> make() {
+		return {};
+	}
+};
+
+// the permutation to the canonical form with the default plugins
+
+template<typename Graph, typename VertexLess = graph_canon::always_false>
+std::vector<unsigned int> canonical_permutation(const Graph &g, VertexLess vertex_less = VertexLess()) {
+	return graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			vertex_less, graph_canon::edge_handler_all_equal(),
+			graph_canon::make_visitor(graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1())).first;
+}
+
+#endif /* GRAPHCANON_TEST_GRAPH_GENERATORS_HPP */
@@ -0,0 +1,200 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/csr_graph.hpp>
+#include <graph_canon/mapped_csr_graph.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/graph_concepts.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using View = graph_canon::csr_graph_view<unsigned int>;
+using CSR = graph_canon::csr_graph<unsigned int, std::uint64_t, std::uint64_t>;
+using AdjList = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::property<boost::vertex_name_t, std::size_t>,
+		boost::property<boost::edge_name_t, std::size_t> >;
+
+template<typename Gen>
+AdjList make_random_named_graph(Gen &gen, unsigned int n, double edge_probability) {
+	AdjList g = make_random_graph<AdjList>(gen, n, edge_probability);
+	set_random_vertex_names(gen, g, 3);
+	set_random_edge_names(gen, g, 3);
+	return g;
+}
+
+// the sorted edges of the canonical form
+template<typename Graph>
+std::vector<std::pair<std::size_t, std::size_t> > canonical_edges(const Graph &g) {
+	const auto permutation = canonical_permutation(g, graph_canon::make_property_less(get(boost::vertex_name_t(), g)));
+	std::vector<std::pair<std::size_t, std::size_t> > result;
+	BGL_FORALL_EDGES_T(e, g, Graph) {
+		std::size_t u = permutation[source(e, g)];
+		std::size_t v = permutation[target(e, g)];
+		result.emplace_back(std::min(u, v), std::max(u, v));
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+struct temp_file {
+	temp_file(const std::string &name) : name((std::filesystem::temp_directory_path() / name).string()) { }
+
+	~temp_file() {
+		std::remove(name.c_str());
+	}
+
+	void write(const std::string &bytes) const {
+		std::ofstream ofs(name, std::ios::binary);
+		ofs << bytes;
+	}
+public:
+	const std::string name;
+};
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	BOOST_CONCEPT_ASSERT((boost::VertexListGraphConcept<View>));
+	BOOST_CONCEPT_ASSERT((boost::EdgeListGraphConcept<View>));
+	BOOST_CONCEPT_ASSERT((boost::IncidenceGraphConcept<View>));
+	BOOST_CONCEPT_ASSERT((boost::AdjacencyGraphConcept<View>));
+	BOOST_CONCEPT_ASSERT((boost::BidirectionalGraphConcept<View>));
+	BOOST_STATIC_ASSERT((graph_canon::detail::is_csr_graph_with_own_index<View, boost::typed_identity_property_map<unsigned int> >::value));
+
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	const temp_file file("mapped_csr_graph.test." + std::to_string(seed) + ".csr");
+
+	for(int i = 0; i < 20; ++i) {
+		const AdjList gAdj = make_random_named_graph(gen, gen() % 50, 0.2);
+		std::stringstream bytes;
+		BOOST_REQUIRE(graph_canon::write_csr_graph<unsigned int>(bytes, gAdj, get(boost::vertex_index_t(), gAdj),
+				get(boost::vertex_name_t(), gAdj), get(boost::edge_name_t(), gAdj)));
+		file.write(bytes.str());
+
+		graph_canon::mapped_csr_file mapped;
+		std::stringstream err;
+		BOOST_REQUIRE_MESSAGE(mapped.open(file.name, err), err.str());
+		BOOST_REQUIRE_MESSAGE(mapped.validate(err), err.str());
+		BOOST_REQUIRE_EQUAL(mapped.get_size_type_bytes(), sizeof(unsigned int));
+		const View g = mapped.view<unsigned int>();
+		const CSR gCSR(gAdj, get(boost::vertex_index_t(), gAdj), get(boost::vertex_name_t(), gAdj), get(boost::edge_name_t(), gAdj));
+
+		BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gAdj));
+		BOOST_REQUIRE_EQUAL(num_edges(g), num_edges(gAdj));
+		BGL_FORALL_VERTICES(v, g, View) {
+			BOOST_REQUIRE_EQUAL(get(get(boost::vertex_name_t(), g), v), get(boost::vertex_name_t(), gAdj, v));
+			BOOST_REQUIRE_EQUAL(out_degree(v, g), out_degree(v, gCSR));
+			auto e_iter = out_edges(v, gCSR).first;
+			BGL_FORALL_OUTEDGES(v, e, g, View) {
+				BOOST_REQUIRE_EQUAL(target(e, g), target(*e_iter, gCSR));
+				BOOST_REQUIRE_EQUAL(get(get(boost::edge_name_t(), g), e), get(get(boost::edge_name_t(), gCSR), *e_iter));
+				++e_iter;
+			}
+		}
+		BOOST_REQUIRE(canonical_edges(g) == canonical_edges(gCSR));
+
+		// move the mapping, the view must stay valid
+		graph_canon::mapped_csr_file moved(std::move(mapped));
+		BOOST_REQUIRE(!mapped.is_open());
+		BOOST_REQUIRE(moved.view<unsigned int>().get_targets() == g.get_targets());
+	}
+	{ // many graphs in a single stream
+		std::vector<AdjList> graphs;
+		std::stringstream bytes;
+		for(int i = 0; i < 10; ++i) {
+			graphs.push_back(make_random_named_graph(gen, gen() % 30, 0.2));
+			const AdjList &gAdj = graphs.back();
+			BOOST_REQUIRE(graph_canon::write_csr_graph<unsigned int>(bytes, gAdj, get(boost::vertex_index_t(), gAdj),
+					get(boost::vertex_name_t(), gAdj)));
+		}
+		const std::string all = bytes.str();
+		std::stringstream s(all), err;
+		graph_canon::csr_graph_stream stream(s);
+		for(const AdjList &gAdj : graphs) {
+			BOOST_REQUIRE_MESSAGE(stream.read(err), err.str());
+			BOOST_REQUIRE_MESSAGE(stream.validate(err), err.str());
+			const View g = stream.view<unsigned int>();
+			BOOST_REQUIRE_EQUAL(num_vertices(g), num_vertices(gAdj));
+			BOOST_REQUIRE_EQUAL(num_edges(g), num_edges(gAdj));
+			BGL_FORALL_VERTICES(v, g, View) {
+				BOOST_REQUIRE_EQUAL(get(get(boost::vertex_name_t(), g), v), get(boost::vertex_name_t(), gAdj, v));
+			}
+			BOOST_REQUIRE(canonical_edges(g) == canonical_edges(gAdj));
+		}
+		BOOST_REQUIRE(!stream.read(err));
+		BOOST_REQUIRE(!stream.failed());
+
+		std::stringstream truncated(all.substr(0, all.size() - 1));
+		graph_canon::csr_graph_stream truncatedStream(truncated);
+		while(truncatedStream.read(err));
+		BOOST_CHECK(truncatedStream.failed());
+	}
+	{ // without labels
+		const AdjList gAdj = make_random_named_graph(gen, 20, 0.3);
+		std::stringstream bytes;
+		BOOST_REQUIRE(graph_canon::write_csr_graph<unsigned int>(bytes, gAdj, get(boost::vertex_index_t(), gAdj)));
+		file.write(bytes.str());
+		graph_canon::mapped_csr_file mapped;
+		std::stringstream err;
+		BOOST_REQUIRE_MESSAGE(mapped.open(file.name, err), err.str());
+		const View g = mapped.view<unsigned int>();
+		BGL_FORALL_VERTICES(v, g, View) {
+			BOOST_CHECK_EQUAL(get(get(boost::vertex_name_t(), g), v), 0u);
+		}
+	}
+	{ // graphs that can not be stored are rejected before anything is written
+		AdjList gLoop = make_random_named_graph(gen, 10, 0.3);
+		add_edge(3, 3, gLoop);
+		std::stringstream sLoop;
+		BOOST_CHECK(!graph_canon::write_csr_graph<unsigned int>(sLoop, gLoop, get(boost::vertex_index_t(), gLoop)));
+		BOOST_CHECK(sLoop.str().empty());
+
+		const AdjList gLarge = make_cycle<AdjList>(300);
+		std::stringstream sLarge;
+		BOOST_CHECK(!graph_canon::write_csr_graph<std::uint8_t>(sLarge, gLarge, get(boost::vertex_index_t(), gLarge)));
+		BOOST_CHECK(sLarge.str().empty());
+	}
+	{ // invalid files
+		const AdjList gAdj = make_random_named_graph(gen, 20, 0.5);
+		std::stringstream s;
+		graph_canon::write_csr_graph<unsigned int>(s, gAdj, get(boost::vertex_index_t(), gAdj));
+		const std::string bytes = s.str();
+		graph_canon::csr_file_header h;
+		std::memcpy(&h, bytes.data(), sizeof(h));
+		BOOST_REQUIRE(num_edges(gAdj) > 0);
+		graph_canon::mapped_csr_file mapped;
+		std::stringstream err;
+
+		file.write(bytes.substr(0, bytes.size() - 1));
+		BOOST_CHECK(!mapped.open(file.name, err));
+
+		std::string bad = bytes;
+		bad[3] = 'X';
+		file.write(bad);
+		BOOST_CHECK(!mapped.open(file.name, err));
+
+		// redirect the first half-edge to another vertex, so it is no longer paired
+		bad = bytes;
+		unsigned int source = 0, target;
+		while(out_degree(source, gAdj) == 0) ++source;
+		std::memcpy(&target, bad.data() + h.targets_pos, sizeof(target));
+		unsigned int new_target = 0;
+		while(new_target == source || new_target == target) ++new_target;
+		std::memcpy(&bad[h.targets_pos], &new_target, sizeof(new_target));
+		file.write(bad);
+		BOOST_REQUIRE(mapped.open(file.name, err));
+		BOOST_CHECK(!mapped.validate(err));
+		std::cout << "Expected errors:\n" << err.str();
+	}
+}
@@ -0,0 +1,101 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/tree_traversal/bfs-exp.hpp>
+#include <graph_canon/tree_traversal/bfs-exp-m.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <random>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+
+// a visitor with a buffer in each tree node
+
+struct node_buffer_visitor : graph_canon::null_visitor {
+
+	struct tree_data_t {
+	};
+
+	template<typename Config, typename TreeNode>
+	struct TreeNodeData {
+		using type = graph_canon::tagged_element<tree_data_t, std::vector<int> >;
+	};
+
+	template<typename State, typename TreeNode>
+	bool tree_create_node_end(State &state, TreeNode &t) {
+		get(tree_data_t(), t.data).resize(state.n);
+		return true;
+	}
+
+	template<typename State, typename TreeNode>
+	std::size_t memory_tree_node(const State &state, const TreeNode &t) {
+		return get(tree_data_t(), t.data).capacity() * sizeof(int);
+	}
+};
+
+using Canonicalizer = graph_canon::canonicalizer<unsigned int, graph_canon::edge_handler_all_equal, false, false>;
+
+template<typename Vis>
+auto canonicalize(Canonicalizer &canon, const Graph &g, Vis vis) {
+	const auto res = canon(g, get(boost::vertex_index_t(), g), graph_canon::always_false(),
+			graph_canon::make_visitor(vis, graph_canon::stats_visitor()));
+	return std::make_pair(res.first, get(graph_canon::stats_visitor::result_t(), res.second));
+}
+
+template<typename Vis>
+auto canonicalize(const Graph &g, Vis vis) {
+	Canonicalizer canon(graph_canon::edge_handler_all_equal{});
+	return canonicalize(canon, g, vis);
+}
+
+void check_usage(const Graph &g) {
+	const auto n = num_vertices(g);
+	const auto dfs = canonicalize(g, graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1()));
+	const auto bfs = canonicalize(g, graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_bfs_exp(), graph_canon::refine_WL_1()));
+	BOOST_CHECK(dfs.first == bfs.first);
+	for(const auto &stats : {dfs.second, bfs.second}) {
+		// at least the root and its partition
+		BOOST_CHECK_GE(stats.memory_current, n * sizeof(unsigned int));
+		BOOST_CHECK_GE(stats.memory_peak, stats.memory_current);
+	}
+
+	const auto buffers = canonicalize(g, graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1(), node_buffer_visitor()));
+	BOOST_CHECK(dfs.first == buffers.first);
+	// the root and the canonical leaf are alive at the end
+	const auto min_buffers = (buffers.second.max_root_distance == 0 ? 1 : 2) * n * sizeof(int);
+	BOOST_CHECK_GE(buffers.second.memory_current, dfs.second.memory_current + min_buffers);
+	BOOST_CHECK_GE(buffers.second.memory_peak, dfs.second.memory_peak + min_buffers);
+}
+
+BOOST_AUTO_TEST_CASE(test_usage) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	check_usage(make_cycle<Graph>(20));
+	for(int i = 0; i < 20; ++i)
+		check_usage(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2));
+}
+
+BOOST_AUTO_TEST_CASE(test_limit) {
+	const auto g = make_cycle<Graph>(100);
+	const auto vis = graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_bfs_exp_m(1024), graph_canon::refine_WL_1());
+	Canonicalizer canon(graph_canon::edge_handler_all_equal{});
+	const auto unlimited = canonicalize(canon, g, vis);
+	canon.set_memory_limit(unlimited.second.memory_peak / 4);
+	const auto limited = canonicalize(canon, g, vis);
+	BOOST_CHECK(unlimited.first == limited.first);
+	BOOST_CHECK_EQUAL(unlimited.second.num_terminals, limited.second.num_terminals);
+	BOOST_CHECK_LT(limited.second.max_num_tree_nodes, unlimited.second.max_num_tree_nodes);
+	BOOST_CHECK_LT(limited.second.memory_peak, unlimited.second.memory_peak);
+}
@@ -0,0 +1,128 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/aut/pruner_basic.hpp>
+#include <graph_canon/aut/pruner_schreier.hpp>
+#include <graph_canon/tree_traversal/parallel.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+
+struct no_aut_pruner : graph_canon::null_visitor {
+};
+
+template<typename Traversal, typename Pruner>
+auto canonicalize(const Graph &g, Traversal traversal, Pruner pruner,
+		const graph_canon::resource_limits &limits = graph_canon::resource_limits()) {
+	graph_canon::canonicalizer<unsigned int, graph_canon::edge_handler_all_equal, false, false> canon(graph_canon::edge_handler_all_equal{});
+	return canon(g, get(boost::vertex_index_t(), g), graph_canon::always_false(), graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), traversal, graph_canon::refine_WL_1(), pruner, graph_canon::stats_visitor()), limits);
+}
+
+// copies of a cycle, so the automorphisms also exchange the subtrees of the root between the copies
+
+Graph make_cycles(std::size_t num_copies, std::size_t n) {
+	Graph g(num_copies * n);
+	for(std::size_t c = 0; c != num_copies; ++c)
+		for(std::size_t i = 0; i < n; ++i)
+			add_edge(c * n + i, c * n + (i + 1) % n, g);
+	return g;
+}
+
+std::vector<Graph> make_graphs(std::size_t max_complete) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	std::vector<Graph> graphs;
+	for(int i = 0; i < 40; ++i) {
+		const Graph g = i % 4 == 0 ? make_cycle<Graph>(3 + gen() % 15)
+				: i % 4 == 1 ? make_complete<Graph>(2 + gen() % (max_complete - 1))
+				: i % 4 == 2 ? make_cycles(2 + gen() % 3, 3 + gen() % 4)
+				: make_random_graph<Graph>(gen, 1 + gen() % 30, 0.1 + 0.2 * (gen() % 3));
+		graphs.push_back(make_relabelled(gen, g));
+	}
+	return graphs;
+}
+
+// The parallel traversal must give the permutation of traversal_dfs,
+// and the state of the run only has the path to the canonical leaf of the threads.
+
+template<typename Pruner>
+void check_parallel(Pruner pruner, std::size_t max_complete) {
+	for(const auto &g : make_graphs(max_complete)) {
+		const auto serial = canonicalize(g, graph_canon::traversal_dfs(), pruner);
+		const auto num_nodes = get(graph_canon::stats_visitor::result_t(), serial.second).num_tree_nodes;
+		for(const std::size_t num_threads : {1, 2, 4}) {
+			const auto par = canonicalize(g, graph_canon::traversal_parallel(num_threads), pruner);
+			BOOST_CHECK(par.first == serial.first);
+			BOOST_CHECK_LE(get(graph_canon::stats_visitor::result_t(), par.second).num_tree_nodes, num_nodes);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_no_aut_pruner) {
+	check_parallel(no_aut_pruner(), 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_aut_pruner_basic) {
+	check_parallel(graph_canon::aut_pruner_basic(), 12);
+}
+
+BOOST_AUTO_TEST_CASE(test_aut_pruner_schreier) {
+	check_parallel(graph_canon::aut_pruner_schreier(), 12);
+}
+
+bool is_permutation(const std::vector<unsigned int> &perm, std::size_t n) {
+	std::vector<unsigned int> sorted(perm);
+	std::sort(sorted.begin(), sorted.end());
+	for(std::size_t i = 0; i != sorted.size(); ++i)
+		if(sorted[i] != i) return false;
+	return sorted.size() == n;
+}
+
+// a limit reached by a thread stops the run, which still gets the best leaf found
+
+BOOST_AUTO_TEST_CASE(test_limits) {
+	using graph_canon::canon_status;
+	const auto g = make_cycle<Graph>(40);
+	const graph_canon::traversal_parallel traversal(4);
+	{
+		graph_canon::resource_limits limits;
+		limits.max_leaves = 3;
+		const auto res = canonicalize(g, traversal, no_aut_pruner(), limits);
+		BOOST_CHECK(res.status == canon_status::leaf_limit);
+		BOOST_CHECK(is_permutation(res.first, num_vertices(g)));
+	}
+	{ // each thread can only reach its first leaf, on the second level
+		graph_canon::resource_limits limits;
+		limits.max_tree_nodes = 3;
+		const auto res = canonicalize(g, traversal, no_aut_pruner(), limits);
+		BOOST_CHECK(res.status == canon_status::tree_node_limit);
+		BOOST_CHECK_EQUAL(get(graph_canon::stats_visitor::result_t(), res.second).num_tree_nodes, 3);
+		BOOST_CHECK(is_permutation(res.first, num_vertices(g)));
+	}
+	{
+		graph_canon::resource_limits limits;
+		limits.deadline = graph_canon::resource_limits::clock::now() - std::chrono::seconds(1);
+		const auto res = canonicalize(g, traversal, no_aut_pruner(), limits);
+		BOOST_CHECK(res.status == canon_status::deadline);
+	}
+	{ // limits that are not reached
+		graph_canon::resource_limits limits;
+		limits.set_timeout(std::chrono::hours(1));
+		const auto res = canonicalize(g, traversal, no_aut_pruner(), limits);
+		BOOST_CHECK(res.is_complete());
+		BOOST_CHECK(res.first == canonicalize(g, graph_canon::traversal_dfs(), no_aut_pruner()).first);
+	}
+}
@@ -0,0 +1,143 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/detail/permuted_graph_view.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+		boost::no_property, boost::property<boost::edge_name_t, std::size_t> >;
+
+// the part of the configuration of a canon_state used by permuted_graph_view
+
+template<typename State>
+struct view_config {
+	using Graph = typename State::Graph;
+	using IndexMap = typename State::IndexMap;
+	using SizeType = typename State::SizeType;
+	static constexpr bool ParallelEdges = State::ParallelEdges;
+	static constexpr bool Loops = State::Loops;
+};
+
+// the half-edges of the graph permuted by the discrete partition of a leaf, with the edge names if they are compared
+
+template<typename State, typename TreeNode>
+std::vector<std::tuple<std::size_t, std::size_t, std::size_t> > permuted_edges(const State &state, const TreeNode &t, bool with_names) {
+	std::vector<std::tuple<std::size_t, std::size_t, std::size_t> > res;
+	BGL_FORALL_EDGES_T(e, state.g, Graph) {
+		const std::size_t u = t.pi.get_inverse(get(state.idx, source(e, state.g)));
+		const std::size_t v = t.pi.get_inverse(get(state.idx, target(e, state.g)));
+		const std::size_t name = with_names ? get(boost::edge_name_t(), state.g, e) : 0;
+		res.emplace_back(u, v, name);
+		res.emplace_back(v, u, name);
+	}
+	std::sort(res.begin(), res.end());
+	return res;
+}
+
+int sign(long long v) {
+	return v < 0 ? -1 : (v > 0 ? 1 : 0);
+}
+
+struct check_counts {
+	std::size_t num_equal = 0, num_different = 0;
+};
+
+// Compares the view of each reported leaf with the view of the best leaf so far.
+
+struct check_views_visitor : graph_canon::null_visitor {
+	check_views_visitor(bool with_names, check_counts &counts) : with_names(with_names), counts(counts) { }
+
+	template<typename State, typename TreeNode>
+	void tree_leaf(State &state, TreeNode &t) {
+		using View = graph_canon::detail::permuted_graph_view<view_config<State>, TreeNode>;
+		const typename TreeNode::OwnerPtr leaf(&t);
+		const View view(state, leaf);
+		BOOST_CHECK_EQUAL(View::compare(state, view, view), 0);
+		// the targets of each vertex are the positions of its neighbours, in ascending order
+		const auto edges = permuted_edges(state, t, with_names);
+		std::size_t i = 0;
+		for(std::size_t v_idx = 0; v_idx != state.n; ++v_idx) {
+			BOOST_REQUIRE(std::is_sorted(view.get_targets_begin(v_idx), view.get_targets_end(v_idx)));
+			for(auto iter = view.get_targets_begin(v_idx); iter != view.get_targets_end(v_idx); ++iter, ++i) {
+				BOOST_REQUIRE_EQUAL(std::get<0>(edges[i]), v_idx);
+				BOOST_REQUIRE_EQUAL(std::get<1>(edges[i]), *iter);
+			}
+		}
+		BOOST_REQUIRE_EQUAL(i, edges.size());
+
+		TreeNode *best = state.get_canon_leaf();
+		if(!best) return;
+		const typename TreeNode::OwnerPtr best_ptr(best);
+		const View best_view(state, best_ptr);
+		const long long cmp = View::compare(state, view, best_view);
+		BOOST_CHECK_EQUAL(sign(cmp), -sign(View::compare(state, best_view, view)));
+		const bool equal = edges == permuted_edges(state, *best, with_names);
+		BOOST_CHECK_EQUAL(cmp == 0, equal);
+		++(equal ? counts.num_equal : counts.num_different);
+
+		// a view moved to another leaf is the same as a view built for it
+		View moved(state, best_ptr);
+		moved.repermute(state, leaf);
+		BOOST_CHECK(moved.get_node() == leaf);
+		BOOST_CHECK_EQUAL(View::compare(state, moved, view), 0);
+		for(std::size_t v_idx = 0; v_idx != state.n; ++v_idx)
+			BOOST_REQUIRE(std::equal(moved.get_targets_begin(v_idx), moved.get_targets_end(v_idx),
+				view.get_targets_begin(v_idx), view.get_targets_end(v_idx)));
+	}
+private:
+	bool with_names;
+	check_counts &counts;
+};
+
+template<bool ParallelEdges, typename EdgeHandlerCreator>
+void check_views(const Graph &g, EdgeHandlerCreator edge_handler, bool with_names, check_counts &counts) {
+	graph_canon::canonicalize<unsigned int, ParallelEdges, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::always_false(), edge_handler, graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1(),
+			check_views_visitor(with_names, counts)));
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+	check_counts counts;
+	for(int i = 0; i < 40; ++i) {
+		// symmetric graphs give equal leaves, and relabelled copies give them in other orders
+		Graph g = i % 4 == 0 ? make_cycle<Graph>(4 + gen() % 10)
+				: i % 4 == 1 ? make_complete<Graph>(3 + gen() % 4)
+				: make_random_graph<Graph>(gen, 1 + gen() % 20, 0.3, false, i % 4 == 3);
+		g = make_relabelled(gen, g);
+		set_random_edge_names(gen, g, 1 + gen() % 3);
+		if(i % 4 == 3) {
+			check_views<true>(g, graph_canon::edge_handler_all_equal(), false, counts);
+			check_views<true>(g, edge_handler_name(), true, counts);
+		} else {
+			check_views<false>(g, graph_canon::edge_handler_all_equal(), false, counts);
+			check_views<false>(g, edge_handler_name(), true, counts);
+		}
+	}
+	// a cycle of doubled edges named 0 and 1, inserted in alternating order,
+	// so the rotations give equal leaves where the parallel edges are stored in different orders
+	for(const std::size_t n : {4, 5, 8}) {
+		Graph g(n);
+		for(std::size_t i = 0; i < n; ++i) {
+			const std::size_t first = i % 2;
+			add_edge(i, (i + 1) % n, first, g);
+			add_edge(i, (i + 1) % n, 1 - first, g);
+		}
+		check_views<true>(g, edge_handler_name(), true, counts);
+	}
+	BOOST_CHECK_GT(counts.num_equal, 0);
+	BOOST_CHECK_GT(counts.num_different, 0);
+}
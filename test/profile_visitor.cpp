@@ -0,0 +1,101 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/visitor/profile.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+using graph_canon::profile_event;
+
+auto make_inner_visitor() {
+	return graph_canon::make_visitor(graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1());
+}
+
+template<typename Vis>
+auto canonicalize(const Graph &g, Vis vis) {
+	return graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::always_false(), graph_canon::edge_handler_all_equal(), vis);
+}
+
+void check_profile(const Graph &g) {
+	const auto plain = canonicalize(g, make_inner_visitor());
+	const auto res = canonicalize(g, graph_canon::make_visitor(
+			graph_canon::profile_visitor(make_inner_visitor()), graph_canon::stats_visitor()));
+	BOOST_CHECK(plain.first == res.first);
+	const auto &profile = get(graph_canon::profile_result_t(), res.second);
+	const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+
+	BOOST_CHECK_EQUAL(profile.get(profile_event::explore_tree).calls, 1);
+	BOOST_CHECK_EQUAL(profile.get(profile_event::tree_create_node_begin).calls, stats.num_tree_nodes);
+	BOOST_CHECK_EQUAL(profile.get(profile_event::refine).calls, stats.num_refine);
+	BOOST_CHECK_EQUAL(profile.get(profile_event::tree_leaf).calls, stats.num_terminals);
+	BOOST_CHECK_EQUAL(profile.get(profile_event::report_leaf).calls, stats.num_terminals);
+	BOOST_CHECK_EQUAL(profile.get(profile_event::automorphism_leaf).calls, stats.num_explicit_automorphisms);
+	BOOST_CHECK_EQUAL(profile.get_num_levels(), stats.max_root_distance + 1);
+	std::uint64_t self_ticks = 0;
+	for(std::size_t e = 0; e != graph_canon::profile_num_events; ++e) {
+		const auto event = static_cast<profile_event> (e);
+		const auto &totals = profile.get(event);
+		BOOST_CHECK_LE(totals.self_ticks, totals.ticks);
+		self_ticks += totals.self_ticks;
+		if(event == profile_event::explore_tree || event == profile_event::canon_prune) continue;
+		// the events with a tree node are also counted per level
+		std::size_t calls = 0;
+		for(std::size_t level = 0; level != profile.get_num_levels(); ++level)
+			calls += profile.get(event, level).calls;
+		BOOST_CHECK_EQUAL(calls, totals.calls);
+	}
+	BOOST_CHECK_LE(self_ticks, profile.total_ticks);
+	BOOST_CHECK_GE(profile.get_seconds(profile.total_ticks), 0);
+
+	std::ostringstream s;
+	s << profile;
+	BOOST_CHECK(s.str().find("explore_tree") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_main) {
+	const std::size_t seed = std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+	std::mt19937 gen(seed);
+
+	check_profile(make_cycle<Graph>(20));
+	for(int i = 0; i < 20; ++i)
+		check_profile(make_random_graph<Graph>(gen, 1 + gen() % 40, 0.2));
+}
+
+BOOST_AUTO_TEST_CASE(test_disabled) {
+	const auto g = make_cycle<Graph>(10);
+	const auto res = canonicalize(g, graph_canon::profile_visitor(make_inner_visitor(), false));
+	const auto &profile = get(graph_canon::profile_result_t(), res.second);
+	for(std::size_t e = 0; e != graph_canon::profile_num_events; ++e)
+		BOOST_CHECK_EQUAL(profile.get(static_cast<profile_event> (e)).calls, 0);
+	BOOST_CHECK_EQUAL(profile.get_num_levels(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_counters) {
+	const auto g = make_cycle<Graph>(30);
+	const auto res = canonicalize(g, graph_canon::profile_visitor(make_inner_visitor(), false, true));
+	const auto &profile = get(graph_canon::profile_result_t(), res.second);
+	using graph_canon::profile_phase;
+	if(!profile.has_counters) {
+		// e.g., no PMU in a virtual machine
+		std::cout << "Hardware counters unavailable: " << profile.counter_error << std::endl;
+		BOOST_CHECK(!profile.counter_error.empty());
+		BOOST_CHECK_EQUAL(profile.get(profile_phase::tree_search).cycles, 0);
+		return;
+	}
+	BOOST_CHECK(profile.counter_error.empty());
+	for(const auto p : {profile_phase::root_refinement, profile_phase::tree_search, profile_phase::leaf_comparison})
+		BOOST_CHECK_GT(profile.get(p).instructions, 0);
+	// the search includes the leaf comparisons
+	BOOST_CHECK_GT(profile.get(profile_phase::tree_search).instructions, profile.get(profile_phase::leaf_comparison).instructions);
+}
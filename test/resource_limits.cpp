@@ -0,0 +1,181 @@
+#include "graph_generators.hpp"
+
+#include <graph_canon/aut/pruner_basic.hpp>
+#include <graph_canon/aut/pruner_schreier.hpp>
+#include <graph_canon/tree_traversal/bfs-exp.hpp>
+#include <graph_canon/tree_traversal/bfs-exp-m.hpp>
+#include <graph_canon/tree_traversal/dfs-trail.hpp>
+#include <graph_canon/visitor/stats.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+using graph_canon::canon_status;
+using graph_canon::resource_limits;
+
+using Canonicalizer = graph_canon::canonicalizer<unsigned int, graph_canon::edge_handler_all_equal, false, false>;
+
+template<typename Traversal>
+auto canonicalize(Canonicalizer &canon, const Graph &g, Traversal traversal, const resource_limits &limits) {
+	return canon(g, get(boost::vertex_index_t(), g), graph_canon::always_false(), graph_canon::make_visitor(
+			graph_canon::target_cell_flm(), traversal, graph_canon::refine_WL_1(), graph_canon::stats_visitor()), limits);
+}
+
+bool is_permutation(const std::vector<unsigned int> &perm, std::size_t n) {
+	std::vector<unsigned int> sorted(perm);
+	std::sort(sorted.begin(), sorted.end());
+	for(std::size_t i = 0; i != sorted.size(); ++i)
+		if(sorted[i] != i) return false;
+	return sorted.size() == n;
+}
+
+template<typename Traversal>
+void check_traversal(Traversal traversal) {
+	const auto g = make_cycle<Graph>(40);
+	const auto n = num_vertices(g);
+	Canonicalizer canon(graph_canon::edge_handler_all_equal{});
+	const auto full = canonicalize(canon, g, traversal, resource_limits());
+	BOOST_CHECK(full.is_complete());
+	const auto &full_stats = get(graph_canon::stats_visitor::result_t(), full.second);
+	BOOST_REQUIRE_GT(full_stats.num_terminals, 3);
+	{ // the best leaf so far and the automorphisms found are returned
+		resource_limits limits;
+		limits.max_leaves = 3;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.status == canon_status::leaf_limit);
+		const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+		BOOST_CHECK_EQUAL(stats.num_terminals, 3);
+		BOOST_CHECK_LE(stats.num_explicit_automorphisms, 2);
+		BOOST_CHECK(is_permutation(res.first, n));
+	}
+	{ // only the root, which is refined completely
+		resource_limits limits;
+		limits.max_tree_nodes = 1;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.status == canon_status::tree_node_limit);
+		const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+		BOOST_CHECK_EQUAL(stats.num_tree_nodes, 1);
+		BOOST_CHECK_EQUAL(stats.num_refine_abort, 0);
+		BOOST_CHECK(res.first.empty());
+	}
+	{ // no node is pruned for the budget, the first leaf of the cycle is on the second level
+		resource_limits limits;
+		limits.max_tree_nodes = 3;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.status == canon_status::tree_node_limit);
+		const auto &stats = get(graph_canon::stats_visitor::result_t(), res.second);
+		BOOST_CHECK_EQUAL(stats.num_tree_nodes, 3);
+		BOOST_CHECK_EQUAL(stats.num_refine_abort, 0);
+		BOOST_CHECK_EQUAL(stats.num_pruned, 0);
+		BOOST_CHECK_EQUAL(stats.num_terminals, 1);
+		BOOST_CHECK(is_permutation(res.first, n));
+	}
+	{ // stopped during the refinement of the root
+		std::atomic<bool> cancel(true);
+		resource_limits limits;
+		limits.cancel = &cancel;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.status == canon_status::cancelled);
+		BOOST_CHECK(res.first.empty());
+	}
+	{
+		resource_limits limits;
+		limits.deadline = resource_limits::clock::now() - std::chrono::seconds(1);
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.status == canon_status::deadline);
+	}
+	{ // limits that are not reached
+		resource_limits limits;
+		limits.set_timeout(std::chrono::hours(1));
+		limits.max_leaves = full_stats.num_terminals + 1;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.is_complete());
+		BOOST_CHECK(res.first == full.first);
+	}
+	{ // a leaf budget used up by the last leaf of the tree
+		resource_limits limits;
+		limits.max_leaves = full_stats.num_terminals;
+		const auto res = canonicalize(canon, g, traversal, limits);
+		BOOST_CHECK(res.is_complete());
+		BOOST_CHECK(res.first == full.first);
+	}
+	// the workspace is still usable after the stopped runs
+	const auto again = canonicalize(canon, g, traversal, resource_limits());
+	BOOST_CHECK(again.is_complete());
+	BOOST_CHECK(again.first == full.first);
+}
+
+BOOST_AUTO_TEST_CASE(test_dfs) {
+	check_traversal(graph_canon::traversal_dfs());
+}
+
+BOOST_AUTO_TEST_CASE(test_dfs_trail) {
+	check_traversal(graph_canon::traversal_dfs_trail());
+}
+
+BOOST_AUTO_TEST_CASE(test_bfs_exp) {
+	check_traversal(graph_canon::traversal_bfs_exp());
+}
+
+BOOST_AUTO_TEST_CASE(test_bfs_exp_m) {
+	check_traversal(graph_canon::traversal_bfs_exp_m(1024));
+}
+
+// the automorphism pruners must handle a pruned root, and a tree left when the run is stopped
+
+template<typename Pruner>
+void check_aut_pruner(Pruner pruner) {
+	const auto g = make_cycle<Graph>(40);
+	Canonicalizer canon(graph_canon::edge_handler_all_equal{});
+	const auto run = [&](const resource_limits &limits) {
+		return canon(g, get(boost::vertex_index_t(), g), graph_canon::always_false(), graph_canon::make_visitor(
+				graph_canon::target_cell_flm(), graph_canon::traversal_bfs_exp(), graph_canon::refine_WL_1(), pruner), limits);
+	};
+	const auto full = run(resource_limits());
+	BOOST_CHECK(full.is_complete());
+	{ // the refinement of the root is aborted
+		std::atomic<bool> cancel(true);
+		resource_limits limits;
+		limits.cancel = &cancel;
+		const auto res = run(limits);
+		BOOST_CHECK(res.status == canon_status::cancelled);
+		BOOST_CHECK(res.first.empty());
+	}
+	{
+		resource_limits limits;
+		limits.max_leaves = 2;
+		const auto res = run(limits);
+		BOOST_CHECK(res.status == canon_status::leaf_limit);
+		BOOST_CHECK(is_permutation(res.first, num_vertices(g)));
+	}
+	const auto again = run(resource_limits());
+	BOOST_CHECK(again.is_complete());
+	BOOST_CHECK(again.first == full.first);
+}
+
+BOOST_AUTO_TEST_CASE(test_aut_pruner_basic) {
+	check_aut_pruner(graph_canon::aut_pruner_basic());
+}
+
+BOOST_AUTO_TEST_CASE(test_aut_pruner_schreier) {
+	check_aut_pruner(graph_canon::aut_pruner_schreier());
+}
+
+BOOST_AUTO_TEST_CASE(test_unlimited) {
+	const auto g = make_cycle<Graph>(10);
+	const auto vis = graph_canon::make_visitor(graph_canon::target_cell_flm(), graph_canon::traversal_dfs(), graph_canon::refine_WL_1());
+	const auto plain = graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::always_false(), graph_canon::edge_handler_all_equal(), vis);
+	const auto limited = graph_canon::canonicalize<unsigned int, false, false>(g, get(boost::vertex_index_t(), g),
+			graph_canon::always_false(), graph_canon::edge_handler_all_equal(), vis, resource_limits());
+	BOOST_CHECK(limited.is_complete());
+	BOOST_CHECK(plain.first == limited.first);
+}